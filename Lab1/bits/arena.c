@@ -0,0 +1,79 @@
+#include "arena.h"
+
+static ArenaBlock *ArenaCreateBlock_(size_t capacity)
+{
+    // Block data directly follows the block header
+    ArenaBlock *block = (ArenaBlock *)malloc(sizeof(ArenaBlock) + capacity);
+    if (block == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    block->next_ = NULL;
+    block->capacity_ = capacity;
+    block->used_ = 0;
+
+    return block;
+}
+
+Arena *ArenaCreate()
+{
+    Arena *arena = (Arena *)malloc(sizeof(Arena));
+    if (arena == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    arena->current_block_ = ArenaCreateBlock_(ARENA_BLOCK_SIZE);
+    arena->bytes_used = 0;
+    arena->block_count = 1;
+
+    return arena;
+}
+
+void ArenaFree(Arena *arena)
+{
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    ArenaBlock *block = arena->current_block_;
+    while (block != NULL)
+    {
+        ArenaBlock *next_block = block->next_;
+        free(block);
+        block = next_block;
+    }
+
+    free(arena);
+}
+
+void *ArenaAllocate(Arena *arena, size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+
+    ArenaBlock *block = arena->current_block_;
+
+    if (block->used_ + size > block->capacity_)
+    {
+        block = ArenaCreateBlock_(size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE);
+        block->next_ = arena->current_block_;
+        arena->current_block_ = block;
+        arena->block_count++;
+    }
+
+    void *memory = (char *)(block + 1) + block->used_;
+    block->used_ += size;
+    arena->bytes_used += size;
+
+    return memory;
+}
+
+void ArenaPrintStats(const Arena *arena, FILE *stream)
+{
+    fprintf(stream,
+            "Arena: %zu bytes used in %zu block(s)\n",
+            arena->bytes_used,
+            arena->block_count);
+}
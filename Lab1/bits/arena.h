@@ -0,0 +1,36 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "defs.h"
+
+#define ARENA_BLOCK_SIZE 65536
+// Every node kind stored in an arena only needs pointer alignment.
+#define ARENA_ALIGNMENT 8
+
+typedef struct ArenaBlock_
+{
+    struct ArenaBlock_ *next_;
+    size_t capacity_;
+    size_t used_;
+} ArenaBlock;
+
+// A bump allocator owning every node of one compilation.
+// Memory is handed out from fixed-size blocks and is only
+// released all at once by ArenaFree().
+typedef struct
+{
+    // Total bytes handed out, including alignment padding
+    size_t bytes_used;
+    size_t block_count;
+    ArenaBlock *current_block_;
+} Arena;
+
+Arena *ArenaCreate();
+void ArenaFree(Arena *arena);
+void *ArenaAllocate(Arena *arena, size_t size);
+void ArenaPrintStats(const Arena *arena, FILE *stream);
+
+#endif
@@ -1,15 +1,14 @@
 #include "ast_node.h"
 
-AstNode *AstNodeCreate(bool is_token,
-                       void *ast_node_value)
+AstNode *AstNodeCreate(Arena *arena,
+                       bool is_token,
+                       void *ast_node_value,
+                       int flat_index)
 {
-    AstNode *node = (AstNode *)malloc(sizeof(AstNode));
-    if (node == NULL)
-    {
-        MEMORY_ALLOC_FAILURE_EXIT;
-    }
+    AstNode *node = (AstNode *)ArenaAllocate(arena, sizeof(AstNode));
 
     node->is_token = is_token;
+    node->flat_index = flat_index;
     if (is_token)
     {
         node->ast_node_value.token = (Token *)ast_node_value;
@@ -21,20 +20,3 @@ AstNode *AstNodeCreate(bool is_token,
     
     return node;
 }
-
-void AstNodeFree(AstNode *node)
-{
-    if (node != NULL)
-    {
-        if (node->is_token)
-        {
-            TokenFree(node->ast_node_value.token);
-        }
-        else
-        {
-            VariableFree(node->ast_node_value.variable);
-        }
-
-        free(node);
-    }
-}
\ No newline at end of file
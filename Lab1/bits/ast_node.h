@@ -4,12 +4,15 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include "defs.h"
+#include "arena.h"
 #include "token.h"
 #include "variable.h"
 
 typedef struct
 {
     bool is_token;
+    // Index of the counterpart node in the parser's FlatAst
+    int flat_index;
     union
     {
         Token *token;
@@ -17,9 +20,9 @@ typedef struct
     } ast_node_value;
 } AstNode;
 
-AstNode *AstNodeCreate(bool is_token,
-                       void *ast_node_value);
-
-void AstNodeFree(AstNode *node);
+AstNode *AstNodeCreate(Arena *arena,
+                       bool is_token,
+                       void *ast_node_value,
+                       int flat_index);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "compilation_context.h"
+
+CompilationContext *CompilationContextCreate()
+{
+    CompilationContext *context = (CompilationContext *)malloc(sizeof(CompilationContext));
+    if (context == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    context->arena = ArenaCreate();
+    context->interner = InternerCreate();
+    context->flat_ast = FlatAstCreate();
+    context->root = NULL;
+    context->has_lexical_error = false;
+    context->has_syntax_error = false;
+    context->current_column = 1;
+
+    return context;
+}
+
+void CompilationContextFree(CompilationContext *context)
+{
+    if (context == NULL)
+    {
+        return;
+    }
+
+    FlatAstFree(context->flat_ast);
+    InternerFree(context->interner);
+    ArenaFree(context->arena);
+    free(context);
+}
@@ -0,0 +1,40 @@
+#ifndef COMPILATION_CONTEXT_H_
+#define COMPILATION_CONTEXT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "defs.h"
+#include "arena.h"
+#include "interner.h"
+#include "k_tree.h"
+#include "flat_ast.h"
+
+// Everything the scanner and parser share while compiling one source file.
+// Compilations never share state through globals, so separate contexts
+// may be parsed on separate threads at the same time.
+typedef struct
+{
+    Arena *arena;
+    Interner *interner;
+    FlatAst *flat_ast;
+    // NULL until parsing succeeds
+    KTreeNode *root;
+    bool has_lexical_error;
+    bool has_syntax_error;
+    // Line and column numbers start from 1
+    size_t current_column;
+} CompilationContext;
+
+CompilationContext *CompilationContextCreate();
+void CompilationContextFree(CompilationContext *context);
+
+// The two functions below are defined in lex_analyser.l,
+// where the reentrant scanner API is available.
+
+// Parses buffer in place. The last SOURCE_BUFFER_PADDING
+// bytes of buffer must be '\0' and are included in size.
+void CompilationContextParseBuffer(CompilationContext *context, char *buffer, size_t size);
+void CompilationContextParseFile(CompilationContext *context, FILE *file);
+
+#endif
@@ -0,0 +1,166 @@
+#include "flat_ast.h"
+
+FlatAst *FlatAstCreate()
+{
+    FlatAst *ast = (FlatAst *)malloc(sizeof(FlatAst));
+    if (ast == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    ast->nodes = (FlatAstNode *)malloc(FLAT_AST_INITIAL_CAPACITY * sizeof(FlatAstNode));
+    ast->tokens = (Token *)malloc(FLAT_AST_INITIAL_CAPACITY * sizeof(Token));
+    if (ast->nodes == NULL || ast->tokens == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    ast->size = 0;
+    ast->token_count = 0;
+    ast->capacity_ = FLAT_AST_INITIAL_CAPACITY;
+    ast->token_capacity_ = FLAT_AST_INITIAL_CAPACITY;
+
+    return ast;
+}
+
+void FlatAstFree(FlatAst *ast)
+{
+    if (ast == NULL)
+    {
+        return;
+    }
+
+    free(ast->nodes);
+    free(ast->tokens);
+    free(ast);
+}
+
+static int FlatAstAddNode_(FlatAst *ast,
+                           const bool is_token,
+                           const int type,
+                           const int line_start,
+                           const int column_start,
+                           const int token_index)
+{
+    if (ast->size + 1 > ast->capacity_)
+    {
+        ast->capacity_ *= 2;
+        ast->nodes = (FlatAstNode *)realloc(ast->nodes, ast->capacity_ * sizeof(FlatAstNode));
+        if (ast->nodes == NULL)
+        {
+            MEMORY_ALLOC_FAILURE_EXIT;
+        }
+    }
+
+    FlatAstNode *node = &ast->nodes[ast->size];
+    node->type = type;
+    node->is_token = is_token;
+    node->line_start = line_start;
+    node->column_start = column_start;
+    node->first_child = FLAT_AST_NO_NODE;
+    node->next_sibling = FLAT_AST_NO_NODE;
+    node->token_index = token_index;
+    node->last_child_ = FLAT_AST_NO_NODE;
+
+    return ast->size++;
+}
+
+int FlatAstAddTokenNode(FlatAst *ast, const Token *token)
+{
+    if (ast->token_count + 1 > ast->token_capacity_)
+    {
+        ast->token_capacity_ *= 2;
+        ast->tokens = (Token *)realloc(ast->tokens, ast->token_capacity_ * sizeof(Token));
+        if (ast->tokens == NULL)
+        {
+            MEMORY_ALLOC_FAILURE_EXIT;
+        }
+    }
+
+    ast->tokens[ast->token_count] = *token;
+
+    return FlatAstAddNode_(ast,
+                           true,
+                           token->type,
+                           token->line_start,
+                           token->column_start,
+                           ast->token_count++);
+}
+
+int FlatAstAddVariableNode(FlatAst *ast, const Variable *variable)
+{
+    return FlatAstAddNode_(ast,
+                           false,
+                           variable->type,
+                           variable->line_start,
+                           variable->column_start,
+                           FLAT_AST_NO_NODE);
+}
+
+void FlatAstAddChildRight(FlatAst *ast, int parent, int child)
+{
+    FlatAstNode *parent_node = &ast->nodes[parent];
+
+    if (parent_node->first_child == FLAT_AST_NO_NODE)
+    {
+        parent_node->first_child = child;
+    }
+    else
+    {
+        ast->nodes[parent_node->last_child_].next_sibling = child;
+    }
+
+    parent_node->last_child_ = child;
+}
+
+void FlatAstAddChildrenFromKTree(FlatAst *ast, const KTreeNode *node)
+{
+    for (const KTreeNode *child = node->l_child; child != NULL; child = child->r_sibling)
+    {
+        FlatAstAddChildRight(ast, node->value->flat_index, child->value->flat_index);
+    }
+}
+
+void FlatAstPreOrderTraverse(const FlatAst *ast,
+                             int root,
+                             FlatAstNodeTraverseAction action,
+                             void *user_arg)
+{
+    // Holds the indices of visited nodes whose siblings are still pending
+    size_t stack_capacity = FLAT_AST_INITIAL_CAPACITY;
+    size_t stack_size = 0;
+    int *stack = (int *)malloc(stack_capacity * sizeof(int));
+    if (stack == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    int current_node = root;
+
+    while (stack_size != 0 || current_node != FLAT_AST_NO_NODE)
+    {
+        if (current_node != FLAT_AST_NO_NODE)
+        {
+            action(ast, current_node, stack_size, user_arg);
+
+            if (stack_size + 1 > stack_capacity)
+            {
+                stack_capacity *= 2;
+                stack = (int *)realloc(stack, stack_capacity * sizeof(int));
+                if (stack == NULL)
+                {
+                    MEMORY_ALLOC_FAILURE_EXIT;
+                }
+            }
+
+            stack[stack_size++] = current_node;
+            current_node = ast->nodes[current_node].first_child;
+        }
+        else
+        {
+            current_node = ast->nodes[stack[--stack_size]].next_sibling;
+        }
+    }
+
+    free(stack);
+}
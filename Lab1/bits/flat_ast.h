@@ -0,0 +1,60 @@
+#ifndef FLAT_AST_H_
+#define FLAT_AST_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "defs.h"
+#include "token.h"
+#include "variable.h"
+#include "k_tree.h"
+
+#define FLAT_AST_INITIAL_CAPACITY 1024
+#define FLAT_AST_NO_NODE -1
+
+// A fixed-size AST node record. Children are linked by indices into
+// FlatAst::nodes instead of pointers.
+typedef struct
+{
+    // Token type when is_token is true, otherwise variable type
+    int type;
+    bool is_token;
+    int line_start;
+    int column_start;
+    int first_child;
+    int next_sibling;
+    // Index into FlatAst::tokens, FLAT_AST_NO_NODE for variables
+    int token_index;
+    int last_child_;
+} FlatAstNode;
+
+// A contiguous AST built alongside the KTree by the parser.
+// Nodes are appended in the order the lexer and parser create them,
+// so children always precede their parent.
+typedef struct
+{
+    size_t size;
+    size_t token_count;
+    FlatAstNode *nodes;
+    Token *tokens;
+    size_t capacity_;
+    size_t token_capacity_;
+} FlatAst;
+
+typedef void (*FlatAstNodeTraverseAction)(const FlatAst *, int, size_t, void *);
+
+FlatAst *FlatAstCreate();
+void FlatAstFree(FlatAst *ast);
+// Returns the index of the new node
+int FlatAstAddTokenNode(FlatAst *ast, const Token *token);
+int FlatAstAddVariableNode(FlatAst *ast, const Variable *variable);
+void FlatAstAddChildRight(FlatAst *ast, int parent, int child);
+// Links the flat counterparts of all children of a freshly created KTree node.
+// Every node involved must carry a flat_index.
+void FlatAstAddChildrenFromKTree(FlatAst *ast, const KTreeNode *node);
+void FlatAstPreOrderTraverse(const FlatAst *ast,
+                             int root,
+                             FlatAstNodeTraverseAction action,
+                             void *user_arg);
+
+#endif
@@ -0,0 +1,187 @@
+#include "interner.h"
+
+// 32-bit FNV-1a
+static uint32_t InternerHash_(const char *value, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)value[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void InternerRehash_(Interner *interner, size_t bucket_count)
+{
+    free(interner->buckets_);
+
+    interner->buckets_ = (uint32_t *)calloc(bucket_count, sizeof(uint32_t));
+    if (interner->buckets_ == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    interner->bucket_count_ = bucket_count;
+
+    for (size_t id = 0; id < interner->size; id++)
+    {
+        size_t bucket = interner->entries_[id].hash & (bucket_count - 1);
+        while (interner->buckets_[bucket] != 0)
+        {
+            bucket = (bucket + 1) & (bucket_count - 1);
+        }
+
+        interner->buckets_[bucket] = id + 1;
+    }
+}
+
+Interner *InternerCreate()
+{
+    Interner *interner = (Interner *)malloc(sizeof(Interner));
+    if (interner == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    interner->entries_ = (InternerEntry *)malloc(INTERNER_INITIAL_CAPACITY * sizeof(InternerEntry));
+    interner->chars_ = (char *)malloc(INTERNER_INITIAL_CHARS_CAPACITY);
+    if (interner->entries_ == NULL || interner->chars_ == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    interner->size = 0;
+    interner->capacity_ = INTERNER_INITIAL_CAPACITY;
+    interner->chars_size_ = 0;
+    interner->chars_capacity_ = INTERNER_INITIAL_CHARS_CAPACITY;
+    interner->buckets_ = NULL;
+
+    // Bucket count is kept a power of 2 and at least twice the entry capacity
+    InternerRehash_(interner, 2 * INTERNER_INITIAL_CAPACITY);
+
+    InternerIntern(interner, "", 0);
+
+    return interner;
+}
+
+void InternerFree(Interner *interner)
+{
+    if (interner == NULL)
+    {
+        return;
+    }
+
+    free(interner->entries_);
+    free(interner->buckets_);
+    free(interner->chars_);
+    free(interner);
+}
+
+// Returns the bucket holding value, or the empty bucket where it should be inserted
+static size_t InternerProbe_(const Interner *interner,
+                             const char *value,
+                             size_t length,
+                             uint32_t hash)
+{
+    size_t bucket = hash & (interner->bucket_count_ - 1);
+
+    while (interner->buckets_[bucket] != 0)
+    {
+        const InternerEntry *entry = &interner->entries_[interner->buckets_[bucket] - 1];
+        if (entry->hash == hash &&
+            entry->length == length &&
+            memcmp(interner->chars_ + entry->offset, value, length) == 0)
+        {
+            break;
+        }
+
+        bucket = (bucket + 1) & (interner->bucket_count_ - 1);
+    }
+
+    return bucket;
+}
+
+InternId InternerIntern(Interner *interner, const char *value, size_t length)
+{
+    uint32_t hash = InternerHash_(value, length);
+    size_t bucket = InternerProbe_(interner, value, length, hash);
+
+    if (interner->buckets_[bucket] != 0)
+    {
+        return interner->buckets_[bucket] - 1;
+    }
+
+    if (interner->size + 1 > interner->capacity_)
+    {
+        interner->capacity_ *= 2;
+        interner->entries_ = (InternerEntry *)realloc(
+            interner->entries_, interner->capacity_ * sizeof(InternerEntry));
+        if (interner->entries_ == NULL)
+        {
+            MEMORY_ALLOC_FAILURE_EXIT;
+        }
+    }
+
+    while (interner->chars_size_ + length + 1 > interner->chars_capacity_)
+    {
+        interner->chars_capacity_ *= 2;
+        interner->chars_ = (char *)realloc(interner->chars_, interner->chars_capacity_);
+        if (interner->chars_ == NULL)
+        {
+            MEMORY_ALLOC_FAILURE_EXIT;
+        }
+    }
+
+    InternId id = interner->size;
+    InternerEntry *entry = &interner->entries_[id];
+    entry->offset = interner->chars_size_;
+    entry->length = length;
+    entry->hash = hash;
+
+    memcpy(interner->chars_ + interner->chars_size_, value, length);
+    interner->chars_[interner->chars_size_ + length] = '\0';
+    interner->chars_size_ += length + 1;
+
+    interner->buckets_[bucket] = id + 1;
+    interner->size++;
+
+    if (2 * interner->size > interner->bucket_count_)
+    {
+        InternerRehash_(interner, 2 * interner->bucket_count_);
+    }
+
+    return id;
+}
+
+InternId InternerInternString(Interner *interner, const char *value)
+{
+    return InternerIntern(interner, value, strlen(value));
+}
+
+bool InternerFind(const Interner *interner, const char *value, size_t length, InternId *id)
+{
+    size_t bucket = InternerProbe_(interner,
+                                   value,
+                                   length,
+                                   InternerHash_(value, length));
+
+    if (interner->buckets_[bucket] == 0)
+    {
+        return false;
+    }
+
+    *id = interner->buckets_[bucket] - 1;
+    return true;
+}
+
+const char *InternerGetString(const Interner *interner, InternId id)
+{
+    return interner->chars_ + interner->entries_[id].offset;
+}
+
+size_t InternerGetLength(const Interner *interner, InternId id)
+{
+    return interner->entries_[id].length;
+}
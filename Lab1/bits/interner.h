@@ -0,0 +1,52 @@
+#ifndef INTERNER_H_
+#define INTERNER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "defs.h"
+
+#define INTERNER_INITIAL_CAPACITY 1024
+#define INTERNER_INITIAL_CHARS_CAPACITY 16384
+
+// The empty string is always interned as 0
+#define INTERN_ID_EMPTY 0
+
+typedef uint32_t InternId;
+
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+    uint32_t hash;
+} InternerEntry;
+
+// Stores every distinct string once and identifies it by a dense 32-bit id.
+// Strings are kept NUL-terminated in a single character pool.
+typedef struct
+{
+    // Number of distinct strings
+    size_t size;
+    InternerEntry *entries_;
+    size_t capacity_;
+    // Open addressing table holding id+1, 0 means empty
+    uint32_t *buckets_;
+    size_t bucket_count_;
+    char *chars_;
+    size_t chars_size_;
+    size_t chars_capacity_;
+} Interner;
+
+Interner *InternerCreate();
+void InternerFree(Interner *interner);
+InternId InternerIntern(Interner *interner, const char *value, size_t length);
+InternId InternerInternString(Interner *interner, const char *value);
+// Returns whether value has been interned, storing its id in *id if so
+bool InternerFind(const Interner *interner, const char *value, size_t length, InternId *id);
+// The returned pointer is invalidated by the next InternerIntern() call
+const char *InternerGetString(const Interner *interner, InternId id);
+size_t InternerGetLength(const Interner *interner, InternId id);
+
+#endif
@@ -1,19 +1,8 @@
 #include "k_tree.h"
 
-static KTreeNodeFreeValueAction KTreeFreeNodeValue = NULL;
-
-static void KTreeFreeNode_(KTreeNode *node, size_t, void *)
+KTreeNode *KTreeCreateNode(Arena *arena, KTreeNodeValue *value)
 {
-    KTreeFreeNodeValue(&node->value);
-}
-
-KTreeNode *KTreeCreateNode(KTreeNodeValue *value)
-{
-    KTreeNode *node = (KTreeNode *)malloc(sizeof(KTreeNode));
-    if (node == NULL)
-    {
-        MEMORY_ALLOC_FAILURE_EXIT;
-    }
+    KTreeNode *node = (KTreeNode *)ArenaAllocate(arena, sizeof(KTreeNode));
 
     node->l_child = NULL;
     node->r_child = NULL;
@@ -23,9 +12,9 @@ KTreeNode *KTreeCreateNode(KTreeNodeValue *value)
     return node;
 }
 
-KTreeNode *KTreeCreateNodeWithChidren(KTreeNodeValue *value, int argc, ...)
+KTreeNode *KTreeCreateNodeWithChidren(Arena *arena, KTreeNodeValue *value, int argc, ...)
 {
-    KTreeNode *root = KTreeCreateNode(value);
+    KTreeNode *root = KTreeCreateNode(arena, value);
 
     va_list children;
     va_start(children, argc);
@@ -45,12 +34,6 @@ KTreeNode *KTreeCreateNodeWithChidren(KTreeNodeValue *value, int argc, ...)
     return root;
 }
 
-void KTreeFree(KTreeNode *root, KTreeNodeFreeValueAction action)
-{
-    KTreeFreeNodeValue = action;
-    KTreePreOrderTraverse(root, KTreeFreeNode_, NULL);
-}
-
 void KTreeAddChildRight(KTreeNode *root, KTreeNode *child)
 {
     // Empty root
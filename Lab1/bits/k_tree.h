@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include "defs.h"
+#include "arena.h"
 #include "ast_node.h"
 
 typedef AstNode *KTreeNodeValue;
@@ -20,13 +21,13 @@ typedef struct KTreeNode_
 } KTreeNode;
 
 typedef void (*KTreeNodeTraverseAction)(KTreeNode *, size_t, void *);
-typedef void (*KTreeNodeFreeValueAction)(KTreeNodeValue *);
 
 #include "stack.h"
 
-KTreeNode *KTreeCreateNode(KTreeNodeValue *value);
-KTreeNode *KTreeCreateNodeWithChidren(KTreeNodeValue *value, int argc, ...);
-void KTreeFree(KTreeNode *root, KTreeNodeFreeValueAction action);
+// Nodes live in the arena together with their values,
+// so a whole tree is released at once by ArenaFree().
+KTreeNode *KTreeCreateNode(Arena *arena, KTreeNodeValue *value);
+KTreeNode *KTreeCreateNodeWithChidren(Arena *arena, KTreeNodeValue *value, int argc, ...);
 void KTreeAddChildRight(KTreeNode *root, KTreeNode *child);
 void KTreePreOrderTraverse(KTreeNode *root, KTreeNodeTraverseAction action, void *user_arg);
 
@@ -0,0 +1,156 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "source_buffer.h"
+
+#define SOURCE_BUFFER_READ_CHUNK_SIZE 65536
+
+static bool SourceBufferMap_(SourceBuffer *buffer, int fd, size_t size)
+{
+    size_t mapped_length = size + SOURCE_BUFFER_PADDING;
+
+    // Reserve zeroed pages for content and padding first, then map the
+    // file over the front of them. Bytes past EOF in the last file page
+    // are zero-filled by the kernel and the remaining pages stay anonymous,
+    // so the padding never touches memory beyond the file mapping.
+    // Pages are writable copy-on-write because flex temporarily
+    // writes a '\0' after the current token.
+    char *data = (char *)mmap(NULL,
+                              mapped_length,
+                              PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS,
+                              -1,
+                              0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    if (size > 0 &&
+        mmap(data,
+             size,
+             PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED,
+             fd,
+             0) == MAP_FAILED)
+    {
+        munmap(data, mapped_length);
+        return false;
+    }
+
+    buffer->data = data;
+    buffer->size = size;
+    buffer->is_mapped_ = true;
+    buffer->mapped_length_ = mapped_length;
+
+    return true;
+}
+
+static bool SourceBufferRead_(SourceBuffer *buffer, int fd)
+{
+    size_t capacity = SOURCE_BUFFER_READ_CHUNK_SIZE;
+    size_t size = 0;
+    char *data = (char *)malloc(capacity);
+    if (data == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    while (true)
+    {
+        if (capacity - size <= SOURCE_BUFFER_PADDING)
+        {
+            capacity *= 2;
+            data = (char *)realloc(data, capacity);
+            if (data == NULL)
+            {
+                MEMORY_ALLOC_FAILURE_EXIT;
+            }
+        }
+
+        ssize_t read_size = read(fd, data + size, capacity - size - SOURCE_BUFFER_PADDING);
+        if (read_size < 0)
+        {
+            free(data);
+            return false;
+        }
+
+        if (read_size == 0)
+        {
+            break;
+        }
+
+        size += read_size;
+    }
+
+    for (int i = 0; i < SOURCE_BUFFER_PADDING; i++)
+    {
+        data[size + i] = '\0';
+    }
+
+    buffer->data = data;
+    buffer->size = size;
+    buffer->is_mapped_ = false;
+    buffer->mapped_length_ = 0;
+
+    return true;
+}
+
+SourceBuffer *SourceBufferOpen(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    SourceBuffer *buffer = (SourceBuffer *)malloc(sizeof(SourceBuffer));
+    if (buffer == NULL)
+    {
+        MEMORY_ALLOC_FAILURE_EXIT;
+    }
+
+    struct stat file_stat;
+    bool success = false;
+
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode))
+    {
+        success = SourceBufferMap_(buffer, fd, (size_t)file_stat.st_size);
+    }
+
+    if (!success)
+    {
+        success = SourceBufferRead_(buffer, fd);
+    }
+
+    // A mapping stays valid after its file descriptor is closed
+    close(fd);
+
+    if (!success)
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+void SourceBufferClose(SourceBuffer *buffer)
+{
+    if (buffer == NULL)
+    {
+        return;
+    }
+
+    if (buffer->is_mapped_)
+    {
+        munmap(buffer->data, buffer->mapped_length_);
+    }
+    else
+    {
+        free(buffer->data);
+    }
+
+    free(buffer);
+}
@@ -0,0 +1,29 @@
+#ifndef SOURCE_BUFFER_H_
+#define SOURCE_BUFFER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "defs.h"
+
+// yy_scan_buffer() requires the last two bytes of its buffer
+// to be YY_END_OF_BUFFER_CHAR ('\0')
+#define SOURCE_BUFFER_PADDING 2
+
+// The whole content of a source file, followed by SOURCE_BUFFER_PADDING
+// zero bytes so that it can be scanned in place by yy_scan_buffer().
+// Regular files are mapped privately into memory; anything else
+// (pipes, character devices) is read into a heap buffer.
+typedef struct
+{
+    char *data;
+    // Size of the file content, padding excluded
+    size_t size;
+    bool is_mapped_;
+    size_t mapped_length_;
+} SourceBuffer;
+
+// Returns NULL if the file cannot be opened or read
+SourceBuffer *SourceBufferOpen(const char *path);
+void SourceBufferClose(SourceBuffer *buffer);
+
+#endif
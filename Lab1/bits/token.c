@@ -1,47 +1,28 @@
 #include "token.h"
 
-Token *TokenCreate(const int line_start,
+Token *TokenCreate(Arena *arena,
+                   Interner *interner,
+                   const int line_start,
                    const int column_start,
                    const int type,
-                   const char *value)
+                   const char *value,
+                   const size_t value_length)
 {
-    Token *token = (Token *)malloc(sizeof(Token));
-    if (token == NULL)
-    {
-        MEMORY_ALLOC_FAILURE_EXIT;
-    }
+    Token *token = (Token *)ArenaAllocate(arena, sizeof(Token));
 
     token->line_start = line_start;
     token->column_start = column_start;
     token->type = type;
+    token->value = INTERN_ID_EMPTY;
 
     if (value != NULL)
     {
-        size_t value_length = strlen(value);
-
-        if (value_length > TOKEN_VALUE_MAX_LENGTH)
-        {
-            fprintf(stderr,
-                    "Token value length too long: Line %d, Column %d\n",
-                    line_start,
-                    column_start);
-            exit(FAILURE);
-        }
-
-        strcpy(token->value, value);
+        token->value = InternerIntern(interner, value, value_length);
     }
 
     return token;
 }
 
-void TokenFree(Token *token)
-{
-    if (token != NULL)
-    {
-        free(token);
-    }
-}
-
 #define COPY_TOKEN_NAME_BREAK(NAME) \
     strcpy(buffer, NAME);           \
     break
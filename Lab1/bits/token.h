@@ -5,8 +5,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include "defs.h"
+#include "arena.h"
+#include "interner.h"
 
-#define TOKEN_VALUE_MAX_LENGTH 50
 #define TOKEN_NAME_BUFFER_SIZE 30
 
 // Token types
@@ -58,15 +59,19 @@ typedef struct
     int line_start;
     int column_start;
     int type;
-    char value[TOKEN_VALUE_MAX_LENGTH + 1];
+    // Interned lexeme, INTERN_ID_EMPTY for tokens whose lexeme carries no information
+    InternId value;
 } Token;
 
-Token *TokenCreate(const int line_start,
+// value may be NULL, in which case nothing is interned.
+// value need not be null-terminated; lexemes of any length are accepted.
+Token *TokenCreate(Arena *arena,
+                   Interner *interner,
+                   const int line_start,
                    const int column_start,
                    const int type,
-                   const char *value);
-
-void TokenFree(Token *token);
+                   const char *value,
+                   const size_t value_length);
 
 void GetTokenName(char *buffer, const int type);
 
@@ -1,14 +1,11 @@
 #include "variable.h"
 
-Variable *VariableCreate(const int line_start,
+Variable *VariableCreate(Arena *arena,
+                         const int line_start,
                          const int column_start,
                          const int type)
 {
-    Variable *variable = (Variable *)malloc(sizeof(Variable));
-    if (variable == NULL)
-    {
-        MEMORY_ALLOC_FAILURE_EXIT;
-    }
+    Variable *variable = (Variable *)ArenaAllocate(arena, sizeof(Variable));
 
     variable->line_start = line_start;
     variable->column_start = column_start;
@@ -17,14 +14,6 @@ Variable *VariableCreate(const int line_start,
     return variable;
 }
 
-void VariableFree(Variable *variable)
-{
-    if (variable != NULL)
-    {
-        free(variable);
-    }
-}
-
 #define COPY_VARIABLE_NAME_BREAK(NAME) \
     strcpy(buffer, NAME);              \
     break
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "defs.h"
+#include "arena.h"
 
 #define VARIABLE_NAME_BUFFER_SIZE 30
 
@@ -39,12 +40,11 @@ typedef struct
     int type;
 } Variable;
 
-Variable *VariableCreate(const int line_start,
+Variable *VariableCreate(Arena *arena,
+                         const int line_start,
                          const int column_start,
                          const int type);
 
-void VariableFree(Variable *variable);
-
 void GetVariableName(char *buffer, const int type);
 
 #endif
\ No newline at end of file
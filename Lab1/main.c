@@ -1,33 +1,30 @@
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "./bits/defs.h"
+#include "./bits/arena.h"
+#include "./bits/interner.h"
 #include "./bits/token.h"
 #include "./bits/ast_node.h"
 #include "./bits/k_tree.h"
+#include "./bits/flat_ast.h"
+#include "./bits/source_buffer.h"
+#include "./bits/compilation_context.h"
 
-KTreeNode *kRoot = NULL;
-bool kHasLexicalError = false;
-bool kHasSyntaxError = false;
-
-extern int yyparse(void);
-extern void yyrestart(FILE *input_file);
-
-void FreeKTreeNode(KTreeNodeValue *node)
-{
-    AstNodeFree(*node);
-}
-
-void PrintAstNode(KTreeNode *node, size_t current_level, void *)
+// interner is passed as the traversal's user argument
+void PrintAstNode(const FlatAst *ast, int index, size_t current_level, void *interner)
 {
     for (int i = 0; i < current_level; i++)
     {
         printf("  ");
     }
 
-    if (node->value->is_token)
+    const FlatAstNode *node = &ast->nodes[index];
+
+    if (node->is_token)
     {
         char token_name_buffer[TOKEN_NAME_BUFFER_SIZE];
-        Token *token = node->value->ast_node_value.token;
+        const Token *token = &ast->tokens[node->token_index];
         GetTokenName(token_name_buffer, token->type);
 
         switch (token->type)
@@ -37,7 +34,7 @@ void PrintAstNode(KTreeNode *node, size_t current_level, void *)
         case TOKEN_KEYWORD_TYPE_FLOAT:
         case TOKEN_LITERAL_INT:
         case TOKEN_LITERAL_FP:
-            printf("%s: %s\n", token_name_buffer, token->value);
+            printf("%s: %s\n", token_name_buffer, InternerGetString((const Interner *)interner, token->value));
             break;
         default:
             printf("%s\n", token_name_buffer);
@@ -47,40 +44,55 @@ void PrintAstNode(KTreeNode *node, size_t current_level, void *)
     else
     {
         char variable_name_buffer[VARIABLE_NAME_BUFFER_SIZE];
-        GetVariableName(variable_name_buffer, node->value->ast_node_value.variable->type);
+        GetVariableName(variable_name_buffer, node->type);
         printf("%s (%d)\n",
                variable_name_buffer,
-               node->value->ast_node_value.variable->line_start);
+               node->line_start);
     }
 }
 
+// Usage: parser [<input-file-path> [--arena-stats]]
 int main(int argc, char *argv[])
 {
+    CompilationContext *context = CompilationContextCreate();
+
     if (argc == 1)
     {
-        yyparse();
+        CompilationContextParseFile(context, stdin);
     }
     else
     {
-        FILE *source_file = fopen(argv[1], "r");
-        if (source_file == NULL)
+        SourceBuffer *source_buffer = SourceBufferOpen(argv[1]);
+        if (source_buffer == NULL)
         {
             fprintf(stderr, "Failed to open %s\n", argv[1]);
+            CompilationContextFree(context);
             return FAILURE;
         }
 
-        yyrestart(source_file);
-        yyparse();
+        // Scan the file content in place, without copying it into flex's buffers
+        CompilationContextParseBuffer(
+            context,
+            source_buffer->data,
+            source_buffer->size + SOURCE_BUFFER_PADDING);
 
-        fclose(source_file);
+        SourceBufferClose(source_buffer);
+    }
+
+    if (!context->has_lexical_error && !context->has_syntax_error)
+    {
+        FlatAstPreOrderTraverse(context->flat_ast,
+                                context->root->value->flat_index,
+                                PrintAstNode,
+                                context->interner);
     }
 
-    if (!kHasLexicalError && !kHasSyntaxError)
+    if (argc > 2 && strcmp(argv[2], "--arena-stats") == 0)
     {
-        KTreePreOrderTraverse(kRoot, PrintAstNode, NULL);
+        ArenaPrintStats(context->arena, stderr);
     }
 
-    KTreeFree(kRoot, FreeKTreeNode);
+    CompilationContextFree(context);
 
     return SUCCESS;
 }
\ No newline at end of file
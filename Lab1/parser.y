@@ -1,11 +1,22 @@
+%code requires{
+#include "../bits/compilation_context.h"
+
+// Same guard as the scanner header, which declares the identical typedef
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+}
+
 %{
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "../bits/arena.h"
 #include "../bits/token.h"
 #include "../bits/variable.h"
 #include "../bits/k_tree.h"
-#include "lex_analyser.h"
+#include "../bits/flat_ast.h"
 
 // LOC(@$) must be explicitly referenced in action section 
 // because references macro will not trigger the generation 
@@ -14,9 +25,10 @@
 // inside a macro
 #define CREATE_VARIABLE_NODE(LOC,VAL,TYPE,ARGC,...) \
 do{\
-    Variable* variable=VariableCreate(LOC.first_line,LOC.first_column,TYPE);\
-    AstNode* ast_node=AstNodeCreate(false,variable);\
-    VAL=KTreeCreateNodeWithChidren(&ast_node,ARGC,##__VA_ARGS__);\
+    Variable* variable=VariableCreate(context->arena,LOC.first_line,LOC.first_column,TYPE);\
+    AstNode* ast_node=AstNodeCreate(context->arena,false,variable,FlatAstAddVariableNode(context->flat_ast,variable));\
+    VAL=KTreeCreateNodeWithChidren(context->arena,&ast_node,ARGC,##__VA_ARGS__);\
+    FlatAstAddChildrenFromKTree(context->flat_ast,VAL);\
 }while(false)
 
 #define CREATE_EMPTY_VARIABLE_NODE(VAL) \
@@ -26,16 +38,26 @@ do{\
 
 #define MARK_SYNTAX_ERROR \
 do{\
-    kHasSyntaxError=true;\
+    context->has_syntax_error=true;\
 }while(false)
 
-extern KTreeNode* kRoot;
-extern bool kHasSyntaxError;
+// List rules are right-recursive, so the parser stack grows with the
+// length of a list. The default limit of 10000 caps a function body
+// at a few thousand statements.
+#define YYMAXDEPTH 10000000
+%}
+
+%code{
+// Declares yylex() with the bison-bridge signature,
+// so it has to follow the definitions of YYSTYPE and YYLTYPE
+#include "lex_analyser.h"
 
-void yyerror(const char* msg){
-    fprintf(stderr, "Error type B at line %d: %s.\n", yylineno, msg);
+void yyerror(YYLTYPE* loc, yyscan_t scanner, CompilationContext* context, const char* msg){
+    // Also covers errors that no error rule recovers from
+    context->has_syntax_error=true;
+    fprintf(stderr, "Error type B at line %d: %s.\n", yyget_lineno(scanner), msg);
+}
 }
-%}
 
 %union{
     KTreeNode *k_tree_node;
@@ -87,9 +109,13 @@ void yyerror(const char* msg){
 %nonassoc ELSE
 
 %define parse.error detailed
+%define api.pure full
+%locations
+%param {yyscan_t scanner}
+%parse-param {CompilationContext* context}
 
 %%
-Program:ExtDefList {CREATE_VARIABLE_NODE(@$,$$,VARIABLE_PROGRAM,1,$1);kRoot=$$;}
+Program:ExtDefList {CREATE_VARIABLE_NODE(@$,$$,VARIABLE_PROGRAM,1,$1);context->root=$$;}
     ;
 
 ExtDefList: ExtDef ExtDefList {CREATE_VARIABLE_NODE(@$,$$,VARIABLE_EXT_DEF_LIST, 2, $1, $2);}
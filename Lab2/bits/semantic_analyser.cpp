@@ -1,7 +1,9 @@
 #include "semantic_analyser.h"
 
-void SemanticAnalyser::Analyse(const KTreeNode *root)
+void SemanticAnalyser::Analyse(const KTreeNode *root, const FlatAst *flat_ast)
 {
+    flat_ast_ = flat_ast;
+
     if (root != NULL &&
         root->l_child != NULL &&
         !root->l_child->value->is_token &&
@@ -13,6 +15,8 @@ void SemanticAnalyser::Analyse(const KTreeNode *root)
     {
         PrintError(-1, 0, "Invalid root node");
     }
+
+    flat_ast_ = nullptr;
 }
 
 void SemanticAnalyser::PrintKTreeNodeInfo(const KTreeNode *node) const
@@ -22,7 +26,7 @@ void SemanticAnalyser::PrintKTreeNodeInfo(const KTreeNode *node) const
         std::cout << "Token, Type="
                   << (node->value->ast_node_value.token->type)
                   << " Value="
-                  << (node->value->ast_node_value.token->value)
+                  << GetInternedString(node->value->ast_node_value.token->value)
                   << " LineNumber="
                   << (node->value->ast_node_value.token->line_start)
                   << " ColumnNumber="
@@ -82,7 +86,7 @@ void SemanticAnalyser::PrintSymbolTable() const
 
     for (auto &symbol : symbol_table_)
     {
-        PrintLine(symbol.first,
+        PrintLine(GetInternedString(symbol.first),
                   GetVariableSymbolTypeName(symbol.second),
                   std::to_string(symbol.second->GetLineNumber()),
                   symbol.second->GetIsInitialized() ? "Yes" : "No");
@@ -113,13 +117,13 @@ void SemanticAnalyser::PrintStructDefSymbolTable() const
 
     for (auto &symbol : struct_def_symbol_table_)
     {
-        std::cout << "struct " << symbol.first << std::endl;
+        std::cout << "struct " << GetInternedString(symbol.first) << std::endl;
         std::cout << std::string(4, ' ') << "Line Number: " << symbol.second->GetLineNumber() << std::endl;
         std::cout << std::string(4, ' ') << "Fields:" << std::endl;
         for (auto &field : symbol.second->GetFields())
         {
             std::cout << std::string(8, ' ')
-                      << std::setw(kFieldNameWidth) << field->GetName()
+                      << std::setw(kFieldNameWidth) << GetInternedString(field->GetName())
                       << std::setw(kFieldTypeWidth) << GetVariableSymbolTypeName(field)
                       << std::setw(0)
                       << std::endl;
@@ -137,6 +141,11 @@ int SemanticAnalyser::GetKTreeNodeLineNumber(const KTreeNode *node) const
                : node->value->ast_node_value.variable->line_start;
 }
 
+std::string SemanticAnalyser::GetInternedString(const InternId id) const
+{
+    return InternerGetString(interner_, id);
+}
+
 // symbol cannot be nullptr
 std::string SemanticAnalyser::GetVariableSymbolTypeName(const VariableSymbolSharedPtr &symbol) const
 {
@@ -180,7 +189,8 @@ std::string SemanticAnalyser::GetVariableSymbolTypeName(const VariableSymbol *sy
         return "function";
 
     case VariableSymbolType::STRUCT:
-        return "struct " + static_cast<const StructSymbol *>(variable_symbol)->GetStructName();
+        return "struct " + GetInternedString(
+                               static_cast<const StructSymbol *>(variable_symbol)->GetStructName());
 
     case VariableSymbolType::UNKNOWN:
     default:
@@ -192,19 +202,22 @@ void SemanticAnalyser::PrintError(
     const int type, const int line_number, const std::string &message)
 {
     has_error_ = true;
-    std::cerr << "Error type " << type << " at Line " << line_number << ": " << message << std::endl;
+    // One write per line keeps diagnostics of concurrent compilations apart
+    std::cerr << "Error type " + std::to_string(type) +
+                     " at Line " + std::to_string(line_number) +
+                     ": " + message + '\n';
 }
 
-std::string SemanticAnalyser::GetNewAnnoyStructName()
+InternId SemanticAnalyser::GetNewAnnoyStructName()
 {
     std::string annoy_name_prefix = "[struct_annoy]";
-    std::string new_annoy_name;
+    InternId new_annoy_name;
 
     do
     {
         std::ostringstream oss;
         oss << std::hex << distribution_(mt19937_);
-        new_annoy_name = annoy_name_prefix + oss.str();
+        new_annoy_name = InternerInternString(interner_, (annoy_name_prefix + oss.str()).c_str());
     } while (struct_def_symbol_table_.find(new_annoy_name) != struct_def_symbol_table_.end());
 
     return new_annoy_name;
@@ -327,7 +340,7 @@ bool SemanticAnalyser::InsertVariableSymbol(const VariableSymbolSharedPtr &symbo
                    (symbol->GetVariableSymbolType() == VariableSymbolType::FUNCTION
                         ? "Duplicate function name: '"
                         : "Duplicate variable name: '") +
-                       symbol->GetName() + '\'');
+                       GetInternedString(symbol->GetName()) + '\'');
 
         return false;
     }
@@ -344,7 +357,18 @@ void SemanticAnalyser::DoExtDefList(const KTreeNode *node)
     // ExtDefList: ExtDef ExtDefList(Nullable) | <NULL>
     while (node != NULL)
     {
+        if (time_report_ != nullptr)
+        {
+            time_report_->BeginExtDef(GetKTreeNodeLineNumber(node->l_child));
+        }
+
         DoExtDef(node->l_child);
+
+        if (time_report_ != nullptr)
+        {
+            time_report_->EndExtDef();
+        }
+
         node = node->r_child;
     }
 }
@@ -489,7 +513,7 @@ std::vector<VariableSymbolSharedPtr> SemanticAnalyser::DoDecListDefCommon(
             // Struct
             else
             {
-                std::string struct_name = static_cast<StructSymbol *>(specifier.get())->GetStructName();
+                InternId struct_name = static_cast<StructSymbol *>(specifier.get())->GetStructName();
                 if (struct_def_symbol_table_.find(struct_name) == struct_def_symbol_table_.end())
                 {
                     PrintError(kErrorUndefinedStruct, specifier->GetLineNumber(),
@@ -597,7 +621,7 @@ VariableSymbolSharedPtr SemanticAnalyser::DoSpecifier(const KTreeNode *node)
     {
         return std::make_shared<ArithmeticSymbol>(
             GetKTreeNodeLineNumber(node->l_child),
-            "",
+            INTERN_ID_EMPTY,
             node->l_child->value->ast_node_value.token->type == TOKEN_KEYWORD_TYPE_INT
                 ? ArithmeticSymbolType::INT
                 : ArithmeticSymbolType::FLOAT);
@@ -622,7 +646,7 @@ VariableSymbolSharedPtr SemanticAnalyser::DoSpecifier(const KTreeNode *node)
 // Return value contains struct name.
 std::shared_ptr<StructSymbol> SemanticAnalyser::DoStructSpecifier(const KTreeNode *node)
 {
-    std::string struct_name;
+    InternId struct_name;
 
     // StructSpecifier: STRUCT Tag
     if (!node->l_child->r_sibling->value->is_token &&
@@ -634,12 +658,12 @@ std::shared_ptr<StructSymbol> SemanticAnalyser::DoStructSpecifier(const KTreeNod
         if (struct_def_symbol_table_.find(struct_name) != struct_def_symbol_table_.end())
         {
             return std::make_shared<StructSymbol>(
-                GetKTreeNodeLineNumber(struct_id_node), "", struct_name);
+                GetKTreeNodeLineNumber(struct_id_node), INTERN_ID_EMPTY, struct_name);
         }
 
         PrintError(kErrorUndefinedStruct,
                    GetKTreeNodeLineNumber(struct_id_node),
-                   "Struct '" + struct_name + "' is not defined");
+                   "Struct '" + GetInternedString(struct_name) + "' is not defined");
         return nullptr;
     }
     // StructSpecifier: STRUCT OptTag L_BRACE DefList(Nullable) R_BRACE
@@ -664,7 +688,7 @@ std::shared_ptr<StructSymbol> SemanticAnalyser::DoStructSpecifier(const KTreeNod
             {
                 PrintError(kErrorDuplicateStructName,
                            GetKTreeNodeLineNumber(node->l_child->r_sibling->l_child),
-                           "Duplicate struct name '" + struct_name + '\'');
+                           "Duplicate struct name '" + GetInternedString(struct_name) + '\'');
                 return nullptr;
             }
         }
@@ -677,7 +701,7 @@ std::shared_ptr<StructSymbol> SemanticAnalyser::DoStructSpecifier(const KTreeNod
         }
 
         // Checks kErrorDuplicateStructFieldName
-        std::unordered_set<std::string> field_names;
+        std::unordered_set<InternId> field_names;
         for (auto &field : fields)
         {
             if (!field)
@@ -689,7 +713,7 @@ std::shared_ptr<StructSymbol> SemanticAnalyser::DoStructSpecifier(const KTreeNod
             {
                 PrintError(kErrorDuplicateStructFieldName,
                            field->GetLineNumber(),
-                           "Duplicate field '" + field->GetName() + "'");
+                           "Duplicate field '" + GetInternedString(field->GetName()) + "'");
                 return nullptr;
             }
             else
@@ -710,7 +734,7 @@ std::shared_ptr<StructSymbol> SemanticAnalyser::DoStructSpecifier(const KTreeNod
             {
                 PrintError(kErrorStructFieldInitialized,
                            field->GetLineNumber(),
-                           "Struct field '" + field->GetName() + "' is initialized");
+                           "Struct field '" + GetInternedString(field->GetName()) + "' is initialized");
 
                 return nullptr;
             }
@@ -719,7 +743,7 @@ std::shared_ptr<StructSymbol> SemanticAnalyser::DoStructSpecifier(const KTreeNod
         struct_def_symbol_table_[struct_name] = std::make_shared<StructDefSymbol>(
             GetKTreeNodeLineNumber(node->l_child), struct_name, fields);
 
-        return std::make_shared<StructSymbol>(GetKTreeNodeLineNumber(node->l_child), "", struct_name);
+        return std::make_shared<StructSymbol>(GetKTreeNodeLineNumber(node->l_child), INTERN_ID_EMPTY, struct_name);
     }
 }
 
@@ -813,13 +837,20 @@ VariableSymbolSharedPtr SemanticAnalyser::DoDec(const KTreeNode *node)
 // or an ArraySymbol with name and element symbol.
 VariableSymbolSharedPtr SemanticAnalyser::DoVarDec(const KTreeNode *node)
 {
+    return DoVarDec(node->value->flat_index);
+}
+
+VariableSymbolSharedPtr SemanticAnalyser::DoVarDec(const int flat_index)
+{
+    const FlatAstNode &node = flat_ast_->nodes[flat_index];
+    const FlatAstNode &first_child = flat_ast_->nodes[node.first_child];
+
     // VarDec: ID
-    if (node->l_child->value->is_token &&
-        node->l_child->value->ast_node_value.token->type == TOKEN_ID)
+    if (first_child.is_token && first_child.type == TOKEN_ID)
     {
         return std::make_shared<VariableSymbol>(
-            GetKTreeNodeLineNumber(node->l_child),
-            node->l_child->value->ast_node_value.token->value,
+            first_child.line_start,
+            flat_ast_->tokens[first_child.token_index].value,
             VariableSymbolType::UNKNOWN);
     }
 
@@ -827,17 +858,20 @@ VariableSymbolSharedPtr SemanticAnalyser::DoVarDec(const KTreeNode *node)
 
     // Note that int a[2][3] should be interpreted as array<array<int,3>,2>,
     // But ArraySymbol views it as array<array<int,2>,3>
-    auto array_element = DoVarDec(node->l_child);
+    auto array_element = DoVarDec(node.first_child);
     if (!array_element)
     {
         return nullptr;
     }
 
+    const FlatAstNode &size_node =
+        flat_ast_->nodes[flat_ast_->nodes[first_child.next_sibling].next_sibling];
+
     return std::make_shared<ArraySymbol>(
         array_element->GetLineNumber(),
         array_element->GetName(),
         array_element,
-        std::stoull(node->l_child->r_sibling->r_sibling->value->ast_node_value.token->value));
+        std::stoull(GetInternedString(flat_ast_->tokens[size_node.token_index].value)));
 }
 
 // Returns a function symbol containing name and arguments information.
@@ -845,7 +879,7 @@ VariableSymbolSharedPtr SemanticAnalyser::DoVarDec(const KTreeNode *node)
 // then it is ignored as if the function didn't take that argument.
 std::shared_ptr<FunctionSymbol> SemanticAnalyser::DoFunDec(const KTreeNode *node)
 {
-    std::string function_name = node->l_child->value->ast_node_value.token->value;
+    InternId function_name = node->l_child->value->ast_node_value.token->value;
 
     // FunDec: ID L_BRACKET R_BRACKET
     if (node->l_child->r_sibling->r_sibling->value->is_token)
@@ -1075,7 +1109,7 @@ std::pair<VariableSymbolSharedPtr, bool> SemanticAnalyser::DoExp(const KTreeNode
             {
             case TOKEN_ID:
             {
-                std::string variable_name = node->l_child->value->ast_node_value.token->value;
+                InternId variable_name = node->l_child->value->ast_node_value.token->value;
                 if (symbol_table_.find(variable_name) != symbol_table_.end())
                 {
                     return {symbol_table_.at(variable_name), true};
@@ -1084,7 +1118,7 @@ std::pair<VariableSymbolSharedPtr, bool> SemanticAnalyser::DoExp(const KTreeNode
                 {
                     PrintError(kErrorUndefinedVariable,
                                GetKTreeNodeLineNumber(node->l_child),
-                               "Undefined variable '" + variable_name + '\'');
+                               "Undefined variable '" + GetInternedString(variable_name) + '\'');
                     return kNullptrFalse;
                 }
             }
@@ -1092,7 +1126,7 @@ std::pair<VariableSymbolSharedPtr, bool> SemanticAnalyser::DoExp(const KTreeNode
             {
                 return {std::make_shared<ArithmeticSymbol>(
                             GetKTreeNodeLineNumber(node->l_child),
-                            "",
+                            INTERN_ID_EMPTY,
                             ArithmeticSymbolType::INT),
                         false};
             }
@@ -1100,7 +1134,7 @@ std::pair<VariableSymbolSharedPtr, bool> SemanticAnalyser::DoExp(const KTreeNode
             {
                 return {std::make_shared<ArithmeticSymbol>(
                             GetKTreeNodeLineNumber(node->l_child),
-                            "",
+                            INTERN_ID_EMPTY,
                             ArithmeticSymbolType::FLOAT),
                         false};
             }
@@ -1117,13 +1151,13 @@ std::pair<VariableSymbolSharedPtr, bool> SemanticAnalyser::DoExp(const KTreeNode
             node->l_child->r_sibling->value->ast_node_value.token->type ==
                 TOKEN_DELIMITER_L_BRACKET)
         {
-            std::string function_name = node->l_child->value->ast_node_value.token->value;
+            InternId function_name = node->l_child->value->ast_node_value.token->value;
             // No such callee symbol
             if (symbol_table_.find(function_name) == symbol_table_.end())
             {
                 PrintError(kErrorUndefinedFunction,
                            GetKTreeNodeLineNumber(node->l_child),
-                           "Cannot find function '" + function_name + '\'');
+                           "Cannot find function '" + GetInternedString(function_name) + '\'');
 
                 return kNullptrFalse;
             }
@@ -1299,14 +1333,14 @@ std::pair<VariableSymbolSharedPtr, bool> SemanticAnalyser::DoExp(const KTreeNode
                 return kNullptrFalse;
             }
 
-            std::string struct_name = static_cast<StructSymbol *>(struct_exp.first.get())->GetStructName();
+            InternId struct_name = static_cast<StructSymbol *>(struct_exp.first.get())->GetStructName();
 
             if (struct_def_symbol_table_.find(struct_name) == struct_def_symbol_table_.end())
             {
                 return kNullptrFalse;
             }
 
-            std::string field_name = node->r_child->value->ast_node_value.token->value;
+            InternId field_name = node->r_child->value->ast_node_value.token->value;
 
             auto struct_fields = struct_def_symbol_table_.at(struct_name)->GetFields();
 
@@ -1325,7 +1359,7 @@ std::pair<VariableSymbolSharedPtr, bool> SemanticAnalyser::DoExp(const KTreeNode
                            '\'' +
                                GetVariableSymbolTypeName(struct_exp.first) +
                                "' has no field '" +
-                               field_name +
+                               GetInternedString(field_name) +
                                '\'');
 
                 return kNullptrFalse;
@@ -1419,7 +1453,7 @@ std::pair<VariableSymbolSharedPtr, bool> SemanticAnalyser::DoExp(const KTreeNode
 
             return {std::make_shared<ArithmeticSymbol>(
                         l_exp.first->GetLineNumber(),
-                        "",
+                        INTERN_ID_EMPTY,
                         ArithmeticSymbolType::INT),
                     false};
         }
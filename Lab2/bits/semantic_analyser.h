@@ -15,6 +15,8 @@
 extern "C"
 {
 #include "../../Lab1/bits/k_tree.h"
+#include "../../Lab1/bits/flat_ast.h"
+#include "../../Lab1/bits/interner.h"
 #include "../../Lab1/bits/token.h"
 #include "../../Lab1/bits/variable.h"
 }
@@ -27,8 +29,11 @@ extern "C"
 #include "./symbols/struct_def_symbol.h"
 #include "./symbols/symbol_type.h"
 
-using SymbolTable = std::unordered_map<std::string, VariableSymbolSharedPtr>;
-using StructDefSymbolTable = std::unordered_map<std::string, StructDefSymbolSharedPtr>;
+#include "time_report.h"
+
+// Both tables are keyed by interned names
+using SymbolTable = std::unordered_map<InternId, VariableSymbolSharedPtr>;
+using StructDefSymbolTable = std::unordered_map<InternId, StructDefSymbolSharedPtr>;
 
 class SemanticAnalyser
 {
@@ -38,6 +43,15 @@ private:
     SymbolTable symbol_table_;
     StructDefSymbolTable struct_def_symbol_table_;
 
+    // Shared with the lexer. Anonymous struct names are interned into it as well.
+    Interner *interner_;
+
+    // Only valid during Analyse()
+    const FlatAst *flat_ast_;
+
+    // Optional, receives per-ExtDef measurements
+    TimeReport *time_report_;
+
     std::random_device random_device_;
     std::mt19937 mt19937_;
     std::uniform_int_distribution<> distribution_;
@@ -65,13 +79,21 @@ private:
     static constexpr int kErrorUndefinedStruct = 17;          // Impled
 
 public:
-    SemanticAnalyser(const SymbolTable &builtin_symbols)
+    SemanticAnalyser(const SymbolTable &builtin_symbols, Interner *interner)
         : has_error_(false),
           symbol_table_(builtin_symbols),
+          interner_(interner),
+          flat_ast_(nullptr),
+          time_report_(nullptr),
           mt19937_(random_device_()) {}
-    SemanticAnalyser() : SemanticAnalyser(SymbolTable()) {}
+    SemanticAnalyser(Interner *interner) : SemanticAnalyser(SymbolTable(), interner) {}
 
-    void Analyse(const KTreeNode *root);
+    void Analyse(const KTreeNode *root, const FlatAst *flat_ast);
+
+    void SetTimeReport(TimeReport *time_report)
+    {
+        time_report_ = time_report;
+    }
 
     // Debug only
     void PrintKTreeNodeInfo(const KTreeNode *node) const;
@@ -96,11 +118,12 @@ public:
 
 private:
     int GetKTreeNodeLineNumber(const KTreeNode *node) const;
+    std::string GetInternedString(const InternId id) const;
     std::string GetVariableSymbolTypeName(const VariableSymbolSharedPtr &symbol) const;
     std::string GetVariableSymbolTypeName(const VariableSymbol *symbol) const;
     void PrintError(
         const int type, const int line_number, const std::string &message);
-    std::string GetNewAnnoyStructName();
+    InternId GetNewAnnoyStructName();
 
     bool IsIntArithmeticSymbol(const VariableSymbol &var) const;
     bool IsSameTypeArithmeticSymbol(const VariableSymbol &var1, const VariableSymbol &var2) const;
@@ -118,6 +141,8 @@ private:
     // Refer to C-- syntax defined in Lab1/parser.y for a better understanding of each method
     // Contract: Functions that return a single ptr may return nullptr.
     //           Functions that return a vector of ptr also preserve nullptr in that vector.
+    // Methods taking a flat node index walk flat_ast_ directly. Their KTreeNode
+    // overloads only forward to them, so the rest can be ported one at a time.
     void DoExtDefList(const KTreeNode *node);
     void DoExtDef(const KTreeNode *node);
     std::vector<VariableSymbolSharedPtr> DoDecListDefCommon(
@@ -131,6 +156,7 @@ private:
     std::vector<VariableSymbolSharedPtr> DoDecList(const KTreeNode *node);
     VariableSymbolSharedPtr DoDec(const KTreeNode *node);
     VariableSymbolSharedPtr DoVarDec(const KTreeNode *node);
+    VariableSymbolSharedPtr DoVarDec(const int flat_index);
     std::shared_ptr<FunctionSymbol> DoFunDec(const KTreeNode *node);
     std::vector<VariableSymbolSharedPtr> DoVarList(const KTreeNode *node);
     VariableSymbolSharedPtr DoParamDec(const KTreeNode *node);
@@ -10,7 +10,7 @@ private:
 public:
     ArithmeticSymbol(
         const int line_number,
-        const std::string &name,
+        const InternId name,
         const ArithmeticSymbolType arithmetic_symbol_type,
         const bool is_initialized = false,
         const VariableSymbolSharedPtr &initial_value = nullptr)
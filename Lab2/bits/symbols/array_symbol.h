@@ -10,7 +10,7 @@ private:
 
 public:
     ArraySymbol(const int line_number,
-                const std::string &name,
+                const InternId name,
                 const VariableSymbolSharedPtr &elem_type,
                 const size_t size,
                 const bool is_initialized = false,
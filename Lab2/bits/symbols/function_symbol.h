@@ -13,7 +13,7 @@ private:
 public:
     FunctionSymbol(
         const int line_number,
-        const std::string &name,
+        const InternId name,
         const std::vector<VariableSymbolSharedPtr> &args,
         const VariableSymbolSharedPtr &return_type,
         const bool is_initialized = false,
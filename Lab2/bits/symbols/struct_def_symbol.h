@@ -13,7 +13,7 @@ private:
 public:
     StructDefSymbol(
         const int line_number,
-        const std::string &name,
+        const InternId name,
         const std::vector<VariableSymbolSharedPtr> &fields)
         : Symbol(line_number, name, SymbolType::STRUCT_DEF),
           fields_(fields) {}
@@ -7,19 +7,19 @@
 class StructSymbol : public VariableSymbol
 {
 private:
-    std::string struct_name_;
+    InternId struct_name_;
 
 public:
     StructSymbol(
         const int line_number,
-        const std::string &name,
-        const std::string &struct_name,
+        const InternId name,
+        const InternId struct_name,
         const bool is_initialized = false,
         const VariableSymbolSharedPtr &initial_value = nullptr)
         : VariableSymbol(line_number, name, VariableSymbolType::STRUCT, is_initialized, initial_value),
           struct_name_(struct_name) {}
 
-    std::string GetStructName() const
+    InternId GetStructName() const
     {
         return struct_name_;
     }
@@ -3,6 +3,11 @@
 #include <string>
 #include <memory>
 
+extern "C"
+{
+#include "../../../Lab1/bits/interner.h"
+}
+
 #include "symbol_type.h"
 
 /****************************************************************
@@ -25,12 +30,13 @@ class Symbol
 {
 private:
     int line_number_;
-    std::string name_;
+    // Interned name, INTERN_ID_EMPTY for a symbol that only describes a type
+    InternId name_;
     SymbolType symbol_type_;
 
 public:
     Symbol(const int line_number,
-           const std::string &name,
+           const InternId name,
            const SymbolType symbol_type)
         : line_number_(line_number),
           name_(name),
@@ -46,7 +52,7 @@ public:
         line_number_ = line_number;
     }
 
-    std::string GetName() const
+    InternId GetName() const
     {
         return name_;
     }
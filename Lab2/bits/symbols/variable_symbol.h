@@ -15,7 +15,7 @@ private:
 
 public:
     VariableSymbol(const int line_number,
-                   const std::string &name,
+                   const InternId name,
                    const VariableSymbolType variable_symbol_type,
                    const bool is_initialized = false,
                    const std::shared_ptr<VariableSymbol> &initial_value = nullptr)
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <sys/resource.h>
+
+#include "time_report.h"
+
+thread_local uint64_t thread_allocation_count = 0;
+thread_local uint64_t thread_allocated_bytes = 0;
+
+TimeReport::Snapshot TimeReport::TakeSnapshot()
+{
+    timespec cpu_time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time);
+
+    return {std::chrono::steady_clock::now(),
+            cpu_time.tv_sec * 1e3 + cpu_time.tv_nsec / 1e6,
+            thread_allocation_count,
+            thread_allocated_bytes};
+}
+
+ResourceMeasurement TimeReport::MeasureSince(const Snapshot &start)
+{
+    Snapshot end = TakeSnapshot();
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return {std::chrono::duration<double, std::milli>(end.wall_time - start.wall_time).count(),
+            end.cpu_time_ms - start.cpu_time_ms,
+            usage.ru_maxrss,
+            end.allocation_count - start.allocation_count,
+            end.allocated_bytes - start.allocated_bytes};
+}
+
+void TimeReport::Accumulate(ResourceMeasurement &total, const ResourceMeasurement &measurement)
+{
+    total.wall_time_ms += measurement.wall_time_ms;
+    total.cpu_time_ms += measurement.cpu_time_ms;
+    total.peak_rss_kb = std::max(total.peak_rss_kb, measurement.peak_rss_kb);
+    total.allocation_count += measurement.allocation_count;
+    total.allocated_bytes += measurement.allocated_bytes;
+}
+
+void TimeReport::Deduct(ResourceMeasurement &measurement, const ResourceMeasurement &part)
+{
+    measurement.wall_time_ms -= part.wall_time_ms;
+    measurement.cpu_time_ms -= part.cpu_time_ms;
+    measurement.allocation_count -= part.allocation_count;
+    measurement.allocated_bytes -= part.allocated_bytes;
+}
+
+void TimeReport::BeginPhase(const std::string &name)
+{
+    phases_.push_back({name, {}, {}});
+    interleaved_name_.clear();
+    phase_interleaved_ = {};
+    phase_start_ = TakeSnapshot();
+}
+
+void TimeReport::EndPhase()
+{
+    PhaseMeasurement &phase = phases_.back();
+    phase.measurement = MeasureSince(phase_start_);
+
+    if (!interleaved_name_.empty())
+    {
+        Deduct(phase.measurement, phase_interleaved_);
+        phases_.push_back({interleaved_name_, phase_interleaved_, {}});
+    }
+}
+
+void TimeReport::BeginInterleavedPhase(const std::string &name)
+{
+    interleaved_name_ = name;
+    interleaved_start_ = TakeSnapshot();
+}
+
+void TimeReport::EndInterleavedPhase()
+{
+    ResourceMeasurement measurement = MeasureSince(interleaved_start_);
+    Accumulate(phase_interleaved_, measurement);
+    Accumulate(ext_def_interleaved_, measurement);
+}
+
+void TimeReport::BeginExtDef(const int line_number)
+{
+    if (!track_ext_defs_)
+    {
+        return;
+    }
+
+    ext_def_line_number_ = line_number;
+    ext_def_interleaved_ = {};
+    ext_def_start_ = TakeSnapshot();
+}
+
+void TimeReport::EndExtDef()
+{
+    if (!track_ext_defs_)
+    {
+        return;
+    }
+
+    ResourceMeasurement measurement = MeasureSince(ext_def_start_);
+    Deduct(measurement, ext_def_interleaved_);
+    phases_.back().ext_defs.push_back({ext_def_line_number_, measurement});
+}
+
+void TimeReport::SetArenaStats(const size_t bytes_used, const size_t block_count)
+{
+    arena_bytes_used_ = bytes_used;
+    arena_block_count_ = block_count;
+}
+
+void TimeReport::PrintTextRow(std::ostream &stream,
+                              const std::string &name,
+                              const ResourceMeasurement &measurement)
+{
+    stream << std::left << std::setw(24) << name << std::right
+           << std::setw(12) << measurement.wall_time_ms
+           << std::setw(12) << measurement.cpu_time_ms
+           << std::setw(14) << measurement.peak_rss_kb
+           << std::setw(10) << measurement.allocation_count
+           << std::setw(14) << measurement.allocated_bytes
+           << '\n';
+}
+
+void TimeReport::PrintText(std::ostream &stream) const
+{
+    ResourceMeasurement total = {0.0, 0.0, 0, 0, 0};
+
+    stream << "[Time Report] " << input_path_ << '\n'
+           << std::left << std::setw(24) << "Phase" << std::right
+           << std::setw(12) << "Wall(ms)"
+           << std::setw(12) << "CPU(ms)"
+           << std::setw(14) << "PeakRSS(KB)"
+           << std::setw(10) << "Allocs"
+           << std::setw(14) << "AllocBytes"
+           << '\n'
+           << std::fixed << std::setprecision(3);
+
+    for (auto &phase : phases_)
+    {
+        PrintTextRow(stream, phase.name, phase.measurement);
+
+        for (auto &ext_def : phase.ext_defs)
+        {
+            PrintTextRow(stream,
+                         "  ExtDef@" + std::to_string(ext_def.line_number),
+                         ext_def.measurement);
+        }
+
+        Accumulate(total, phase.measurement);
+    }
+
+    PrintTextRow(stream, "Total", total);
+
+    stream << "Arena: " << arena_bytes_used_ << " bytes used in "
+           << arena_block_count_ << " block(s)" << std::endl;
+}
+
+void TimeReport::PrintJsonMeasurement(std::ostream &stream,
+                                      const ResourceMeasurement &measurement)
+{
+    stream << "\"wall_time_ms\":" << measurement.wall_time_ms
+           << ",\"cpu_time_ms\":" << measurement.cpu_time_ms
+           << ",\"peak_rss_kb\":" << measurement.peak_rss_kb
+           << ",\"allocation_count\":" << measurement.allocation_count
+           << ",\"allocated_bytes\":" << measurement.allocated_bytes;
+}
+
+void TimeReport::PrintJson(std::ostream &stream) const
+{
+    stream << std::fixed << std::setprecision(3)
+           << "{\"input\":\"" << EscapeJsonString(input_path_) << "\",\"phases\":[";
+
+    for (size_t i = 0; i < phases_.size(); i++)
+    {
+        auto &phase = phases_[i];
+
+        stream << (i == 0 ? "" : ",")
+               << "{\"name\":\"" << EscapeJsonString(phase.name) << "\",";
+        PrintJsonMeasurement(stream, phase.measurement);
+
+        if (track_ext_defs_)
+        {
+            stream << ",\"ext_defs\":[";
+            for (size_t j = 0; j < phase.ext_defs.size(); j++)
+            {
+                stream << (j == 0 ? "" : ",")
+                       << "{\"line\":" << phase.ext_defs[j].line_number << ',';
+                PrintJsonMeasurement(stream, phase.ext_defs[j].measurement);
+                stream << '}';
+            }
+            stream << ']';
+        }
+
+        stream << '}';
+    }
+
+    stream << "],\"arena\":{\"bytes_used\":" << arena_bytes_used_
+           << ",\"block_count\":" << arena_block_count_ << "}}";
+}
+
+std::string TimeReport::EscapeJsonString(const std::string &value)
+{
+    std::string escaped;
+
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                escaped += buffer;
+            }
+            else
+            {
+                escaped += c;
+            }
+            break;
+        }
+    }
+
+    return escaped;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum class TimeReportFormat
+{
+    NONE,
+    TEXT,
+    JSON
+};
+
+// Global operator new calls and bytes requested by the calling thread.
+// Counted by the replacement operator new of Lab3/bits/allocation_counter.cpp;
+// they stay zero in binaries that do not link it, such as the Lab2 parser.
+// C code allocates from arenas instead, which are reported separately.
+extern thread_local uint64_t thread_allocation_count;
+extern thread_local uint64_t thread_allocated_bytes;
+
+// Resource usage of one phase, or of one top-level ExtDef within a phase.
+// Time and allocation counts belong to the calling thread only, so they stay
+// meaningful when several files are compiled concurrently. Peak RSS is
+// tracked by the OS per process.
+struct ResourceMeasurement
+{
+    double wall_time_ms;
+    double cpu_time_ms;
+    // Peak RSS of the whole process at the end of the measurement
+    long peak_rss_kb;
+    // Global operator new calls and bytes requested through them
+    uint64_t allocation_count;
+    uint64_t allocated_bytes;
+};
+
+// Collects per-phase measurements of one compilation and prints them
+// as a table or as JSON. BeginPhase()/EndPhase() pairs must not nest;
+// BeginExtDef()/EndExtDef() and BeginInterleavedPhase()/EndInterleavedPhase()
+// pairs may only occur inside a phase.
+class TimeReport
+{
+private:
+    struct Snapshot
+    {
+        std::chrono::steady_clock::time_point wall_time;
+        double cpu_time_ms;
+        uint64_t allocation_count;
+        uint64_t allocated_bytes;
+    };
+
+    struct ExtDefMeasurement
+    {
+        int line_number;
+        ResourceMeasurement measurement;
+    };
+
+    struct PhaseMeasurement
+    {
+        std::string name;
+        ResourceMeasurement measurement;
+        std::vector<ExtDefMeasurement> ext_defs;
+    };
+
+    const std::string input_path_;
+    const bool track_ext_defs_;
+
+    std::vector<PhaseMeasurement> phases_;
+    Snapshot phase_start_;
+    Snapshot ext_def_start_;
+    int ext_def_line_number_;
+
+    // The interleaved phase of the current phase, empty if there is none
+    std::string interleaved_name_;
+    Snapshot interleaved_start_;
+    // Interleaved so far in the current phase and in the current ExtDef
+    ResourceMeasurement phase_interleaved_;
+    ResourceMeasurement ext_def_interleaved_;
+
+    size_t arena_bytes_used_;
+    size_t arena_block_count_;
+
+public:
+    TimeReport(const std::string &input_path, const bool track_ext_defs)
+        : input_path_(input_path),
+          track_ext_defs_(track_ext_defs),
+          ext_def_line_number_(0),
+          phase_interleaved_(),
+          ext_def_interleaved_(),
+          arena_bytes_used_(0),
+          arena_block_count_(0) {}
+
+    void BeginPhase(const std::string &name);
+    void EndPhase();
+
+    // No-ops unless ExtDef tracking was requested
+    void BeginExtDef(const int line_number);
+    void EndExtDef();
+
+    // Charges what happens until EndInterleavedPhase() to the phase name
+    // instead of the current phase and ExtDef, e.g. work done for each
+    // ExtDef as soon as it is generated. All intervals of a phase add up to
+    // one row, listed right after the current phase.
+    void BeginInterleavedPhase(const std::string &name);
+    void EndInterleavedPhase();
+
+    void SetArenaStats(const size_t bytes_used, const size_t block_count);
+
+    void PrintText(std::ostream &stream) const;
+    void PrintJson(std::ostream &stream) const;
+
+private:
+    static Snapshot TakeSnapshot();
+    static ResourceMeasurement MeasureSince(const Snapshot &start);
+    // Adds the times and allocations of measurement to total
+    static void Accumulate(ResourceMeasurement &total, const ResourceMeasurement &measurement);
+    // Subtracts the times and allocations of part from measurement
+    static void Deduct(ResourceMeasurement &measurement, const ResourceMeasurement &part);
+    static void PrintTextRow(std::ostream &stream,
+                             const std::string &name,
+                             const ResourceMeasurement &measurement);
+    static void PrintJsonMeasurement(std::ostream &stream,
+                                     const ResourceMeasurement &measurement);
+    static std::string EscapeJsonString(const std::string &value);
+};
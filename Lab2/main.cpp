@@ -3,61 +3,61 @@
 extern "C"
 {
 #include "../Lab1/bits/defs.h"
+#include "../Lab1/bits/arena.h"
+#include "../Lab1/bits/interner.h"
 #include "../Lab1/bits/token.h"
 #include "../Lab1/bits/ast_node.h"
 #include "../Lab1/bits/k_tree.h"
-#include "../Lab1/generated/lex_analyser.h"
-#include "../Lab1/generated/parser.h"
+#include "../Lab1/bits/flat_ast.h"
+#include "../Lab1/bits/source_buffer.h"
+#include "../Lab1/bits/compilation_context.h"
 }
 
 #include "./bits/semantic_analyser.h"
 
-KTreeNode *kRoot = NULL;
-bool kHasLexicalError = false;
-bool kHasSyntaxError = false;
-
-void FreeKTreeNode(KTreeNodeValue *node)
-{
-    AstNodeFree(*node);
-}
-
 int main(int argc, char *argv[])
 {
+    CompilationContext *context = CompilationContextCreate();
+
     if (argc == 1)
     {
-        yyparse();
+        CompilationContextParseFile(context, stdin);
     }
     else
     {
-        FILE *source_file = fopen(argv[1], "r");
-        if (source_file == NULL)
+        SourceBuffer *source_buffer = SourceBufferOpen(argv[1]);
+        if (source_buffer == NULL)
         {
             fprintf(stderr, "Failed to open %s\n", argv[1]);
+            CompilationContextFree(context);
             return FAILURE;
         }
 
-        yyrestart(source_file);
-        yyparse();
+        // Scan the file content in place, without copying it into flex's buffers
+        CompilationContextParseBuffer(
+            context,
+            source_buffer->data,
+            source_buffer->size + SOURCE_BUFFER_PADDING);
 
-        fclose(source_file);
+        SourceBufferClose(source_buffer);
     }
 
-    if (kHasLexicalError || kHasSyntaxError)
+    if (context->has_lexical_error || context->has_syntax_error)
     {
-        KTreeFree(kRoot, FreeKTreeNode);
+        CompilationContextFree(context);
         return FAILURE;
     }
 
-    SemanticAnalyser semantic_analyser;
+    SemanticAnalyser semantic_analyser(context->interner);
 
-    semantic_analyser.Analyse(kRoot);
+    semantic_analyser.Analyse(context->root, context->flat_ast);
     if (semantic_analyser.GetHasError())
     {
-        KTreeFree(kRoot, FreeKTreeNode);
+        CompilationContextFree(context);
         return FAILURE;
     }
 
-    KTreeFree(kRoot, FreeKTreeNode);
+    CompilationContextFree(context);
 
     return SUCCESS;
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
-for file in ./test/*.cmm
-    do
-        echo Testing with $file
-        ./parse.sh $file
-    done
\ No newline at end of file
+mkdir -p out out/O1 out/O2
+./build/parser --batch ./out ./test/*.cmm
+./build/parser -O1 --batch ./out/O1 ./test/*.cmm
+./build/parser -O2 --batch ./out/O2 ./test/*.cmm
+# extra13 declares an array in a loop, whose address LICM hoists above its DEC
+mkdir -p out/mips32/O1 out/mips32/O2
+./build/parser -O1 --target=mips32 ./test/extra13.cmm ./out/mips32/O1/extra13.cmm.s
+./build/parser -O2 --target=mips32 ./test/extra13.cmm ./out/mips32/O2/extra13.cmm.s
@@ -0,0 +1,45 @@
+#!/bin/bash
+# Compiles programs whose expressions and statements nest deeper and deeper
+# and prints the IR generation time of each. Instruction lists are spliced
+# in O(1), so doubling the depth should roughly double the time.
+# Usage: [PARSER=<compiler>] ./benchmark-nesting.sh [<max-depth>]
+
+MAX_DEPTH=${1:-32000}
+
+# Every nesting level is a few frames of recursion in each pass
+ulimit -s unlimited 2>/dev/null
+
+mkdir -p out/benchmark-nesting
+
+# Exp: L_BRACKET Exp R_BRACKET and binary operations, nested depth times
+generate_expression() {
+    local depth=$1
+    local opening=$(printf '%*s' "$depth" '' | tr ' ' '(')
+    local closing=$(printf '%*s' "$depth" '' | sed 's/ /+ 1)/g')
+    printf 'int main()\n{\n    int x = 1;\n    x = %sx %s;\n    return x;\n}\n' \
+        "$opening" "$closing"
+}
+
+# Stmt: IF L_BRACKET Exp R_BRACKET Stmt with a CompSt body, nested depth times
+generate_statement() {
+    local depth=$1
+    printf 'int main()\n{\n    int x = 1;\n'
+    printf '%*s' "$depth" '' | sed 's/ /if (x) { x = x + 1; /g'
+    printf 'x = 0;'
+    printf '%*s' "$depth" '' | sed 's/ / }/g'
+    printf '\n    return x;\n}\n'
+}
+
+for shape in expression statement; do
+    echo "[$shape]"
+    printf '%10s %18s\n' Depth 'IR generation(ms)'
+    depth=1000
+    while [ "$depth" -le "$MAX_DEPTH" ]; do
+        input=out/benchmark-nesting/$shape-$depth.cmm
+        generate_$shape "$depth" > "$input"
+        ir_ms=$(${PARSER:-./build/parser} --time-report "$input" "${input%.cmm}.ir" |
+            awk '/^IR generation/ { print $3 }')
+        printf '%10d %18s\n' "$depth" "$ir_ms"
+        depth=$((depth * 2))
+    done
+done
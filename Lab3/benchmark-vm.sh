@@ -0,0 +1,45 @@
+#!/bin/bash
+# Compiles each test program at every optimization level, runs the IR in
+# the IR virtual machine with the same input and prints the instructions
+# each level executed and how long it ran.
+# Usage: ./benchmark-vm.sh [<input>] [<source-file>...]
+#   <input> is what READ gets, e.g. "6 4 2" (default), the sources
+#   default to ./test/*.cmm
+
+INPUT=${1:-6 4 2}
+shift
+SOURCES=("$@")
+if [ ${#SOURCES[@]} -eq 0 ]; then
+    SOURCES=(./test/*.cmm)
+fi
+
+LEVELS=(-O0 -O1 -O2)
+
+mkdir -p out/benchmark-vm
+
+printf '%-20s' Program
+for level in "${LEVELS[@]}"; do
+    printf '%16s %10s' "$level instrs" 'ms'
+done
+printf '\n'
+
+for source in "${SOURCES[@]}"; do
+    name=$(basename "$source" .cmm)
+    printf '%-20s' "$name"
+    for level in "${LEVELS[@]}"; do
+        ir=out/benchmark-vm/$name$level.ir
+        if ! ./build/parser "$level" "$source" "$ir" 2>/dev/null; then
+            printf '%16s %10s' 'compile error' '-'
+            continue
+        fi
+        # The Total row of the profile holds calls, instructions and time
+        total=$(echo "$INPUT" | ./build/irvm --profile "$ir" 2>&1 >/dev/null |
+            awk '/^Total/ { print $3, $4 }')
+        if [ -z "$total" ]; then
+            printf '%16s %10s' 'runtime error' '-'
+            continue
+        fi
+        printf '%16s %10s' $total
+    done
+    printf '\n'
+done
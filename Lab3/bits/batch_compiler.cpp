@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+extern "C"
+{
+#include "../../Lab1/bits/defs.h"
+}
+
+#include "file_compiler.h"
+#include "batch_compiler.h"
+
+static double GetElapsedMs(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+BatchCompiler::BatchCompiler(const std::vector<CompilationJob> &jobs,
+                             const CompileOptions &options,
+                             const size_t worker_count,
+                             const TimeReportFormat time_report_format,
+                             const bool track_ext_defs,
+                             const bool print_optimization_reports,
+                             const bool print_spill_reports)
+    : jobs_(jobs),
+      options_(options),
+      worker_count_(std::max<size_t>(
+          1,
+          std::min<size_t>(worker_count > 0
+                               ? worker_count
+                               : std::thread::hardware_concurrency(),
+                           jobs.size()))),
+      time_report_format_(time_report_format),
+      track_ext_defs_(track_ext_defs),
+      print_optimization_reports_(print_optimization_reports),
+      print_spill_reports_(print_spill_reports),
+      results_(jobs.size(), {false, 0.0}),
+      time_reports_(time_report_format == TimeReportFormat::NONE ? 0 : jobs.size()),
+      optimization_reports_(print_optimization_reports ? jobs.size() : 0),
+      spill_reports_(print_spill_reports ? jobs.size() : 0),
+      next_job_index_(0),
+      total_wall_time_ms_(0.0) {}
+
+bool BatchCompiler::Run()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    next_job_index_ = 0;
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < worker_count_; i++)
+    {
+        workers.emplace_back(&BatchCompiler::DoWork, this);
+    }
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    total_wall_time_ms_ = GetElapsedMs(start);
+
+    return std::all_of(results_.begin(),
+                       results_.end(),
+                       [](const JobResult &result)
+                       { return result.success; });
+}
+
+void BatchCompiler::DoWork()
+{
+    while (true)
+    {
+        size_t job_index = next_job_index_++;
+        if (job_index >= jobs_.size())
+        {
+            return;
+        }
+
+        const CompilationJob &job = jobs_[job_index];
+
+        // Each worker writes only to the slots of the jobs it claimed
+        TimeReport *time_report = nullptr;
+        if (time_report_format_ != TimeReportFormat::NONE)
+        {
+            time_reports_[job_index] = std::make_unique<TimeReport>(job.input_path,
+                                                                    track_ext_defs_);
+            time_report = time_reports_[job_index].get();
+        }
+
+        OptimizationReport *optimization_report = nullptr;
+        if (print_optimization_reports_)
+        {
+            optimization_reports_[job_index] =
+                std::make_unique<OptimizationReport>(job.input_path);
+            optimization_report = optimization_reports_[job_index].get();
+        }
+
+        SpillReport *spill_report = nullptr;
+        if (print_spill_reports_)
+        {
+            spill_reports_[job_index] = std::make_unique<SpillReport>(job.input_path);
+            spill_report = spill_reports_[job_index].get();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool success = CompileFile(job.input_path,
+                                   job.output_path,
+                                   options_,
+                                   time_report,
+                                   optimization_report,
+                                   spill_report) == SUCCESS;
+
+        results_[job_index] = {success, GetElapsedMs(start)};
+    }
+}
+
+void BatchCompiler::PrintSummary(std::ostream &stream) const
+{
+    size_t failure_count = 0;
+    double job_time_sum_ms = 0.0;
+
+    stream << std::fixed << std::setprecision(3);
+
+    for (size_t i = 0; i < jobs_.size(); i++)
+    {
+        const JobResult &result = results_[i];
+
+        if (!result.success)
+        {
+            failure_count++;
+        }
+
+        job_time_sum_ms += result.wall_time_ms;
+
+        stream << (result.success ? "OK    " : "FAIL  ")
+               << std::setw(12) << result.wall_time_ms << " ms  "
+               << jobs_[i].input_path << '\n';
+    }
+
+    stream << jobs_.size() << " file(s), "
+           << failure_count << " failed, "
+           << worker_count_ << " worker(s): "
+           << total_wall_time_ms_ << " ms wall, "
+           << job_time_sum_ms << " ms summed over files"
+           << std::endl;
+}
+
+void BatchCompiler::PrintTimeReports(std::ostream &stream) const
+{
+    if (time_report_format_ == TimeReportFormat::JSON)
+    {
+        stream << '[';
+        for (size_t i = 0; i < time_reports_.size(); i++)
+        {
+            stream << (i == 0 ? "" : ",");
+            time_reports_[i]->PrintJson(stream);
+        }
+        stream << ']' << std::endl;
+    }
+    else if (time_report_format_ == TimeReportFormat::TEXT)
+    {
+        for (auto &time_report : time_reports_)
+        {
+            time_report->PrintText(stream);
+        }
+    }
+}
+
+void BatchCompiler::PrintOptimizationReports(std::ostream &stream) const
+{
+    for (auto &optimization_report : optimization_reports_)
+    {
+        optimization_report->PrintText(stream);
+    }
+}
+
+void BatchCompiler::PrintSpillReports(std::ostream &stream) const
+{
+    for (auto &spill_report : spill_reports_)
+    {
+        spill_report->PrintText(stream);
+    }
+}
+
+bool BatchCompiler::ReadManifest(const std::string &manifest_path,
+                                 std::vector<CompilationJob> &jobs)
+{
+    std::ifstream manifest_file(manifest_path);
+    if (!manifest_file.is_open())
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(manifest_file, line))
+    {
+        std::istringstream line_stream(line);
+        CompilationJob job;
+
+        if (!(line_stream >> job.input_path) || job.input_path[0] == '#')
+        {
+            continue;
+        }
+
+        if (!(line_stream >> job.output_path))
+        {
+            return false;
+        }
+
+        jobs.push_back(job);
+    }
+
+    return true;
+}
+
+bool BatchCompiler::HasUniqueOutputs(const std::vector<CompilationJob> &jobs,
+                                     std::string &duplicate_path)
+{
+    std::unordered_set<std::string> output_paths;
+    for (auto &job : jobs)
+    {
+        // Spellings such as out/x.ir and out/./x.ir name the same file
+        std::string output_path =
+            std::filesystem::path(job.output_path).lexically_normal().string();
+        if (!output_paths.insert(output_path).second)
+        {
+            duplicate_path = job.output_path;
+            return false;
+        }
+    }
+
+    return true;
+}
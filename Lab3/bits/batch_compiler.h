@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../Lab2/bits/time_report.h"
+#include "file_compiler.h"
+
+struct CompilationJob
+{
+    std::string input_path;
+    std::string output_path;
+};
+
+// Compiles many files on a fixed pool of worker threads.
+// Workers repeatedly claim the next unstarted job, so long
+// files do not hold up the rest of the queue.
+class BatchCompiler
+{
+private:
+    struct JobResult
+    {
+        bool success;
+        double wall_time_ms;
+    };
+
+    const std::vector<CompilationJob> jobs_;
+    const CompileOptions options_;
+    const size_t worker_count_;
+    const TimeReportFormat time_report_format_;
+    const bool track_ext_defs_;
+    const bool print_optimization_reports_;
+    const bool print_spill_reports_;
+
+    std::vector<JobResult> results_;
+    // One per job, empty unless a time report was requested
+    std::vector<std::unique_ptr<TimeReport>> time_reports_;
+    // One per job, empty unless optimization reports were requested
+    std::vector<std::unique_ptr<OptimizationReport>> optimization_reports_;
+    // One per job, empty unless spill reports were requested
+    std::vector<std::unique_ptr<SpillReport>> spill_reports_;
+    std::atomic<size_t> next_job_index_;
+    double total_wall_time_ms_;
+
+public:
+    // worker_count of 0 means one worker per hardware thread
+    BatchCompiler(const std::vector<CompilationJob> &jobs,
+                  const CompileOptions &options = CompileOptions(),
+                  const size_t worker_count = 0,
+                  const TimeReportFormat time_report_format = TimeReportFormat::NONE,
+                  const bool track_ext_defs = false,
+                  const bool print_optimization_reports = false,
+                  const bool print_spill_reports = false);
+
+    // Returns whether every job succeeded
+    bool Run();
+    void PrintSummary(std::ostream &stream) const;
+    // Prints the time report of every job in job order; JSON reports form an array
+    void PrintTimeReports(std::ostream &stream) const;
+    // Prints the optimization report of every job in job order
+    void PrintOptimizationReports(std::ostream &stream) const;
+    // Prints the spill report of every job in job order
+    void PrintSpillReports(std::ostream &stream) const;
+
+    // Reads one "<input-file-path> <output-file-path>" pair per line.
+    // Empty lines and lines starting with '#' are skipped.
+    static bool ReadManifest(const std::string &manifest_path,
+                             std::vector<CompilationJob> &jobs);
+    // Returns false and sets duplicate_path if two jobs write the same
+    // output file, which their workers would overwrite and remove at once
+    static bool HasUniqueOutputs(const std::vector<CompilationJob> &jobs,
+                                 std::string &duplicate_path);
+
+private:
+    void DoWork();
+};
@@ -0,0 +1,119 @@
+#include "cfg_dot_writer.h"
+
+CfgDotWriter::CfgDotWriter(const std::string &path,
+                           IrSink *next_sink,
+                           const Interner *interner)
+    : next_sink_(next_sink),
+      file_(path),
+      printer_(interner),
+      function_count_(0)
+{
+    file_ << "digraph CFG {\n"
+          << "    node [shape=box, fontname=monospace];\n";
+}
+
+void CfgDotWriter::Consume(const IrSequence &sequence)
+{
+    if (!sequence.empty() && sequence.front().opcode == IrOpcode::FUNCTION)
+    {
+        ControlFlowGraph cfg(sequence);
+        WriteFunction(cfg);
+        function_count_++;
+    }
+
+    next_sink_->Consume(sequence);
+}
+
+bool CfgDotWriter::Close()
+{
+    if (!file_.is_open())
+    {
+        return false;
+    }
+
+    file_ << "}\n";
+    file_.close();
+
+    return !file_.fail();
+}
+
+void CfgDotWriter::WriteFunction(const ControlFlowGraph &cfg)
+{
+    line_.clear();
+    printer_.PrintOperand(cfg.GetFunction().front().dest, line_);
+
+    file_ << "    subgraph cluster_" << function_count_ << " {\n"
+          << "        label=\"";
+    WriteEscaped(line_);
+    file_ << "\";\n";
+
+    for (size_t i = 0; i < cfg.GetBlockCount(); i++)
+    {
+        WriteBlock(cfg, i);
+    }
+
+    file_ << "    }\n";
+}
+
+void CfgDotWriter::WriteBlock(const ControlFlowGraph &cfg, const size_t index)
+{
+    const BasicBlock &block = cfg.GetBlock(index);
+
+    file_ << "        ";
+    WriteNodeName(index);
+    file_ << " [label=\"";
+
+    for (size_t i = block.begin; i < block.end; i++)
+    {
+        line_.clear();
+        printer_.Print(cfg.GetFunction()[i], line_);
+        WriteEscaped(line_);
+        // Left-justified line break
+        file_ << "\\l";
+    }
+
+    file_ << '"';
+    if (!cfg.IsReachable(index))
+    {
+        file_ << ", style=dashed";
+    }
+    file_ << "];\n";
+
+    const IrInstruction &last_instruction = cfg.GetLastInstruction(index);
+
+    for (size_t successor : block.successors)
+    {
+        file_ << "        ";
+        WriteNodeName(index);
+        file_ << " -> ";
+        WriteNodeName(successor);
+
+        // Tell the two ways out of an IF apart, unless they coincide
+        if (last_instruction.opcode == IrOpcode::IF && block.successors.size() == 2)
+        {
+            file_ << (successor == cfg.GetLabelBlock(last_instruction.dest.value)
+                          ? " [label=T]"
+                          : " [label=F]");
+        }
+
+        file_ << ";\n";
+    }
+}
+
+void CfgDotWriter::WriteNodeName(const size_t index)
+{
+    file_ << 'f' << function_count_ << "_b" << index;
+}
+
+void CfgDotWriter::WriteEscaped(const std::string &text)
+{
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            file_ << '\\';
+        }
+
+        file_ << c;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+#include "ir_printer.h"
+#include "ir_sink.h"
+#include "passes/control_flow_graph.h"
+
+// Writes the control flow graph of every function passing through it to a
+// Graphviz DOT file, one cluster per function, then forwards the IR
+// unchanged to the next sink. Blocks show their instructions; blocks not
+// reachable from the entry block are dashed.
+// Render with e.g. dot -Tsvg <path> -o <path>.svg
+class CfgDotWriter : public IrSink
+{
+private:
+    IrSink *next_sink_;
+    std::ofstream file_;
+    const IrPrinter printer_;
+    std::string line_;
+    size_t function_count_;
+
+public:
+    CfgDotWriter(const std::string &path, IrSink *next_sink, const Interner *interner);
+
+    bool IsOpen() const
+    {
+        return file_.is_open();
+    }
+
+    void Consume(const IrSequence &sequence) override;
+
+    // Closes the graph and the file. Returns whether every write succeeded.
+    bool Close();
+
+private:
+    void WriteFunction(const ControlFlowGraph &cfg);
+    void WriteBlock(const ControlFlowGraph &cfg, const size_t index);
+    void WriteNodeName(const size_t index);
+    // Writes text as the contents of a DOT string
+    void WriteEscaped(const std::string &text);
+};
@@ -20,14 +20,14 @@ private:
     size_t array_element_size_;
 
 public:
-    ArrayElementExpValue(const std::vector<std::string> &preparation_sequence,
-                         const std::string &final_value,
+    ArrayElementExpValue(IrList &&preparation_sequence,
+                         const IrOperand &final_value,
                          const VariableSymbolSharedPtr &source_type,
                          const size_t current_dim,
                          const std::vector<size_t> &array_dim_sizes,
                          const VariableSymbolSharedPtr &array_element_type,
                          const size_t array_element_size)
-        : ExpValue(preparation_sequence, final_value, source_type),
+        : ExpValue(std::move(preparation_sequence), final_value, source_type),
           current_dim_(current_dim),
           array_dim_sizes_(array_dim_sizes),
           array_element_type_(array_element_type),
@@ -3,34 +3,51 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 
 #include "../../../Lab2/bits/symbols/variable_symbol.h"
 
+#include "../ir_instruction.h"
+#include "../ir_list.h"
+#include "../pool_allocator.h"
+
 class ExpValue
 {
 private:
-    std::vector<std::string> preparation_sequence_;
-    std::string final_value_;
+    IrList preparation_sequence_;
+    IrValue final_value_;
     VariableSymbolSharedPtr source_type_;
 
 public:
-    ExpValue(const std::vector<std::string> &preparation_sequence,
-             const std::string &final_value,
+    ExpValue(IrList &&preparation_sequence,
+             const IrValue &final_value,
              const VariableSymbolSharedPtr &source_type)
-        : preparation_sequence_(preparation_sequence),
+        : preparation_sequence_(std::move(preparation_sequence)),
           final_value_(final_value),
           source_type_(source_type) {}
+    ExpValue(IrList &&preparation_sequence,
+             const IrOperand &final_value,
+             const VariableSymbolSharedPtr &source_type)
+        : ExpValue(std::move(preparation_sequence), IrValue::Singular(final_value), source_type) {}
 
-    std::vector<std::string> GetPreparationSequence() const
+    // The preparation sequence can be taken only once; the ExpValue
+    // is left with an empty one.
+    IrList TakePreparationSequence()
     {
-        return preparation_sequence_;
+        return std::move(preparation_sequence_);
     }
 
-    std::string GetFinalValue() const
+    IrValue GetFinalValue() const
     {
         return final_value_;
     }
 
+    // Only valid when the final value is singular
+    IrOperand GetFinalOperand() const
+    {
+        return final_value_.arg1;
+    }
+
     VariableSymbolSharedPtr GetSourceType() const
     {
         return source_type_;
@@ -38,3 +55,11 @@ public:
 };
 
 using ExpValueSharedPtr = std::shared_ptr<ExpValue>;
+
+// Every expression node creates an ExpValue and drops it once its parent
+// took the preparation sequence, so they come from a PoolAllocator
+template <typename T = ExpValue, typename... Args>
+ExpValueSharedPtr MakeExpValue(Args &&...args)
+{
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
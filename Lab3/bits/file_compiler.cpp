@@ -0,0 +1,243 @@
+#include <cstdio>
+#include <memory>
+
+extern "C"
+{
+#include "../../Lab1/bits/defs.h"
+#include "../../Lab1/bits/interner.h"
+#include "../../Lab1/bits/source_buffer.h"
+#include "../../Lab1/bits/compilation_context.h"
+}
+
+#include "../../Lab2/bits/semantic_analyser.h"
+#include "ir_generator.h"
+#include "cfg_dot_writer.h"
+#include "ir_optimizer.h"
+#include "ir_writer.h"
+#include "mips32_asm_writer.h"
+#include "x86_64_asm_writer.h"
+#include "file_compiler.h"
+
+const char *GetOutputExtension(const CompileTarget target)
+{
+    return target == CompileTarget::IR ? ".ir" : ".s";
+}
+
+int CompileFile(const std::string &input_path,
+                const std::string &output_path,
+                const CompileOptions &options,
+                TimeReport *time_report,
+                OptimizationReport *optimization_report,
+                SpillReport *spill_report)
+{
+    auto begin_phase = [time_report](const char *name)
+    {
+        if (time_report != nullptr)
+        {
+            time_report->BeginPhase(name);
+        }
+    };
+
+    auto end_phase = [time_report]()
+    {
+        if (time_report != nullptr)
+        {
+            time_report->EndPhase();
+        }
+    };
+
+    begin_phase("Read source");
+
+    SourceBuffer *source_buffer = SourceBufferOpen(input_path.c_str());
+    if (source_buffer == NULL)
+    {
+        std::cerr << "Failed to open input file " << input_path << std::endl;
+        end_phase();
+        return FAILURE;
+    }
+
+    end_phase();
+
+    begin_phase("Lex and parse");
+
+    CompilationContext *context = CompilationContextCreate();
+
+    // Scan the file content in place, without copying it into flex's buffers
+    CompilationContextParseBuffer(
+        context,
+        source_buffer->data,
+        source_buffer->size + SOURCE_BUFFER_PADDING);
+
+    SourceBufferClose(source_buffer);
+
+    end_phase();
+
+    if (time_report != nullptr)
+    {
+        time_report->SetArenaStats(context->arena->bytes_used,
+                                   context->arena->block_count);
+    }
+
+    if (context->has_lexical_error || context->has_syntax_error)
+    {
+        CompilationContextFree(context);
+        return FAILURE;
+    }
+
+    begin_phase("Semantic analysis");
+
+    InternId read_name = InternerInternString(context->interner, "read");
+    InternId write_name = InternerInternString(context->interner, "write");
+
+    SymbolTable built_in_symbol_table = {
+        {read_name,
+         std::make_shared<FunctionSymbol>(
+             -1,
+             read_name,
+             std::vector<VariableSymbolSharedPtr>(),
+             std::make_shared<ArithmeticSymbol>(
+                 -1,
+                 INTERN_ID_EMPTY,
+                 ArithmeticSymbolType::INT))},
+        {write_name,
+         std::make_shared<FunctionSymbol>(
+             -1,
+             write_name,
+             std::vector<VariableSymbolSharedPtr>({std::make_shared<ArithmeticSymbol>(
+                 -1,
+                 InternerInternString(context->interner, "value"),
+                 ArithmeticSymbolType::INT)}),
+             std::make_shared<ArithmeticSymbol>(
+                 -1,
+                 INTERN_ID_EMPTY,
+                 ArithmeticSymbolType::INT))}};
+
+    SemanticAnalyser semantic_analyser(built_in_symbol_table, context->interner);
+    semantic_analyser.SetTimeReport(time_report);
+
+    semantic_analyser.Analyse(context->root, context->flat_ast);
+
+    end_phase();
+
+    if (semantic_analyser.GetHasError())
+    {
+        CompilationContextFree(context);
+        return FAILURE;
+    }
+
+    begin_phase("IR generation");
+
+    std::unique_ptr<IrFileSink> output_writer;
+    if (options.target == CompileTarget::X86_64)
+    {
+        output_writer = std::make_unique<X86_64AsmWriter>(output_path, context->interner);
+    }
+    else if (options.target == CompileTarget::MIPS32)
+    {
+        auto mips32_writer = std::make_unique<Mips32AsmWriter>(output_path, context->interner);
+        mips32_writer->SetSpillReport(spill_report);
+        output_writer = std::move(mips32_writer);
+    }
+    else
+    {
+        output_writer = std::make_unique<IrWriter>(output_path, context->interner);
+    }
+
+    if (!output_writer->IsOpen())
+    {
+        std::cerr << "Failed to open output file " << output_path << std::endl;
+        end_phase();
+        CompilationContextFree(context);
+        return FAILURE;
+    }
+
+    const std::string cfg_path = output_path + ".dot";
+    std::unique_ptr<CfgDotWriter> cfg_dot_writer;
+    IrSink *sink = output_writer.get();
+
+    if (options.dump_cfg)
+    {
+        cfg_dot_writer = std::make_unique<CfgDotWriter>(cfg_path, sink, context->interner);
+        if (!cfg_dot_writer->IsOpen())
+        {
+            std::cerr << "Failed to open output file " << cfg_path << std::endl;
+            end_phase();
+            output_writer->Close();
+            std::remove(output_path.c_str());
+            CompilationContextFree(context);
+            return FAILURE;
+        }
+
+        sink = cfg_dot_writer.get();
+    }
+
+    IrGenerator ir_generator(semantic_analyser.GetSymbolTable(),
+                             semantic_analyser.GetStructDefSymbolTable(),
+                             context->interner);
+    ir_generator.SetTimeReport(time_report);
+    // Each function is optimized, written out and released as soon as it is
+    // generated, so memory use is bounded by the largest function
+    IrOptimizer ir_optimizer(options.optimization_level, sink, context->interner);
+    ir_optimizer.SetOptimizationReport(optimization_report);
+    // Variables and labels added by passes are numbered after those
+    // generated so far
+    ir_optimizer.SetVariableAllocator([&ir_generator]()
+                                      { return ir_generator.AllocateVariableId(); });
+    ir_optimizer.SetLabelAllocator([&ir_generator]()
+                                   { return ir_generator.AllocateLabelId(); });
+    if (options.optimization_level > 0)
+    {
+        sink = &ir_optimizer;
+    }
+
+    // The IR of each ExtDef is optimized and emitted while the generator
+    // runs, which the time report lists as a phase of its own
+    CallbackIrSink timed_sink([time_report, sink](const IrSequence &sequence)
+                              {
+                                  time_report->BeginInterleavedPhase("Optimize and emit");
+                                  sink->Consume(sequence);
+                                  time_report->EndInterleavedPhase();
+                              });
+    ir_generator.SetSink(time_report != nullptr ? &timed_sink : sink);
+
+    ir_generator.Generate(context->root, context->flat_ast);
+
+    end_phase();
+
+    if (ir_generator.GetHasError() || output_writer->GetHasTranslationError())
+    {
+        // Do not leave the output of the functions before the error behind
+        output_writer->Close();
+        std::remove(output_path.c_str());
+        if (cfg_dot_writer)
+        {
+            cfg_dot_writer->Close();
+            std::remove(cfg_path.c_str());
+        }
+        CompilationContextFree(context);
+        return FAILURE;
+    }
+
+    begin_phase("Close output");
+
+    bool is_output_written = output_writer->Close();
+    bool is_cfg_written = !cfg_dot_writer || cfg_dot_writer->Close();
+
+    end_phase();
+
+    if (!is_output_written || !is_cfg_written)
+    {
+        std::cerr << "Failed to write output file "
+                  << (is_output_written ? cfg_path : output_path) << std::endl;
+        CompilationContextFree(context);
+        return FAILURE;
+    }
+
+    begin_phase("Teardown");
+
+    CompilationContextFree(context);
+
+    end_phase();
+
+    return SUCCESS;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+
+#include "../../Lab2/bits/time_report.h"
+#include "optimization_report.h"
+#include "spill_report.h"
+
+enum class CompileTarget
+{
+    // Textual IR for the IR virtual machine
+    IR,
+    // x86-64 assembly, see X86_64AsmWriter
+    X86_64,
+    // MIPS32 assembly for SPIM and MARS, see Mips32AsmWriter
+    MIPS32
+};
+
+struct CompileOptions
+{
+    // 0: IR as generated
+    // 1: constant folding, local common subexpression elimination,
+    //    copy propagation, dead code elimination, loop-invariant code motion,
+    //    strength reduction of induction variable multiplications,
+    //    coalescing of variables with disjoint lifetimes
+    // 2: also sparse conditional constant propagation and removal of dead
+    //    assignments in SSA form, before coalescing
+    int optimization_level = 0;
+    // Also writes the control flow graph of each function, after
+    // optimization, to <output-path>.dot
+    bool dump_cfg = false;
+    CompileTarget target = CompileTarget::IR;
+};
+
+// Returns the extension of output files for target, e.g. ".ir"
+const char *GetOutputExtension(const CompileTarget target);
+
+// Compiles one C-- source file into an IR or assembly file. Every compilation owns
+// its own context, so several files may be compiled concurrently.
+// Diagnostics are written to stderr. Returns SUCCESS or FAILURE.
+// If time_report is not nullptr, every phase that was started is measured.
+// If optimization_report is not nullptr, every optimized function is recorded.
+// If spill_report is not nullptr, the register allocation of every function
+// is recorded, for targets with a register allocator.
+int CompileFile(const std::string &input_path,
+                const std::string &output_path,
+                const CompileOptions &options = CompileOptions(),
+                TimeReport *time_report = nullptr,
+                OptimizationReport *optimization_report = nullptr,
+                SpillReport *spill_report = nullptr);
@@ -1,106 +1,115 @@
 #include "instruction_generator.h"
 
-const std::string InstructionGenerator::kBinaryOperatorAdd = "+";
-const std::string InstructionGenerator::kBinaryOperatorSub = "-";
-const std::string InstructionGenerator::kBinaryOperatorMul = "*";
-const std::string InstructionGenerator::kBinaryOperatorDiv = "/";
-const std::string InstructionGenerator::kBinaryOperatorGt = ">";
-const std::string InstructionGenerator::kBinaryOperatorGe = ">=";
-const std::string InstructionGenerator::kBinaryOperatorLt = "<";
-const std::string InstructionGenerator::kBinaryOperatorLe = "<=";
-const std::string InstructionGenerator::kBinaryOperatorEq = "==";
-const std::string InstructionGenerator::kBinaryOperatorNe = "!=";
+IrInstruction InstructionGenerator::Generate(const IrOpcode opcode,
+                                             const IrOperand &dest,
+                                             const IrOperand &arg1,
+                                             const IrOperand &arg2,
+                                             const IrOperator op) const
+{
+    return {opcode, op, dest, arg1, arg2};
+}
+
+IrInstruction InstructionGenerator::GenerateLabel(const IrOperand &label) const
+{
+    return Generate(IrOpcode::LABEL, label);
+}
 
-std::string InstructionGenerator::GenerateLabel(const std::string &name) const
+IrInstruction InstructionGenerator::GenerateFunction(const InternId name) const
 {
-    return "LABEL " + name + " :";
+    return Generate(IrOpcode::FUNCTION, IrOperand::Function(name));
 }
 
-std::string InstructionGenerator::GenerateFunction(const std::string &name) const
+IrOperand InstructionGenerator::GenerateImm(const int number) const
 {
-    return "FUNCTION " + name + " :";
+    return IrOperand::Immediate(number);
 }
 
-std::string InstructionGenerator::GenerateImm(const std::string &number) const
+IrOperand InstructionGenerator::GenerateImm(const int number, const InternId lexeme) const
 {
-    return "#" + number;
+    return IrOperand::Immediate(number, lexeme);
 }
 
-std::string InstructionGenerator::GenerateImm(const int number) const
+IrOperand InstructionGenerator::GenerateFloatImm(const InternId lexeme) const
 {
-    return GenerateImm(std::to_string(number));
+    return IrOperand::FloatImmediate(lexeme);
 }
 
-std::string InstructionGenerator::GenerateAssign(const std::string &left,
-                                                 const std::string &right) const
+IrInstruction InstructionGenerator::GenerateAssign(const IrOperand &left,
+                                                   const IrValue &right) const
 {
-    return left + " := " + right;
+    return Generate(right.opcode, left, right.arg1, right.arg2, right.op);
 }
 
-std::string InstructionGenerator::GenerateBinaryOperation(const std::string binary_operator,
-                                                          const std::string &left,
-                                                          const std::string &right) const
+IrInstruction InstructionGenerator::GenerateAssign(const IrOperand &left,
+                                                   const IrOperand &right) const
 {
-    return left + ' ' + binary_operator + ' ' + right;
+    return Generate(IrOpcode::ASSIGN, left, right);
 }
 
-std::string InstructionGenerator::GenerateAddress(const std::string &variable) const
+IrValue InstructionGenerator::GenerateBinaryOperation(const IrOperator binary_operator,
+                                                      const IrOperand &left,
+                                                      const IrOperand &right) const
 {
-    return "&" + variable;
+    return {IrOpcode::BINARY, binary_operator, left, right};
 }
 
-std::string InstructionGenerator::GenerateDereference(const std::string &variable) const
+IrOperand InstructionGenerator::GenerateAddress(const IrOperand &variable) const
 {
-    return "*" + variable;
+    return {IrOperandType::ADDRESS, variable.value, INTERN_ID_EMPTY};
 }
 
-std::string InstructionGenerator::GenerateGoto(const std::string &label_name) const
+IrOperand InstructionGenerator::GenerateDereference(const IrOperand &variable) const
 {
-    return "GOTO " + label_name;
+    return {IrOperandType::DEREFERENCE, variable.value, INTERN_ID_EMPTY};
 }
 
-std::string InstructionGenerator::GenerateIf(const std::string &condition,
-                                             const std::string goto_label_name) const
+IrInstruction InstructionGenerator::GenerateGoto(const IrOperand &label) const
 {
-    return "IF " + condition + ' ' + GenerateGoto(goto_label_name);
+    return Generate(IrOpcode::GOTO, label);
 }
 
-std::string InstructionGenerator::GenerateReturn(const std::string &value) const
+IrInstruction InstructionGenerator::GenerateIf(const IrValue &condition,
+                                               const IrOperand &goto_label) const
 {
-    return "RETURN " + value;
+    return Generate(IrOpcode::IF, goto_label, condition.arg1, condition.arg2, condition.op);
 }
 
-std::string InstructionGenerator::GenerateDec(const std::string &variable, const size_t size) const
+IrInstruction InstructionGenerator::GenerateReturn(const IrOperand &value) const
 {
-    return "DEC " + variable + ' ' + std::to_string(size);
+    return Generate(IrOpcode::RETURN, IrOperand::None(), value);
 }
 
-std::string InstructionGenerator::GenerateGlobalDec(const std::string &variable, const size_t size) const
+IrInstruction InstructionGenerator::GenerateDec(const IrOperand &variable, const size_t size) const
 {
-    return "GLOBAL_DEC " + variable + ' ' + std::to_string(size);
+    return Generate(IrOpcode::DEC, variable, GenerateImm(size));
 }
 
-std::string InstructionGenerator::GenerateArg(const std::string &value) const
+IrInstruction InstructionGenerator::GenerateGlobalDec(const IrOperand &variable, const size_t size) const
 {
-    return "ARG " + value;
+    return Generate(IrOpcode::GLOBAL_DEC, variable, GenerateImm(size));
 }
 
-std::string InstructionGenerator::GenerateCall(const std::string &function_name) const
+IrInstruction InstructionGenerator::GenerateArg(const IrOperand &value) const
 {
-    return "CALL " + function_name;
+    return Generate(IrOpcode::ARG, IrOperand::None(), value);
 }
 
-std::string InstructionGenerator::GenerateParam(const std::string &variable) const
+IrValue InstructionGenerator::GenerateCall(const InternId function_name) const
 {
-    return "PARAM " + variable;
+    return {IrOpcode::CALL, IrOperator::NONE, IrOperand::Function(function_name), IrOperand::None()};
 }
 
-std::string InstructionGenerator::GenerateRead(const std::string &variable) const
+IrInstruction InstructionGenerator::GenerateParam(const IrOperand &variable) const
 {
-    return "READ " + variable;
+    return Generate(IrOpcode::PARAM, variable);
 }
 
-std::string InstructionGenerator::GenerateWrite(const std::string &value) const
+IrInstruction InstructionGenerator::GenerateRead(const IrOperand &variable) const
 {
-    return "WRITE " + value;
-}
\ No newline at end of file
+    return Generate(IrOpcode::READ, variable);
+}
+
+IrInstruction InstructionGenerator::GenerateWrite(const IrOperand &value) const
+{
+    return Generate(IrOpcode::WRITE, IrOperand::None(), value);
+}
@@ -1,44 +1,45 @@
 #pragma once
 
-#include <string>
+#include <cstddef>
+
+#include "ir_instruction.h"
 
 class InstructionGenerator
 {
 public:
-    const static std::string kBinaryOperatorAdd;
-    const static std::string kBinaryOperatorSub;
-    const static std::string kBinaryOperatorMul;
-    const static std::string kBinaryOperatorDiv;
-    const static std::string kBinaryOperatorGt;
-    const static std::string kBinaryOperatorGe;
-    const static std::string kBinaryOperatorLt;
-    const static std::string kBinaryOperatorLe;
-    const static std::string kBinaryOperatorEq;
-    const static std::string kBinaryOperatorNe;
+    // "variable" argument should be a VARIABLE operand.
+    // "value" argument should be an operand of any kind except LABEL and FUNCTION.
+    IrInstruction GenerateLabel(const IrOperand &label) const;
+    IrInstruction GenerateFunction(const InternId name) const;
+    IrOperand GenerateImm(const int number) const;
+    // A literal from the source, printed as written
+    IrOperand GenerateImm(const int number, const InternId lexeme) const;
+    IrOperand GenerateFloatImm(const InternId lexeme) const;
+    // left may also be a DEREFERENCE operand.
+    // left may be NONE when right is a CALL whose result is discarded.
+    IrInstruction GenerateAssign(const IrOperand &left, const IrValue &right) const;
+    IrInstruction GenerateAssign(const IrOperand &left, const IrOperand &right) const;
+    IrValue GenerateBinaryOperation(const IrOperator binary_operator,
+                                    const IrOperand &left,
+                                    const IrOperand &right) const;
+    IrOperand GenerateAddress(const IrOperand &variable) const;
+    IrOperand GenerateDereference(const IrOperand &variable) const;
+    IrInstruction GenerateGoto(const IrOperand &label) const;
+    // condition should be a relational binary operation
+    IrInstruction GenerateIf(const IrValue &condition, const IrOperand &goto_label) const;
+    IrInstruction GenerateReturn(const IrOperand &value) const;
+    IrInstruction GenerateDec(const IrOperand &variable, const size_t size) const;
+    IrInstruction GenerateGlobalDec(const IrOperand &variable, const size_t size) const;
+    IrInstruction GenerateArg(const IrOperand &value) const;
+    IrValue GenerateCall(const InternId function_name) const;
+    IrInstruction GenerateParam(const IrOperand &variable) const;
+    IrInstruction GenerateRead(const IrOperand &variable) const;
+    IrInstruction GenerateWrite(const IrOperand &value) const;
 
-    // "number" argument should contain a number literal.
-    // "variable" argument should contain a variable name.
-    // "value" argument should contain either a number literal or variable name.
-    std::string GenerateLabel(const std::string &name) const;
-    std::string GenerateFunction(const std::string &name) const;
-    std::string GenerateImm(const std::string &number) const;
-    std::string GenerateImm(const int number) const;
-    std::string GenerateAssign(const std::string &left,
-                               const std::string &right) const;
-    std::string GenerateBinaryOperation(const std::string binary_operator,
-                                        const std::string &left,
-                                        const std::string &right) const;
-    std::string GenerateAddress(const std::string &variable) const;
-    std::string GenerateDereference(const std::string &variable) const;
-    std::string GenerateGoto(const std::string &label_name) const;
-    std::string GenerateIf(const std::string &condition,
-                           const std::string goto_label_name) const;
-    std::string GenerateReturn(const std::string &value) const;
-    std::string GenerateDec(const std::string &variable, const size_t size) const;
-    std::string GenerateGlobalDec(const std::string &variable, const size_t size) const;
-    std::string GenerateArg(const std::string &value) const;
-    std::string GenerateCall(const std::string &function_name) const;
-    std::string GenerateParam(const std::string &variable) const;
-    std::string GenerateRead(const std::string &variable) const;
-    std::string GenerateWrite(const std::string &value) const;
-};
\ No newline at end of file
+private:
+    IrInstruction Generate(const IrOpcode opcode,
+                           const IrOperand &dest,
+                           const IrOperand &arg1 = IrOperand::None(),
+                           const IrOperand &arg2 = IrOperand::None(),
+                           const IrOperator op = IrOperator::NONE) const;
+};
@@ -1,21 +1,22 @@
 #include "ir_generator.h"
 
-void IrGenerator::Generate(const KTreeNode *root)
+void IrGenerator::Generate(const KTreeNode *root, const FlatAst *flat_ast)
 {
+    flat_ast_ = flat_ast;
+
     if (root != NULL &&
         root->l_child != NULL &&
         !root->l_child->value->is_token &&
         root->l_child->value->ast_node_value.variable->type == VARIABLE_EXT_DEF_LIST)
     {
-        if (!DoExtDefList(root->l_child))
-        {
-            return;
-        }
+        DoExtDefList(root->l_child);
     }
     else
     {
         PrintError("Invalid root node");
     }
+
+    flat_ast_ = nullptr;
 }
 
 void IrGenerator::PrintKTreeNodeInfo(const KTreeNode *node) const
@@ -25,7 +26,7 @@ void IrGenerator::PrintKTreeNodeInfo(const KTreeNode *node) const
         std::cout << "Token, Type="
                   << (node->value->ast_node_value.token->type)
                   << " Value="
-                  << (node->value->ast_node_value.token->value)
+                  << GetInternedString(node->value->ast_node_value.token->value)
                   << " LineNumber="
                   << (node->value->ast_node_value.token->line_start)
                   << " ColumnNumber="
@@ -47,17 +48,30 @@ void IrGenerator::PrintKTreeNodeInfo(const KTreeNode *node) const
 void IrGenerator::PrintError(const std::string &message)
 {
     has_error_ = true;
-    std::cerr << "IR translation error : " << message << std::endl;
+    // One write per line keeps diagnostics of concurrent compilations apart
+    std::cerr << "IR translation error : " + message + '\n';
+}
+
+std::string IrGenerator::GetInternedString(const InternId id) const
+{
+    return InternerGetString(interner_, id);
 }
 
-std::string IrGenerator::GetNextVariableName()
+IrOperand IrGenerator::GetNextVariable()
 {
-    return "var" + std::to_string(next_variable_id_++);
+    return IrOperand::Variable(next_variable_id_++);
 }
 
-std::string IrGenerator::GetNextLabelName()
+IrOperand IrGenerator::GetNextLabel()
 {
-    return "label" + std::to_string(next_label_id_++);
+    return IrOperand::Label(next_label_id_++);
+}
+
+int IrGenerator::GetIntLiteralValue(const InternId literal) const
+{
+    // Base 0 accepts the decimal, octal and hexadecimal forms the lexer does
+    // and stops at an integer suffix
+    return static_cast<int>(std::strtoll(InternerGetString(interner_, literal), nullptr, 0));
 }
 
 size_t IrGenerator::GetVariableSize(const VariableSymbol &variable) const
@@ -112,35 +126,64 @@ size_t IrGenerator::GetVariableSize(const VariableSymbol &variable) const
     }
 }
 
-std::string IrGenerator::GetBinaryOperator(const int type) const
+IrOperator IrGenerator::GetBinaryOperator(const int type) const
 {
     switch (type)
     {
     case TOKEN_OPERATOR_REL_EQ:
-        return InstructionGenerator::kBinaryOperatorEq;
+        return IrOperator::EQ;
     case TOKEN_OPERATOR_REL_GE:
-        return InstructionGenerator::kBinaryOperatorGe;
+        return IrOperator::GE;
     case TOKEN_OPERATOR_REL_GT:
-        return InstructionGenerator::kBinaryOperatorGt;
+        return IrOperator::GT;
     case TOKEN_OPERATOR_REL_LE:
-        return InstructionGenerator::kBinaryOperatorLe;
+        return IrOperator::LE;
     case TOKEN_OPERATOR_REL_LT:
-        return InstructionGenerator::kBinaryOperatorLt;
+        return IrOperator::LT;
     case TOKEN_OPERATOR_REL_NE:
-        return InstructionGenerator::kBinaryOperatorNe;
+        return IrOperator::NE;
     case TOKEN_OPERATOR_ADD:
-        return InstructionGenerator::kBinaryOperatorAdd;
+        return IrOperator::ADD;
     case TOKEN_OPERATOR_SUB:
-        return InstructionGenerator::kBinaryOperatorSub;
+        return IrOperator::SUB;
     case TOKEN_OPERATOR_MUL:
-        return InstructionGenerator::kBinaryOperatorMul;
+        return IrOperator::MUL;
     case TOKEN_OPERATOR_DIV:
-        return InstructionGenerator::kBinaryOperatorDiv;
+        return IrOperator::DIV;
     default:
-        return "";
+        return IrOperator::NONE;
     }
 }
 
+// Returns the relational operator testing the opposite of op
+IrOperator IrGenerator::GetNegatedOperator(const IrOperator op)
+{
+    switch (op)
+    {
+    case IrOperator::EQ:
+        return IrOperator::NE;
+    case IrOperator::NE:
+        return IrOperator::EQ;
+    case IrOperator::LT:
+        return IrOperator::GE;
+    case IrOperator::LE:
+        return IrOperator::GT;
+    case IrOperator::GT:
+        return IrOperator::LE;
+    case IrOperator::GE:
+        return IrOperator::LT;
+    default:
+        return IrOperator::NONE;
+    }
+}
+
+bool IrGenerator::IsIntType(const VariableSymbol &variable)
+{
+    return variable.GetVariableSymbolType() == VariableSymbolType::ARITHMETIC &&
+           static_cast<const ArithmeticSymbol *>(&variable)->GetArithmeticSymbolType() ==
+               ArithmeticSymbolType::INT;
+}
+
 bool IrGenerator::ShouldPassAddress(const VariableSymbol &variable) const
 {
     switch (variable.GetVariableSymbolType())
@@ -177,14 +220,28 @@ auto IrGenerator::GetArrayInfo(const ArraySymbol &array_variable) const
             GetVariableSize(*(current_array->GetElemType()))};
 }
 
-void IrGenerator::ConcatenateIrSequence(IrSequence &seq1, const IrSequence &seq2) const
+IrSequenceGenerationResult IrGenerator::ErrorIrSequenceGenerationResult()
 {
-    seq1.insert(seq1.cend(), seq2.cbegin(), seq2.cend());
+    return {false, IrList()};
 }
 
-void IrGenerator::AppendIrSequence(const IrSequence &ir_sequence)
+// O(1), seq2 is left empty
+void IrGenerator::ConcatenateIrSequence(IrList &seq1, IrList &&seq2) const
 {
-    ConcatenateIrSequence(ir_sequence_, ir_sequence);
+    seq1.Splice(std::move(seq2));
+}
+
+void IrGenerator::AppendIrSequence(IrList &&ir_list)
+{
+    if (sink_ != nullptr)
+    {
+        sink_sequence_.assign(ir_list.begin(), ir_list.end());
+        sink_->Consume(sink_sequence_);
+    }
+    else
+    {
+        ir_sequence_.insert(ir_sequence_.cend(), ir_list.begin(), ir_list.end());
+    }
 }
 
 // Returns whether there's no translation error
@@ -193,7 +250,19 @@ bool IrGenerator::DoExtDefList(const KTreeNode *node)
     // ExtDefList: ExtDef ExtDefList(Nullable) | <NULL>
     while (node != NULL)
     {
-        if (!DoExtDef(node->l_child))
+        if (time_report_ != nullptr)
+        {
+            time_report_->BeginExtDef(node->l_child->value->ast_node_value.variable->line_start);
+        }
+
+        bool success = DoExtDef(node->l_child);
+
+        if (time_report_ != nullptr)
+        {
+            time_report_->EndExtDef();
+        }
+
+        if (!success)
         {
             return false;
         }
@@ -219,7 +288,7 @@ bool IrGenerator::DoExtDef(const KTreeNode *node)
             return false;
         }
 
-        AppendIrSequence(ext_decs.second);
+        AppendIrSequence(std::move(ext_decs.second));
     }
     // ExtDef: Specifier FunDec CompSt
     else if (node->l_child->r_sibling->value->ast_node_value.variable->type == VARIABLE_FUN_DEC)
@@ -236,8 +305,9 @@ bool IrGenerator::DoExtDef(const KTreeNode *node)
             return false;
         }
 
-        AppendIrSequence(fun_dec.second);
-        AppendIrSequence(comp_statement.second);
+        // The sink receives each function whole
+        ConcatenateIrSequence(fun_dec.second, std::move(comp_statement.second));
+        AppendIrSequence(std::move(fun_dec.second));
     }
 
     return true;
@@ -246,12 +316,12 @@ bool IrGenerator::DoExtDef(const KTreeNode *node)
 // [INSERTS-IR-VARIABLE]
 IrSequenceGenerationResult IrGenerator::DoExtDecList(const KTreeNode *node)
 {
-    IrSequence sequence;
+    IrList sequence;
     // ExtDecList: VarDec | VarDec COMMA ExtDecList
     while (node != NULL)
     {
         auto symbol = symbol_table_.at(DoVarDec(node->l_child));
-        auto variable_name = GetNextVariableName();
+        auto variable_name = GetNextVariable();
         ir_variable_table_[symbol->GetName()] = variable_name;
         is_address_symbol_[symbol->GetName()] = false;
 
@@ -261,7 +331,7 @@ IrSequenceGenerationResult IrGenerator::DoExtDecList(const KTreeNode *node)
         case VariableSymbolType::STRUCT:
         case VariableSymbolType::ARITHMETIC:
         {
-            sequence.push_back(instruction_generator_.GenerateGlobalDec(
+            sequence.PushBack(instruction_generator_.GenerateGlobalDec(
                 variable_name,
                 GetVariableSize(*symbol)));
             break;
@@ -273,27 +343,27 @@ IrSequenceGenerationResult IrGenerator::DoExtDecList(const KTreeNode *node)
         node = node->r_child;
     }
 
-    return {true, sequence};
+    return {true, std::move(sequence)};
 }
 
 IrSequenceGenerationResult IrGenerator::DoDefList(const KTreeNode *node)
 {
-    IrSequence sequence;
+    IrList sequence;
     // DefList: Def DefList(Nullable) | <NULL>
     while (node != NULL)
     {
         auto def = DoDef(node->l_child);
         if (!def.first)
         {
-            return kErrorIrSequenceGenerationResult;
+            return ErrorIrSequenceGenerationResult();
         }
 
-        ConcatenateIrSequence(sequence, def.second);
+        ConcatenateIrSequence(sequence, std::move(def.second));
 
         node = node->r_child;
     }
 
-    return {true, sequence};
+    return {true, std::move(sequence)};
 }
 
 IrSequenceGenerationResult IrGenerator::DoDef(const KTreeNode *node)
@@ -304,22 +374,22 @@ IrSequenceGenerationResult IrGenerator::DoDef(const KTreeNode *node)
 
 IrSequenceGenerationResult IrGenerator::DoDecList(const KTreeNode *node)
 {
-    IrSequence sequence;
+    IrList sequence;
     // DecList: Dec | Dec COMMA DecList
     while (node != NULL)
     {
         auto dec = DoDec(node->l_child);
         if (!dec.first)
         {
-            return kErrorIrSequenceGenerationResult;
+            return ErrorIrSequenceGenerationResult();
         }
 
-        ConcatenateIrSequence(sequence, dec.second);
+        ConcatenateIrSequence(sequence, std::move(dec.second));
 
         node = node->r_child;
     }
 
-    return {true, sequence};
+    return {true, std::move(sequence)};
 }
 
 // [INSERTS-IR-VARIABLE]
@@ -328,10 +398,10 @@ IrSequenceGenerationResult IrGenerator::DoDec(const KTreeNode *node)
     // Dec: VarDec | VarDec ASSIGN Exp
     auto var_dec = DoVarDec(node->l_child);
 
-    IrSequence sequence;
+    IrList sequence;
 
     auto symbol = symbol_table_.at(var_dec);
-    auto variable_name = GetNextVariableName();
+    auto variable_name = GetNextVariable();
     ir_variable_table_[symbol->GetName()] = variable_name;
     is_address_symbol_[symbol->GetName()] = false;
 
@@ -340,7 +410,7 @@ IrSequenceGenerationResult IrGenerator::DoDec(const KTreeNode *node)
     case VariableSymbolType::ARRAY:
     case VariableSymbolType::STRUCT:
     {
-        sequence.push_back(instruction_generator_.GenerateDec(
+        sequence.PushBack(instruction_generator_.GenerateDec(
             variable_name,
             GetVariableSize(*symbol)));
         break;
@@ -351,45 +421,51 @@ IrSequenceGenerationResult IrGenerator::DoDec(const KTreeNode *node)
 
     if (node->l_child->r_sibling == NULL)
     {
-        return {true, sequence};
+        return {true, std::move(sequence)};
     }
 
     auto expression = DoExp(node->l_child->r_sibling->r_sibling, false, false);
     if (!expression)
     {
-        return {false, IrSequence()};
+        return {false, IrList()};
     }
 
-    ConcatenateIrSequence(sequence, expression->GetPreparationSequence());
+    ConcatenateIrSequence(sequence, expression->TakePreparationSequence());
 
-    sequence.push_back(instruction_generator_.GenerateAssign(
+    sequence.PushBack(instruction_generator_.GenerateAssign(
         variable_name,
         expression->GetFinalValue()));
 
-    return {true, sequence};
+    return {true, std::move(sequence)};
 }
 
 // Returns the variable symbol name
-std::string IrGenerator::DoVarDec(const KTreeNode *node)
+InternId IrGenerator::DoVarDec(const KTreeNode *node)
 {
+    return DoVarDec(node->value->flat_index);
+}
+
+InternId IrGenerator::DoVarDec(const int flat_index)
+{
+    const FlatAstNode &first_child = flat_ast_->nodes[flat_ast_->nodes[flat_index].first_child];
+
     // VarDec: ID
-    if (node->l_child->value->is_token &&
-        node->l_child->value->ast_node_value.token->type == TOKEN_ID)
+    if (first_child.is_token && first_child.type == TOKEN_ID)
     {
-        return node->l_child->value->ast_node_value.token->value;
+        return flat_ast_->tokens[first_child.token_index].value;
     }
 
     // VarDec: VarDec L_SQUARE LITERAL_INT R_SQUARE
-    return DoVarDec(node->l_child);
+    return DoVarDec(flat_ast_->nodes[flat_index].first_child);
 }
 
 // [INSERTS-IR-VARIABLE] (function parameters)
 IrSequenceGenerationResult IrGenerator::DoFunDec(const KTreeNode *node)
 {
-    IrSequence sequence;
-    std::string function_name = node->l_child->value->ast_node_value.token->value;
+    IrList sequence;
+    InternId function_name = node->l_child->value->ast_node_value.token->value;
 
-    sequence.push_back(instruction_generator_.GenerateFunction(function_name));
+    sequence.PushBack(instruction_generator_.GenerateFunction(function_name));
 
     // FunDec: ID L_BRACKET R_BRACKET
 
@@ -404,21 +480,21 @@ IrSequenceGenerationResult IrGenerator::DoFunDec(const KTreeNode *node)
 
         for (int i = 0; i < function_args.size(); i++)
         {
-            auto param_variable_name = GetNextVariableName();
+            auto param_variable_name = GetNextVariable();
             ir_variable_table_[function_args[i]->GetName()] = param_variable_name;
             is_address_symbol_[function_args[i]->GetName()] =
                 ShouldPassAddress(*function_args[i]);
-            sequence.push_back(instruction_generator_.GenerateParam(
+            sequence.PushBack(instruction_generator_.GenerateParam(
                 param_variable_name));
         }
     }
 
-    return {true, sequence};
+    return {true, std::move(sequence)};
 }
 
-std::vector<std::string> IrGenerator::DoVarList(const KTreeNode *node)
+std::vector<InternId> IrGenerator::DoVarList(const KTreeNode *node)
 {
-    std::vector<std::string> vars;
+    std::vector<InternId> vars;
     // VarList: ParamDec COMMA VarList | ParamDec
     while (node != NULL)
     {
@@ -429,7 +505,7 @@ std::vector<std::string> IrGenerator::DoVarList(const KTreeNode *node)
     return vars;
 }
 
-std::string IrGenerator::DoParamDec(const KTreeNode *node)
+InternId IrGenerator::DoParamDec(const KTreeNode *node)
 {
     // ParamDec: Specifier VarDec
     return DoVarDec(node->r_child);
@@ -439,7 +515,7 @@ IrSequenceGenerationResult IrGenerator::DoCompSt(const KTreeNode *node)
 {
     // CompSt: L_BRACE DefList(Nullable) StmtList(Nullable) R_BRACE
 
-    IrSequence sequence;
+    IrList sequence;
 
     // At least one of DefList and StmtList is not NULL
     if (!node->l_child->r_sibling->value->is_token)
@@ -450,10 +526,10 @@ IrSequenceGenerationResult IrGenerator::DoCompSt(const KTreeNode *node)
             auto def_list = DoDefList(node->l_child->r_sibling);
             if (!def_list.first)
             {
-                return kErrorIrSequenceGenerationResult;
+                return ErrorIrSequenceGenerationResult();
             }
 
-            ConcatenateIrSequence(sequence, def_list.second);
+            ConcatenateIrSequence(sequence, std::move(def_list.second));
 
             // StmtList is not NULL either
             if (!node->l_child->r_sibling->r_sibling->value->is_token)
@@ -461,10 +537,10 @@ IrSequenceGenerationResult IrGenerator::DoCompSt(const KTreeNode *node)
                 auto statement_list = DoStmtList(node->l_child->r_sibling->r_sibling);
                 if (!statement_list.first)
                 {
-                    return kErrorIrSequenceGenerationResult;
+                    return ErrorIrSequenceGenerationResult();
                 }
 
-                ConcatenateIrSequence(sequence, statement_list.second);
+                ConcatenateIrSequence(sequence, std::move(statement_list.second));
             }
             // StmtList is NULL
         }
@@ -474,22 +550,22 @@ IrSequenceGenerationResult IrGenerator::DoCompSt(const KTreeNode *node)
             auto statement_list = DoStmtList(node->l_child->r_sibling);
             if (!statement_list.first)
             {
-                return kErrorIrSequenceGenerationResult;
+                return ErrorIrSequenceGenerationResult();
             }
 
-            ConcatenateIrSequence(sequence, statement_list.second);
+            ConcatenateIrSequence(sequence, std::move(statement_list.second));
         }
     }
 
     // Both DefList and StmtList are NULL
 
     // Common return
-    return {true, sequence};
+    return {true, std::move(sequence)};
 }
 
 IrSequenceGenerationResult IrGenerator::DoStmtList(const KTreeNode *node)
 {
-    IrSequence sequence;
+    IrList sequence;
     // StmtList: Stmt StmtList(Nullable) | <NULL>
     while (node != NULL)
     {
@@ -498,14 +574,14 @@ IrSequenceGenerationResult IrGenerator::DoStmtList(const KTreeNode *node)
         {
             return {
                 false,
-                IrSequence()};
+                IrList()};
         }
 
-        ConcatenateIrSequence(sequence, statement.second);
+        ConcatenateIrSequence(sequence, std::move(statement.second));
         node = node->r_child;
     }
 
-    return {true, sequence};
+    return {true, std::move(sequence)};
 }
 
 IrSequenceGenerationResult IrGenerator::DoStmt(const KTreeNode *node)
@@ -518,20 +594,21 @@ IrSequenceGenerationResult IrGenerator::DoStmt(const KTreeNode *node)
             auto expression = DoExp(node->l_child, false, false);
             if (!expression)
             {
-                return kErrorIrSequenceGenerationResult;
+                return ErrorIrSequenceGenerationResult();
             }
 
             // We still need the final value in case of Exp is a CALL
-            auto sequence = expression->GetPreparationSequence();
-            // Very bad patch
-            if (expression->GetFinalValue().find("CALL ") == 0)
+            auto sequence = expression->TakePreparationSequence();
+            if (expression->GetFinalValue().opcode == IrOpcode::CALL)
             {
-                sequence.push_back(expression->GetFinalValue());
+                sequence.PushBack(instruction_generator_.GenerateAssign(
+                    IrOperand::None(),
+                    expression->GetFinalValue()));
             }
 
             return {
                 true,
-                sequence};
+                std::move(sequence)};
         }
 
         // Stmt: CompSt
@@ -546,124 +623,99 @@ IrSequenceGenerationResult IrGenerator::DoStmt(const KTreeNode *node)
         auto expression = DoExp(node->l_child->r_sibling, true, false);
         if (!expression)
         {
-            return kErrorIrSequenceGenerationResult;
+            return ErrorIrSequenceGenerationResult();
         }
 
-        auto sequence = expression->GetPreparationSequence();
-        sequence.push_back(instruction_generator_.GenerateReturn(
-            expression->GetFinalValue()));
+        auto sequence = expression->TakePreparationSequence();
+        sequence.PushBack(instruction_generator_.GenerateReturn(
+            expression->GetFinalOperand()));
 
-        return {true, sequence};
+        return {true, std::move(sequence)};
     }
     case TOKEN_KEYWORD_IF:
     {
         auto condition_exp_node = node->l_child->r_sibling->r_sibling;
         auto if_stmt_node = condition_exp_node->r_sibling->r_sibling;
 
-        auto condition = DoExp(condition_exp_node, true, false);
-        if (!condition)
+        // The condition falls through into the if branch and jumps to
+        // false_label, which is the exit when there is no else branch
+        auto false_label = GetNextLabel();
+
+        auto condition = DoCondition(condition_exp_node, IrOperand::None(), false_label);
+        if (!condition.first)
         {
-            return kErrorIrSequenceGenerationResult;
+            return ErrorIrSequenceGenerationResult();
         }
 
         // Stmt: IF L_BRACKET Exp R_BRACKET Stmt
         auto statement = DoStmt(if_stmt_node);
         if (!statement.first)
         {
-            return kErrorIrSequenceGenerationResult;
+            return ErrorIrSequenceGenerationResult();
         }
 
-        IrSequence sequence_single_branch = condition->GetPreparationSequence();
-        IrSequence sequence_dual_branch = condition->GetPreparationSequence();
-
-        auto true_label = GetNextLabelName();
-        auto exit_label = GetNextLabelName();
+        auto sequence = std::move(condition.second);
 
-        sequence_single_branch.push_back(instruction_generator_.GenerateIf(
-            instruction_generator_.GenerateBinaryOperation(
-                InstructionGenerator::kBinaryOperatorNe,
-                condition->GetFinalValue(),
-                instruction_generator_.GenerateImm(0)),
-            true_label));
-
-        sequence_dual_branch.push_back(instruction_generator_.GenerateIf(
-            instruction_generator_.GenerateBinaryOperation(
-                InstructionGenerator::kBinaryOperatorNe,
-                condition->GetFinalValue(),
-                instruction_generator_.GenerateImm(0)),
-            true_label));
-
-        sequence_single_branch.push_back(instruction_generator_.GenerateGoto(exit_label));
-
-        sequence_single_branch.push_back(instruction_generator_.GenerateLabel(true_label));
-
-        ConcatenateIrSequence(sequence_single_branch, statement.second);
-
-        sequence_single_branch.push_back(instruction_generator_.GenerateLabel(exit_label));
+        ConcatenateIrSequence(sequence, std::move(statement.second));
 
         if (if_stmt_node->r_sibling == NULL)
         {
-            return {true, sequence_single_branch};
+            sequence.PushBack(instruction_generator_.GenerateLabel(false_label));
+
+            return {true, std::move(sequence)};
         }
 
         // Stmt: IF L_BRACKET Exp R_BRACKET Stmt ELSE Stmt
         auto else_statemtnt = DoStmt(if_stmt_node->r_sibling->r_sibling);
         if (!else_statemtnt.first)
         {
-            return kErrorIrSequenceGenerationResult;
+            return ErrorIrSequenceGenerationResult();
         }
 
-        ConcatenateIrSequence(sequence_dual_branch, else_statemtnt.second);
+        auto exit_label = GetNextLabel();
 
-        sequence_dual_branch.push_back(instruction_generator_.GenerateGoto(exit_label));
+        sequence.PushBack(instruction_generator_.GenerateGoto(exit_label));
 
-        sequence_dual_branch.push_back(instruction_generator_.GenerateLabel(true_label));
+        sequence.PushBack(instruction_generator_.GenerateLabel(false_label));
 
-        ConcatenateIrSequence(sequence_dual_branch, statement.second);
+        ConcatenateIrSequence(sequence, std::move(else_statemtnt.second));
 
-        sequence_dual_branch.push_back(instruction_generator_.GenerateLabel(exit_label));
+        sequence.PushBack(instruction_generator_.GenerateLabel(exit_label));
 
-        return {true, sequence_dual_branch};
+        return {true, std::move(sequence)};
     }
     // Stmt: WHILE L_BRACKET Exp R_BRACKET Stmt
     case TOKEN_KEYWORD_WHILE:
     {
-        auto condition = DoExp(node->l_child->r_sibling->r_sibling, true, false);
-        if (!condition)
+        auto test_label = GetNextLabel();
+        auto exit_label = GetNextLabel();
+
+        // The condition falls through into the body
+        auto condition = DoCondition(
+            node->l_child->r_sibling->r_sibling, IrOperand::None(), exit_label);
+        if (!condition.first)
         {
-            return kErrorIrSequenceGenerationResult;
+            return ErrorIrSequenceGenerationResult();
         }
 
         auto statement = DoStmt(node->r_child);
         if (!statement.first)
         {
-            return kErrorIrSequenceGenerationResult;
+            return ErrorIrSequenceGenerationResult();
         }
 
-        auto test_label = GetNextLabelName();
-        auto body_label = GetNextLabelName();
-        auto exit_label = GetNextLabelName();
-
-        IrSequence sequence = {instruction_generator_.GenerateLabel(test_label)};
-        ConcatenateIrSequence(sequence, condition->GetPreparationSequence());
-        sequence.push_back(instruction_generator_.GenerateIf(
-            instruction_generator_.GenerateBinaryOperation(
-                InstructionGenerator::kBinaryOperatorNe,
-                condition->GetFinalValue(),
-                instruction_generator_.GenerateImm(0)),
-            body_label));
-        sequence.push_back(instruction_generator_.GenerateGoto(exit_label));
-        sequence.push_back(instruction_generator_.GenerateLabel(body_label));
+        IrList sequence = {instruction_generator_.GenerateLabel(test_label)};
+        ConcatenateIrSequence(sequence, std::move(condition.second));
 
-        ConcatenateIrSequence(sequence, statement.second);
+        ConcatenateIrSequence(sequence, std::move(statement.second));
 
-        sequence.push_back(instruction_generator_.GenerateGoto(test_label));
-        sequence.push_back(instruction_generator_.GenerateLabel(exit_label));
+        sequence.PushBack(instruction_generator_.GenerateGoto(test_label));
+        sequence.PushBack(instruction_generator_.GenerateLabel(exit_label));
 
-        return {true, sequence};
+        return {true, std::move(sequence)};
     }
     default:
-        return kErrorIrSequenceGenerationResult;
+        return ErrorIrSequenceGenerationResult();
     }
 }
 
@@ -683,17 +735,12 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                                      const bool force_singular,
                                      const bool singular_no_prefix)
 {
-    const auto kLogicOperationResultType = std::make_shared<ArithmeticSymbol>(
-        -1,
-        "",
-        ArithmeticSymbolType::INT);
-
     if (node->l_child->value->is_token)
     {
         // Exp: ID | LITERAL_INT | LITERAL_FP /////////////////////////////
         if (node->r_child == NULL)
         {
-            std::string token_value = node->l_child->value->ast_node_value.token->value;
+            InternId token_value = node->l_child->value->ast_node_value.token->value;
 
             switch (node->l_child->value->ast_node_value.token->type)
             {
@@ -719,9 +766,9 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
 
                     if (force_singular && singular_no_prefix)
                     {
-                        auto address_name = GetNextVariableName();
-                        return std::make_shared<ArrayElementExpValue>(
-                            IrSequence({instruction_generator_.GenerateAssign(
+                        auto address_name = GetNextVariable();
+                        return MakeExpValue<ArrayElementExpValue>(
+                            IrList({instruction_generator_.GenerateAssign(
                                 address_name, address_final_value)}),
                             address_name,
                             symbol,
@@ -732,8 +779,8 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                     }
                     else
                     {
-                        return std::make_shared<ArrayElementExpValue>(
-                            IrSequence(),
+                        return MakeExpValue<ArrayElementExpValue>(
+                            IrList(),
                             address_final_value,
                             symbol,
                             0,
@@ -748,25 +795,25 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                 {
                     if (force_singular && singular_no_prefix)
                     {
-                        auto address_name = GetNextVariableName();
-                        return std::make_shared<ExpValue>(
-                            IrSequence({instruction_generator_.GenerateAssign(
+                        auto address_name = GetNextVariable();
+                        return MakeExpValue(
+                            IrList({instruction_generator_.GenerateAssign(
                                 address_name, address_final_value)}),
                             address_name,
                             symbol);
                     }
                     else
                     {
-                        return std::make_shared<ExpValue>(
-                            IrSequence(),
+                        return MakeExpValue(
+                            IrList(),
                             address_final_value,
                             symbol);
                     }
                 }
                 default:
                 {
-                    return std::make_shared<ExpValue>(
-                        IrSequence(),
+                    return MakeExpValue(
+                        IrList(),
                         ir_variable_name,
                         symbol);
                 }
@@ -774,23 +821,17 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             }
             case TOKEN_LITERAL_INT:
             {
-                return std::make_shared<ExpValue>(
-                    IrSequence(),
-                    instruction_generator_.GenerateImm(token_value),
-                    std::make_shared<ArithmeticSymbol>(
-                        -1,
-                        "",
-                        ArithmeticSymbolType::INT));
+                return MakeExpValue(
+                    IrList(),
+                    instruction_generator_.GenerateImm(GetIntLiteralValue(token_value), token_value),
+                    int_type_);
             }
             case TOKEN_LITERAL_FP:
             {
-                return std::make_shared<ExpValue>(
-                    IrSequence(),
-                    instruction_generator_.GenerateImm(token_value),
-                    std::make_shared<ArithmeticSymbol>(
-                        -1,
-                        "",
-                        ArithmeticSymbolType::FLOAT));
+                return MakeExpValue(
+                    IrList(),
+                    instruction_generator_.GenerateFloatImm(token_value),
+                    float_type_);
             }
             default:
                 return nullptr;
@@ -805,7 +846,7 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             node->l_child->r_sibling->value->ast_node_value.token->type ==
                 TOKEN_DELIMITER_L_BRACKET)
         {
-            std::string function_name = node->l_child->value->ast_node_value.token->value;
+            InternId function_name = node->l_child->value->ast_node_value.token->value;
             auto return_type = static_cast<FunctionSymbol *>(symbol_table_.at(function_name).get())->GetReturnType();
 
             if (return_type->GetVariableSymbolType() != VariableSymbolType::ARITHMETIC)
@@ -814,7 +855,7 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                 return nullptr;
             }
 
-            IrSequence preparation_sequence;
+            IrList preparation_sequence;
 
             // Call with args
             auto args_node = node->l_child->r_sibling->r_sibling;
@@ -830,19 +871,16 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                         return nullptr;
                     }
 
-                    auto arg_preparation_sequence = arg->GetPreparationSequence();
-                    preparation_sequence.insert(preparation_sequence.cend(),
-                                                arg_preparation_sequence.cbegin(),
-                                                arg_preparation_sequence.cend());
+                    ConcatenateIrSequence(preparation_sequence, arg->TakePreparationSequence());
                 }
 
                 // Special treat: write
-                if (function_name == "write")
+                if (function_name == write_function_name_)
                 {
-                    preparation_sequence.push_back(
-                        instruction_generator_.GenerateWrite(args[0]->GetFinalValue()));
-                    return std::make_shared<ExpValue>(
-                        preparation_sequence,
+                    preparation_sequence.PushBack(
+                        instruction_generator_.GenerateWrite(args[0]->GetFinalOperand()));
+                    return MakeExpValue(
+                        std::move(preparation_sequence),
                         instruction_generator_.GenerateImm(0),
                         return_type);
                 }
@@ -850,19 +888,19 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                 // Retrieve arg singular exp in reverse order
                 for (auto i = args.rbegin(); i != args.rend(); ++i)
                 {
-                    preparation_sequence.push_back(
-                        instruction_generator_.GenerateArg((*i)->GetFinalValue()));
+                    preparation_sequence.PushBack(
+                        instruction_generator_.GenerateArg((*i)->GetFinalOperand()));
                 }
             }
 
             // Special treat: read
-            if (function_name == "read")
+            if (function_name == read_function_name_)
             {
-                auto read_variable_name = GetNextVariableName();
-                preparation_sequence.push_back(
+                auto read_variable_name = GetNextVariable();
+                preparation_sequence.PushBack(
                     instruction_generator_.GenerateRead(read_variable_name));
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     read_variable_name,
                     return_type);
             }
@@ -870,21 +908,21 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             // Shared logic with call with no args
             if (force_singular)
             {
-                auto return_value_variable_name = GetNextVariableName();
-                preparation_sequence.push_back(
+                auto return_value_variable_name = GetNextVariable();
+                preparation_sequence.PushBack(
                     instruction_generator_.GenerateAssign(
                         return_value_variable_name,
                         instruction_generator_.GenerateCall(function_name)));
 
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     return_value_variable_name,
                     return_type);
             }
             else
             {
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     instruction_generator_.GenerateCall(function_name),
                     return_type);
             }
@@ -895,32 +933,32 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
         if (node->l_child->value->ast_node_value.token->type == TOKEN_OPERATOR_SUB)
         {
             auto expression = DoExp(node->r_child, true, false);
-            IrSequence preparation_sequence = expression->GetPreparationSequence();
+            auto preparation_sequence = expression->TakePreparationSequence();
 
             if (force_singular)
             {
-                auto variable_name = GetNextVariableName();
-                preparation_sequence.push_back(
+                auto variable_name = GetNextVariable();
+                preparation_sequence.PushBack(
                     instruction_generator_.GenerateAssign(
                         variable_name,
                         instruction_generator_.GenerateBinaryOperation(
-                            InstructionGenerator::kBinaryOperatorSub,
+                            IrOperator::SUB,
                             instruction_generator_.GenerateImm(0),
-                            expression->GetFinalValue())));
+                            expression->GetFinalOperand())));
 
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     variable_name,
                     expression->GetSourceType());
             }
             else
             {
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     instruction_generator_.GenerateBinaryOperation(
-                        InstructionGenerator::kBinaryOperatorSub,
+                        IrOperator::SUB,
                         instruction_generator_.GenerateImm(0),
-                        expression->GetFinalValue()),
+                        expression->GetFinalOperand()),
                     expression->GetSourceType());
             }
         }
@@ -929,38 +967,7 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
         // Exp: NOT Exp ///////////////////////////////////////////////////
         if (node->l_child->value->ast_node_value.token->type == TOKEN_OPERATOR_LOGICAL_NOT)
         {
-            auto expression = DoExp(node->r_child, true, true);
-            auto preparation_sequence = expression->GetPreparationSequence();
-
-            auto result_variable_name = GetNextVariableName();
-            auto true_label = GetNextLabelName();
-            auto exit_label = GetNextLabelName();
-
-            preparation_sequence.push_back(instruction_generator_.GenerateIf(
-                instruction_generator_.GenerateBinaryOperation(
-                    InstructionGenerator::kBinaryOperatorNe,
-                    expression->GetFinalValue(),
-                    instruction_generator_.GenerateImm(0)),
-                true_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                result_variable_name,
-                instruction_generator_.GenerateImm(1)));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateGoto(exit_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateLabel(true_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                result_variable_name,
-                instruction_generator_.GenerateImm(0)));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateLabel(exit_label));
-
-            return std::make_shared<ExpValue>(
-                preparation_sequence,
-                result_variable_name,
-                kLogicOperationResultType);
+            return DoConditionValue(node);
         }
         ///////////////////////////////////////////////////////////////////
 
@@ -998,8 +1005,8 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             }
 
             // accumulate current offset
-            auto preparation_sequence = array_expression->GetPreparationSequence();
-            ConcatenateIrSequence(preparation_sequence, index_exp->GetPreparationSequence());
+            auto preparation_sequence = array_expression->TakePreparationSequence();
+            ConcatenateIrSequence(preparation_sequence, index_exp->TakePreparationSequence());
 
             auto offset_size = array_expression->GetArrayElementSize();
             auto array_dim_sizes = array_expression->GetArrayDimSizes();
@@ -1010,21 +1017,21 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                 offset_size *= array_dim_sizes[i];
             }
 
-            auto mul_result_name = GetNextVariableName();
-            auto next_address_base_name = GetNextVariableName();
+            auto mul_result_name = GetNextVariable();
+            auto next_address_base_name = GetNextVariable();
 
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
+            preparation_sequence.PushBack(instruction_generator_.GenerateAssign(
                 mul_result_name,
                 instruction_generator_.GenerateBinaryOperation(
-                    InstructionGenerator::kBinaryOperatorMul,
+                    IrOperator::MUL,
                     instruction_generator_.GenerateImm(offset_size),
-                    index_exp->GetFinalValue())));
+                    index_exp->GetFinalOperand())));
 
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
+            preparation_sequence.PushBack(instruction_generator_.GenerateAssign(
                 next_address_base_name,
                 instruction_generator_.GenerateBinaryOperation(
-                    InstructionGenerator::kBinaryOperatorAdd,
-                    array_expression->GetFinalValue(),
+                    IrOperator::ADD,
+                    array_expression->GetFinalOperand(),
                     mul_result_name)));
 
             // currently at last dim
@@ -1034,8 +1041,8 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                 if (array_expression->GetArrayElementType()->GetVariableSymbolType() ==
                     VariableSymbolType::STRUCT)
                 {
-                    return std::make_shared<ExpValue>(
-                        preparation_sequence,
+                    return MakeExpValue(
+                        std::move(preparation_sequence),
                         next_address_base_name,
                         array_expression->GetArrayElementType());
                 }
@@ -1043,20 +1050,20 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                 {
                     if (force_singular && singular_no_prefix)
                     {
-                        auto variable_name = GetNextVariableName();
-                        preparation_sequence.push_back(instruction_generator_.GenerateAssign(
+                        auto variable_name = GetNextVariable();
+                        preparation_sequence.PushBack(instruction_generator_.GenerateAssign(
                             variable_name,
                             instruction_generator_.GenerateDereference(next_address_base_name)));
 
-                        return std::make_shared<ExpValue>(
-                            preparation_sequence,
+                        return MakeExpValue(
+                            std::move(preparation_sequence),
                             variable_name,
                             array_expression->GetArrayElementType());
                     }
                     else
                     {
-                        return std::make_shared<ExpValue>(
-                            preparation_sequence,
+                        return MakeExpValue(
+                            std::move(preparation_sequence),
                             instruction_generator_.GenerateDereference(next_address_base_name),
                             array_expression->GetArrayElementType());
                     }
@@ -1065,8 +1072,8 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             // currently not at last dim
             else
             {
-                return std::make_shared<ArrayElementExpValue>(
-                    preparation_sequence,
+                return MakeExpValue<ArrayElementExpValue>(
+                    std::move(preparation_sequence),
                     next_address_base_name,
                     array_expression->GetSourceType(),
                     array_expression->GetCurrentDim() + 1,
@@ -1085,7 +1092,7 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                 return nullptr;
             }
 
-            std::string field_name = node->r_child->value->ast_node_value.token->value;
+            InternId field_name = node->r_child->value->ast_node_value.token->value;
 
             auto struct_def = struct_def_symbol_table_.at(
                 static_cast<StructSymbol *>(expression->GetSourceType().get())->GetStructName());
@@ -1098,7 +1105,7 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             {
                 if (fields[i]->GetName() == field_name)
                 {
-                    auto preparation_sequence = expression->GetPreparationSequence();
+                    auto preparation_sequence = expression->TakePreparationSequence();
 
                     // A previously-used strategy is to save an addition when field_offset=0.
                     // However, this requires calling DoExp() with singular_no_prefix=true,
@@ -1106,13 +1113,13 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                     // field not at offset 0. This overweights the saved addition which
                     // applied to first field only.
                     // The same thing is for array.
-                    auto address_name = GetNextVariableName();
-                    preparation_sequence.push_back(
+                    auto address_name = GetNextVariable();
+                    preparation_sequence.PushBack(
                         instruction_generator_.GenerateAssign(
                             address_name,
                             instruction_generator_.GenerateBinaryOperation(
-                                InstructionGenerator::kBinaryOperatorAdd,
-                                expression->GetFinalValue(),
+                                IrOperator::ADD,
+                                expression->GetFinalOperand(),
                                 instruction_generator_.GenerateImm(field_offset))));
 
                     switch (fields[i]->GetVariableSymbolType())
@@ -1122,8 +1129,8 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                         auto array_info = GetArrayInfo(
                             *static_cast<ArraySymbol *>(fields[i].get()));
 
-                        return std::make_shared<ArrayElementExpValue>(
-                            preparation_sequence,
+                        return MakeExpValue<ArrayElementExpValue>(
+                            std::move(preparation_sequence),
                             address_name,
                             fields[i],
                             0,
@@ -1133,8 +1140,8 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                     }
                     case VariableSymbolType::STRUCT:
                     {
-                        return std::make_shared<ExpValue>(
-                            preparation_sequence,
+                        return MakeExpValue(
+                            std::move(preparation_sequence),
                             address_name,
                             fields[i]);
                     }
@@ -1142,20 +1149,20 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
                     {
                         if (force_singular && singular_no_prefix)
                         {
-                            auto variable_name = GetNextVariableName();
-                            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
+                            auto variable_name = GetNextVariable();
+                            preparation_sequence.PushBack(instruction_generator_.GenerateAssign(
                                 variable_name,
                                 instruction_generator_.GenerateDereference(address_name)));
 
-                            return std::make_shared<ExpValue>(
-                                preparation_sequence,
+                            return MakeExpValue(
+                                std::move(preparation_sequence),
                                 variable_name,
                                 fields[i]);
                         }
                         else
                         {
-                            return std::make_shared<ExpValue>(
-                                preparation_sequence,
+                            return MakeExpValue(
+                                std::move(preparation_sequence),
                                 instruction_generator_.GenerateDereference(address_name),
                                 fields[i]);
                         }
@@ -1174,6 +1181,14 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
 
         // From now on, the exp can only be a binary operation
 
+        // Logical operators evaluate their right operand only when needed,
+        // so their operands are translated as conditions
+        if (second_child->value->ast_node_value.token->type == TOKEN_OPERATOR_LOGICAL_AND ||
+            second_child->value->ast_node_value.token->type == TOKEN_OPERATOR_LOGICAL_OR)
+        {
+            return DoConditionValue(node);
+        }
+
         auto l_exp = DoExp(node->l_child, true, false);
 
         if (!l_exp)
@@ -1193,9 +1208,9 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             return nullptr;
         }
 
-        IrSequence preparation_sequence;
-        ConcatenateIrSequence(preparation_sequence, l_exp->GetPreparationSequence());
-        ConcatenateIrSequence(preparation_sequence, r_exp->GetPreparationSequence());
+        IrList preparation_sequence;
+        ConcatenateIrSequence(preparation_sequence, l_exp->TakePreparationSequence());
+        ConcatenateIrSequence(preparation_sequence, r_exp->TakePreparationSequence());
 
         auto operator_type = second_child->value->ast_node_value.token->type;
         bool is_relop = false;
@@ -1204,119 +1219,33 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
         {
         case TOKEN_OPERATOR_ASSIGN:
         {
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                l_exp->GetFinalValue(),
-                r_exp->GetFinalValue()));
+            preparation_sequence.PushBack(instruction_generator_.GenerateAssign(
+                l_exp->GetFinalOperand(),
+                r_exp->GetFinalOperand()));
 
             // Note that r_exp.FinalValue() may be prefixed
             if (force_singular && singular_no_prefix)
             {
-                auto variable_name = GetNextVariableName();
+                auto variable_name = GetNextVariable();
 
-                preparation_sequence.push_back(instruction_generator_.GenerateAssign(
+                preparation_sequence.PushBack(instruction_generator_.GenerateAssign(
                     variable_name,
                     r_exp->GetFinalValue()));
 
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     variable_name,
                     r_exp->GetSourceType());
             }
             else
             {
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     r_exp->GetFinalValue(),
                     r_exp->GetSourceType());
             }
         }
 
-        case TOKEN_OPERATOR_LOGICAL_AND:
-        {
-            auto result_variable_name = GetNextVariableName();
-            auto true_label = GetNextLabelName();
-            auto next_test_label = GetNextLabelName();
-            auto false_label = GetNextLabelName();
-            auto exit_label = GetNextLabelName();
-
-            preparation_sequence.push_back(instruction_generator_.GenerateIf(
-                instruction_generator_.GenerateBinaryOperation(
-                    InstructionGenerator::kBinaryOperatorNe,
-                    l_exp->GetFinalValue(),
-                    instruction_generator_.GenerateImm(0)),
-                next_test_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateLabel(false_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                result_variable_name,
-                instruction_generator_.GenerateImm(0)));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateGoto(exit_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateLabel(next_test_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateIf(
-                instruction_generator_.GenerateBinaryOperation(
-                    InstructionGenerator::kBinaryOperatorNe,
-                    r_exp->GetFinalValue(),
-                    instruction_generator_.GenerateImm(0)),
-                true_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateGoto(false_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateLabel(true_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                result_variable_name,
-                instruction_generator_.GenerateImm(1)));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateLabel(exit_label));
-
-            return std::make_shared<ExpValue>(
-                preparation_sequence,
-                result_variable_name,
-                kLogicOperationResultType);
-        }
-        case TOKEN_OPERATOR_LOGICAL_OR:
-        {
-            auto result_variable_name = GetNextVariableName();
-            auto true_label = GetNextLabelName();
-            auto exit_label = GetNextLabelName();
-
-            preparation_sequence.push_back(instruction_generator_.GenerateIf(
-                instruction_generator_.GenerateBinaryOperation(
-                    InstructionGenerator::kBinaryOperatorNe,
-                    l_exp->GetFinalValue(),
-                    instruction_generator_.GenerateImm(0)),
-                true_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateIf(
-                instruction_generator_.GenerateBinaryOperation(
-                    InstructionGenerator::kBinaryOperatorNe,
-                    r_exp->GetFinalValue(),
-                    instruction_generator_.GenerateImm(0)),
-                true_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                result_variable_name,
-                instruction_generator_.GenerateImm(0)));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateGoto(exit_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateLabel(true_label));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                result_variable_name,
-                instruction_generator_.GenerateImm(1)));
-
-            preparation_sequence.push_back(instruction_generator_.GenerateLabel(exit_label));
-
-            return std::make_shared<ExpValue>(
-                preparation_sequence,
-                result_variable_name,
-                kLogicOperationResultType);
-        }
         case TOKEN_OPERATOR_REL_EQ:
         case TOKEN_OPERATOR_REL_GE:
         case TOKEN_OPERATOR_REL_GT:
@@ -1328,37 +1257,7 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             // in the form of binary operation
             if (force_singular)
             {
-                auto binary_operator = GetBinaryOperator(operator_type);
-
-                auto result_variable_name = GetNextVariableName();
-                auto true_label = GetNextLabelName();
-                auto exit_label = GetNextLabelName();
-
-                preparation_sequence.push_back(instruction_generator_.GenerateIf(
-                    instruction_generator_.GenerateBinaryOperation(
-                        binary_operator,
-                        l_exp->GetFinalValue(),
-                        r_exp->GetFinalValue()),
-                    true_label));
-
-                preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                    result_variable_name,
-                    instruction_generator_.GenerateImm(0)));
-
-                preparation_sequence.push_back(instruction_generator_.GenerateGoto(exit_label));
-
-                preparation_sequence.push_back(instruction_generator_.GenerateLabel(true_label));
-
-                preparation_sequence.push_back(instruction_generator_.GenerateAssign(
-                    result_variable_name,
-                    instruction_generator_.GenerateImm(1)));
-
-                preparation_sequence.push_back(instruction_generator_.GenerateLabel(exit_label));
-
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
-                    result_variable_name,
-                    kLogicOperationResultType);
+                return DoConditionValue(node);
             }
             else
             {
@@ -1373,29 +1272,29 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
             auto binary_operator = GetBinaryOperator(operator_type);
             if (force_singular)
             {
-                auto variable_name = GetNextVariableName();
-                preparation_sequence.push_back(
+                auto variable_name = GetNextVariable();
+                preparation_sequence.PushBack(
                     instruction_generator_.GenerateAssign(
                         variable_name,
                         instruction_generator_.GenerateBinaryOperation(
                             binary_operator,
-                            l_exp->GetFinalValue(),
-                            r_exp->GetFinalValue())));
+                            l_exp->GetFinalOperand(),
+                            r_exp->GetFinalOperand())));
 
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     variable_name,
                     l_exp->GetSourceType());
             }
             else
             {
-                return std::make_shared<ExpValue>(
-                    preparation_sequence,
+                return MakeExpValue(
+                    std::move(preparation_sequence),
                     instruction_generator_.GenerateBinaryOperation(
                         binary_operator,
-                        l_exp->GetFinalValue(),
-                        r_exp->GetFinalValue()),
-                    is_relop ? kLogicOperationResultType : l_exp->GetSourceType());
+                        l_exp->GetFinalOperand(),
+                        r_exp->GetFinalOperand()),
+                    is_relop ? int_type_ : l_exp->GetSourceType());
             }
         }
 
@@ -1405,6 +1304,227 @@ ExpValueSharedPtr IrGenerator::DoExp(const KTreeNode *node,
     }
 }
 
+// Translates the expression at node as a condition: the returned sequence
+// jumps to true_label if the expression is nonzero and to false_label otherwise,
+// without materializing its value. &&, || and ! become short-circuit jumps and
+// a relational operation becomes a single IF.
+// At most one of the labels may be IrOperand::None(), meaning that control
+// falls through to the code after the sequence in that case. This spares the
+// GOTO to a label right after the condition.
+IrSequenceGenerationResult IrGenerator::DoCondition(const KTreeNode *node,
+                                                    const IrOperand &true_label,
+                                                    const IrOperand &false_label)
+{
+    const bool is_true_fall = true_label.type == IrOperandType::NONE;
+    const bool is_false_fall = false_label.type == IrOperandType::NONE;
+
+    if (node->l_child->value->is_token)
+    {
+        switch (node->l_child->value->ast_node_value.token->type)
+        {
+        // Exp: NOT Exp
+        case TOKEN_OPERATOR_LOGICAL_NOT:
+            return DoCondition(node->r_child, false_label, true_label);
+        // Exp: L_BRACKET Exp R_BRACKET
+        case TOKEN_DELIMITER_L_BRACKET:
+            return DoCondition(node->l_child->r_sibling, true_label, false_label);
+        default:
+            break;
+        }
+    }
+    else
+    {
+        auto operator_type = node->l_child->r_sibling->value->ast_node_value.token->type;
+
+        switch (operator_type)
+        {
+        // Exp: Exp AND Exp
+        case TOKEN_OPERATOR_LOGICAL_AND:
+        {
+            // The left operand being false decides the whole condition
+            auto left_false_label = is_false_fall ? GetNextLabel() : false_label;
+
+            auto left = DoCondition(node->l_child, IrOperand::None(), left_false_label);
+            if (!left.first)
+            {
+                return ErrorIrSequenceGenerationResult();
+            }
+
+            auto right = DoCondition(node->r_child, true_label, false_label);
+            if (!right.first)
+            {
+                return ErrorIrSequenceGenerationResult();
+            }
+
+            auto sequence = std::move(left.second);
+            ConcatenateIrSequence(sequence, std::move(right.second));
+            if (is_false_fall)
+            {
+                sequence.PushBack(instruction_generator_.GenerateLabel(left_false_label));
+            }
+
+            return {true, std::move(sequence)};
+        }
+        // Exp: Exp OR Exp
+        case TOKEN_OPERATOR_LOGICAL_OR:
+        {
+            // The left operand being true decides the whole condition
+            auto left_true_label = is_true_fall ? GetNextLabel() : true_label;
+
+            auto left = DoCondition(node->l_child, left_true_label, IrOperand::None());
+            if (!left.first)
+            {
+                return ErrorIrSequenceGenerationResult();
+            }
+
+            auto right = DoCondition(node->r_child, true_label, false_label);
+            if (!right.first)
+            {
+                return ErrorIrSequenceGenerationResult();
+            }
+
+            auto sequence = std::move(left.second);
+            ConcatenateIrSequence(sequence, std::move(right.second));
+            if (is_true_fall)
+            {
+                sequence.PushBack(instruction_generator_.GenerateLabel(left_true_label));
+            }
+
+            return {true, std::move(sequence)};
+        }
+        // Exp: Exp RELOP Exp
+        case TOKEN_OPERATOR_REL_EQ:
+        case TOKEN_OPERATOR_REL_GE:
+        case TOKEN_OPERATOR_REL_GT:
+        case TOKEN_OPERATOR_REL_LE:
+        case TOKEN_OPERATOR_REL_LT:
+        case TOKEN_OPERATOR_REL_NE:
+        {
+            auto l_exp = DoExp(node->l_child, true, false);
+            if (!l_exp)
+            {
+                return ErrorIrSequenceGenerationResult();
+            }
+
+            auto r_exp = DoExp(node->r_child, true, false);
+            if (!r_exp)
+            {
+                return ErrorIrSequenceGenerationResult();
+            }
+
+            auto binary_operator = GetBinaryOperator(operator_type);
+
+            IrList sequence;
+            ConcatenateIrSequence(sequence, l_exp->TakePreparationSequence());
+            ConcatenateIrSequence(sequence, r_exp->TakePreparationSequence());
+
+            // Jump on the negated relation when only the false case jumps.
+            // Not for floats, where a NaN makes both a relation and its negation false.
+            if (is_true_fall && IsIntType(*l_exp->GetSourceType()))
+            {
+                sequence.PushBack(instruction_generator_.GenerateIf(
+                    instruction_generator_.GenerateBinaryOperation(
+                        GetNegatedOperator(binary_operator),
+                        l_exp->GetFinalOperand(),
+                        r_exp->GetFinalOperand()),
+                    false_label));
+
+                return {true, std::move(sequence)};
+            }
+
+            auto if_true_label = is_true_fall ? GetNextLabel() : true_label;
+
+            sequence.PushBack(instruction_generator_.GenerateIf(
+                instruction_generator_.GenerateBinaryOperation(
+                    binary_operator,
+                    l_exp->GetFinalOperand(),
+                    r_exp->GetFinalOperand()),
+                if_true_label));
+
+            if (!is_false_fall)
+            {
+                sequence.PushBack(instruction_generator_.GenerateGoto(false_label));
+            }
+
+            if (is_true_fall)
+            {
+                sequence.PushBack(instruction_generator_.GenerateLabel(if_true_label));
+            }
+
+            return {true, std::move(sequence)};
+        }
+        default:
+            break;
+        }
+    }
+
+    // Any other expression is tested against 0
+    auto expression = DoExp(node, true, false);
+    if (!expression)
+    {
+        return ErrorIrSequenceGenerationResult();
+    }
+
+    auto sequence = expression->TakePreparationSequence();
+
+    if (is_true_fall)
+    {
+        sequence.PushBack(instruction_generator_.GenerateIf(
+            instruction_generator_.GenerateBinaryOperation(
+                IrOperator::EQ,
+                expression->GetFinalOperand(),
+                instruction_generator_.GenerateImm(0)),
+            false_label));
+
+        return {true, std::move(sequence)};
+    }
+
+    sequence.PushBack(instruction_generator_.GenerateIf(
+        instruction_generator_.GenerateBinaryOperation(
+            IrOperator::NE,
+            expression->GetFinalOperand(),
+            instruction_generator_.GenerateImm(0)),
+        true_label));
+
+    if (!is_false_fall)
+    {
+        sequence.PushBack(instruction_generator_.GenerateGoto(false_label));
+    }
+
+    return {true, std::move(sequence)};
+}
+
+// Materializes the 0 or 1 value of a logical or relational expression
+// by translating it as a condition around the assignment of 1
+ExpValueSharedPtr IrGenerator::DoConditionValue(const KTreeNode *node)
+{
+    auto result_variable_name = GetNextVariable();
+    auto false_label = GetNextLabel();
+
+    auto condition = DoCondition(node, IrOperand::None(), false_label);
+    if (!condition.first)
+    {
+        return nullptr;
+    }
+
+    IrList preparation_sequence = {instruction_generator_.GenerateAssign(
+        result_variable_name,
+        instruction_generator_.GenerateImm(0))};
+
+    ConcatenateIrSequence(preparation_sequence, std::move(condition.second));
+
+    preparation_sequence.PushBack(instruction_generator_.GenerateAssign(
+        result_variable_name,
+        instruction_generator_.GenerateImm(1)));
+
+    preparation_sequence.PushBack(instruction_generator_.GenerateLabel(false_label));
+
+    return MakeExpValue(
+        std::move(preparation_sequence),
+        result_variable_name,
+        int_type_);
+}
+
 std::vector<ExpValueSharedPtr> IrGenerator::DoArgs(const KTreeNode *node)
 {
     std::vector<ExpValueSharedPtr> args;
@@ -1435,8 +1555,8 @@ std::vector<ExpValueSharedPtr> IrGenerator::DoArgs(const KTreeNode *node)
         // 1D array will fall into this block
         case VariableSymbolType::STRUCT:
         {
-            args.push_back(std::make_shared<ExpValue>(
-                arg_exp->GetPreparationSequence(),
+            args.push_back(MakeExpValue(
+                arg_exp->TakePreparationSequence(),
                 arg_exp->GetFinalValue(),
                 nullptr));
             break;
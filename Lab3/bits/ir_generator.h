@@ -13,6 +13,8 @@ extern "C"
 {
 #include "../../Lab1/bits/defs.h"
 #include "../../Lab1/bits/k_tree.h"
+#include "../../Lab1/bits/flat_ast.h"
+#include "../../Lab1/bits/interner.h"
 #include "../../Lab1/bits/token.h"
 #include "../../Lab1/bits/variable.h"
 }
@@ -25,14 +27,17 @@ extern "C"
 #include "../../Lab2/bits/symbols/struct_symbol.h"
 #include "../../Lab2/bits/symbols/struct_def_symbol.h"
 #include "../../Lab2/bits/symbols/symbol_type.h"
+#include "../../Lab2/bits/time_report.h"
 
 #include "instruction_generator.h"
+#include "ir_instruction.h"
+#include "ir_list.h"
+#include "ir_sink.h"
 #include "exp_values/exp_value.h"
 #include "exp_values/array_element_exp_value.h"
 
-using IrSequence = std::vector<std::string>;
 // <no error, ir sequence>
-using IrSequenceGenerationResult = std::pair<bool, IrSequence>;
+using IrSequenceGenerationResult = std::pair<bool, IrList>;
 
 class IrGenerator
 {
@@ -42,40 +47,92 @@ private:
     const SymbolTable symbol_table_;
     const StructDefSymbolTable struct_def_symbol_table_;
 
-    // Maps symbol name to IR variable name
-    std::unordered_map<std::string, std::string> ir_variable_table_;
-    // Maps symbol name to whether it's an address
+    // Only valid during Generate()
+    const FlatAst *flat_ast_;
+
+    // Optional, receives per-ExtDef measurements
+    TimeReport *time_report_;
+
+    // Shared with the lexer and the semantic analyser
+    const Interner *interner_;
+    const InternId read_function_name_;
+    const InternId write_function_name_;
+
+    // Maps interned symbol name to IR variable
+    std::unordered_map<InternId, IrOperand> ir_variable_table_;
+    // Maps interned symbol name to whether it's an address
     // (in C-- this can only be an array/struct parameter)
-    std::unordered_map<std::string, bool> is_address_symbol_;
+    std::unordered_map<InternId, bool> is_address_symbol_;
 
     InstructionGenerator instruction_generator_;
 
+    // Types of literals and of condition values, shared by all expressions
+    // instead of allocated for each of them
+    const VariableSymbolSharedPtr int_type_;
+    const VariableSymbolSharedPtr float_type_;
+
     size_t next_variable_id_;
     size_t next_label_id_;
 
+    // Finished top-level ExtDefs go to sink_ if set, otherwise to ir_sequence_
+    IrSink *sink_;
     IrSequence ir_sequence_;
-
-    const IrSequenceGenerationResult kErrorIrSequenceGenerationResult;
+    // Reused to flatten each finished ExtDef before handing it to sink_
+    IrSequence sink_sequence_;
 
 public:
     IrGenerator(const SymbolTable &symbol_table,
-                const StructDefSymbolTable &struct_def_symbol_table)
+                const StructDefSymbolTable &struct_def_symbol_table,
+                Interner *interner)
         : has_error_(false),
           symbol_table_(symbol_table),
           struct_def_symbol_table_(struct_def_symbol_table),
+          flat_ast_(nullptr),
+          time_report_(nullptr),
+          interner_(interner),
+          read_function_name_(InternerInternString(interner, "read")),
+          write_function_name_(InternerInternString(interner, "write")),
+          int_type_(std::make_shared<ArithmeticSymbol>(-1, INTERN_ID_EMPTY, ArithmeticSymbolType::INT)),
+          float_type_(std::make_shared<ArithmeticSymbol>(-1, INTERN_ID_EMPTY, ArithmeticSymbolType::FLOAT)),
           next_variable_id_(0),
           next_label_id_(0),
-          kErrorIrSequenceGenerationResult({false, IrSequence()}) {}
-    IrGenerator() : IrGenerator(SymbolTable(), StructDefSymbolTable()) {}
+          sink_(nullptr) {}
+    IrGenerator(Interner *interner)
+        : IrGenerator(SymbolTable(), StructDefSymbolTable(), interner) {}
+
+    void Generate(const KTreeNode *root, const FlatAst *flat_ast);
+
+    void SetTimeReport(TimeReport *time_report)
+    {
+        time_report_ = time_report;
+    }
 
-    void Generate(const KTreeNode *root);
+    // Streams the IR of each top-level ExtDef to sink as soon as it is
+    // generated. GetIrSequence() then stays empty.
+    void SetSink(IrSink *sink)
+    {
+        sink_ = sink;
+    }
+
+    // Hands out a variable number the generator will not use, for
+    // optimization passes that introduce variables while it runs
+    uint32_t AllocateVariableId()
+    {
+        return next_variable_id_++;
+    }
+
+    // Likewise for label numbers
+    uint32_t AllocateLabelId()
+    {
+        return next_label_id_++;
+    }
 
     bool GetHasError() const
     {
         return has_error_;
     }
 
-    IrSequence GetIrSequence() const
+    const IrSequence &GetIrSequence() const
     {
         return ir_sequence_;
     }
@@ -85,16 +142,23 @@ private:
     void PrintKTreeNodeInfo(const KTreeNode *node) const;
 
     void PrintError(const std::string &message);
-    std::string GetNextVariableName();
-    std::string GetNextLabelName();
+    std::string GetInternedString(const InternId id) const;
+    IrOperand GetNextVariable();
+    IrOperand GetNextLabel();
+    int GetIntLiteralValue(const InternId literal) const;
     size_t GetVariableSize(const VariableSymbol &variable) const;
     std::tuple<std::vector<size_t>, VariableSymbolSharedPtr, size_t> GetArrayInfo(
         const ArraySymbol &variable) const;
-    std::string GetBinaryOperator(const int type) const;
+    IrOperator GetBinaryOperator(const int type) const;
+    static IrOperator GetNegatedOperator(const IrOperator op);
+    static bool IsIntType(const VariableSymbol &variable);
     bool ShouldPassAddress(const VariableSymbol &variable) const;
-    void ConcatenateIrSequence(IrSequence &seq1, const IrSequence &seq2) const;
-    void AppendIrSequence(const IrSequence &instruction);
+    static IrSequenceGenerationResult ErrorIrSequenceGenerationResult();
+    void ConcatenateIrSequence(IrList &seq1, IrList &&seq2) const;
+    void AppendIrSequence(IrList &&ir_list);
 
+    // Methods taking a flat node index walk flat_ast_ directly. Their KTreeNode
+    // overloads only forward to them, so the rest can be ported one at a time.
     bool DoExtDefList(const KTreeNode *node);
     bool DoExtDef(const KTreeNode *node);
     IrSequenceGenerationResult DoExtDecList(const KTreeNode *node);
@@ -102,15 +166,20 @@ private:
     IrSequenceGenerationResult DoDef(const KTreeNode *node);
     IrSequenceGenerationResult DoDecList(const KTreeNode *node);
     IrSequenceGenerationResult DoDec(const KTreeNode *node);
-    std::string DoVarDec(const KTreeNode *node);
+    InternId DoVarDec(const KTreeNode *node);
+    InternId DoVarDec(const int flat_index);
     IrSequenceGenerationResult DoFunDec(const KTreeNode *node);
-    std::vector<std::string> DoVarList(const KTreeNode *node);
-    std::string DoParamDec(const KTreeNode *node);
+    std::vector<InternId> DoVarList(const KTreeNode *node);
+    InternId DoParamDec(const KTreeNode *node);
     IrSequenceGenerationResult DoCompSt(const KTreeNode *node);
     IrSequenceGenerationResult DoStmtList(const KTreeNode *node);
     IrSequenceGenerationResult DoStmt(const KTreeNode *node);
     ExpValueSharedPtr DoExp(const KTreeNode *node,
                             const bool force_singular,
                             const bool singular_no_prefix);
+    IrSequenceGenerationResult DoCondition(const KTreeNode *node,
+                                           const IrOperand &true_label,
+                                           const IrOperand &false_label);
+    ExpValueSharedPtr DoConditionValue(const KTreeNode *node);
     std::vector<ExpValueSharedPtr> DoArgs(const KTreeNode *node);
 };
\ No newline at end of file
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+extern "C"
+{
+#include "../../Lab1/bits/interner.h"
+}
+
+enum class IrOperandType : uint8_t
+{
+    NONE,
+    // varN
+    VARIABLE,
+    // &varN
+    ADDRESS,
+    // *varN
+    DEREFERENCE,
+    // #N
+    IMMEDIATE,
+    // #<lexeme>, a floating point literal kept as written in the source
+    FLOAT_IMMEDIATE,
+    // labelN
+    LABEL,
+    // A function name
+    FUNCTION
+};
+
+// 12 bytes. Names are never stored as strings: variables and labels are
+// numbered, functions and literals refer to the shared Interner.
+struct IrOperand
+{
+    IrOperandType type;
+    // VARIABLE, ADDRESS, DEREFERENCE: variable number
+    // LABEL: label number
+    // FUNCTION: interned function name
+    // IMMEDIATE: the value
+    uint32_t value;
+    // Source lexeme of an IMMEDIATE or FLOAT_IMMEDIATE literal, printed verbatim
+    // so that e.g. 0x10 stays 0x10. INTERN_ID_EMPTY for generated immediates.
+    InternId lexeme;
+
+    static IrOperand None()
+    {
+        return {IrOperandType::NONE, 0, INTERN_ID_EMPTY};
+    }
+
+    static IrOperand Variable(const uint32_t id)
+    {
+        return {IrOperandType::VARIABLE, id, INTERN_ID_EMPTY};
+    }
+
+    static IrOperand Label(const uint32_t id)
+    {
+        return {IrOperandType::LABEL, id, INTERN_ID_EMPTY};
+    }
+
+    static IrOperand Function(const InternId name)
+    {
+        return {IrOperandType::FUNCTION, name, INTERN_ID_EMPTY};
+    }
+
+    static IrOperand Immediate(const int32_t value)
+    {
+        return {IrOperandType::IMMEDIATE, static_cast<uint32_t>(value), INTERN_ID_EMPTY};
+    }
+
+    static IrOperand Immediate(const int32_t value, const InternId lexeme)
+    {
+        return {IrOperandType::IMMEDIATE, static_cast<uint32_t>(value), lexeme};
+    }
+
+    static IrOperand FloatImmediate(const InternId lexeme)
+    {
+        return {IrOperandType::FLOAT_IMMEDIATE, 0, lexeme};
+    }
+
+    int32_t GetImmediateValue() const
+    {
+        return static_cast<int32_t>(value);
+    }
+
+    // Whether the operand names a variable, with or without a prefix
+    bool IsVariableBased() const
+    {
+        return type == IrOperandType::VARIABLE ||
+               type == IrOperandType::ADDRESS ||
+               type == IrOperandType::DEREFERENCE;
+    }
+
+    bool operator==(const IrOperand &other) const
+    {
+        return type == other.type && value == other.value && lexeme == other.lexeme;
+    }
+
+    bool operator!=(const IrOperand &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+enum class IrOperator : uint8_t
+{
+    NONE,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE
+};
+
+enum class IrOpcode : uint8_t
+{
+    // LABEL dest :
+    LABEL,
+    // FUNCTION dest :
+    FUNCTION,
+    // dest := arg1
+    ASSIGN,
+    // dest := arg1 op arg2
+    BINARY,
+    // dest := CALL arg1, or CALL arg1 when dest is NONE
+    CALL,
+    // GOTO dest
+    GOTO,
+    // IF arg1 op arg2 GOTO dest
+    IF,
+    // RETURN arg1
+    RETURN,
+    // DEC dest <arg1>
+    DEC,
+    // GLOBAL_DEC dest <arg1>
+    GLOBAL_DEC,
+    // ARG arg1
+    ARG,
+    // PARAM dest
+    PARAM,
+    // READ dest
+    READ,
+    // WRITE arg1
+    WRITE
+};
+
+// The right-hand side of an assignment: a single operand (ASSIGN),
+// a binary operation (BINARY) or a function call (CALL).
+// DoExp() returns the final value of an expression in this form.
+struct IrValue
+{
+    IrOpcode opcode;
+    IrOperator op;
+    IrOperand arg1;
+    IrOperand arg2;
+
+    static IrValue Singular(const IrOperand &operand)
+    {
+        return {IrOpcode::ASSIGN, IrOperator::NONE, operand, IrOperand::None()};
+    }
+
+    bool IsSingular() const
+    {
+        return opcode == IrOpcode::ASSIGN;
+    }
+};
+
+// 40 bytes. The label of LABEL, GOTO and IF is stored in dest.
+struct IrInstruction
+{
+    IrOpcode opcode;
+    IrOperator op;
+    IrOperand dest;
+    IrOperand arg1;
+    IrOperand arg2;
+};
+
+using IrSequence = std::vector<IrInstruction>;
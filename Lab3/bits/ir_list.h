@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "ir_instruction.h"
+
+// Holds the nodes of every IrList of a thread in fixed-size chunks, which
+// are never moved or freed, and links them by index. The nodes of a
+// destroyed list are put back on a free list in O(1) and reused, so once
+// the chunks cover the most instructions that were alive at the same time,
+// building IR allocates nothing per instruction.
+class IrListPool
+{
+public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Node
+    {
+        IrInstruction instruction;
+        uint32_t next;
+    };
+
+private:
+    static constexpr uint32_t kChunkShift = 12;
+    static constexpr uint32_t kChunkSize = uint32_t(1) << kChunkShift;
+
+    std::vector<std::unique_ptr<Node[]>> chunks_;
+    // Nodes taken from the chunks so far, free or not
+    uint32_t node_count_;
+    uint32_t free_head_;
+
+public:
+    IrListPool() : node_count_(0), free_head_(kNone) {}
+
+    IrListPool(const IrListPool &) = delete;
+    IrListPool &operator=(const IrListPool &) = delete;
+
+    static IrListPool &ForThisThread()
+    {
+        thread_local IrListPool pool;
+        return pool;
+    }
+
+    Node &operator[](const uint32_t index)
+    {
+        return chunks_[index >> kChunkShift][index & (kChunkSize - 1)];
+    }
+
+    // Returns the index of a new node holding instruction, with no next node
+    uint32_t Allocate(const IrInstruction &instruction)
+    {
+        uint32_t index = free_head_;
+        if (index != kNone)
+        {
+            free_head_ = (*this)[index].next;
+        }
+        else
+        {
+            if (node_count_ == chunks_.size() * kChunkSize)
+            {
+                chunks_.push_back(std::make_unique<Node[]>(kChunkSize));
+            }
+
+            index = node_count_++;
+        }
+
+        Node &node = (*this)[index];
+        node.instruction = instruction;
+        node.next = kNone;
+        return index;
+    }
+
+    // Frees the linked nodes from head to tail
+    void Free(const uint32_t head, const uint32_t tail)
+    {
+        (*this)[tail].next = free_head_;
+        free_head_ = head;
+    }
+};
+
+// The instruction list the Do* methods of IrGenerator build bottom-up.
+// Appending another list links its nodes in O(1), so an instruction is
+// never copied again after it's generated, however deeply it is nested.
+// Copying is disabled to keep it that way; lists are passed by moving.
+// A list must be used on the thread that created it.
+class IrList
+{
+private:
+    uint32_t head_;
+    uint32_t tail_;
+    size_t size_;
+
+public:
+    class const_iterator
+    {
+    private:
+        IrListPool *pool_;
+        uint32_t index_;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = IrInstruction;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const IrInstruction *;
+        using reference = const IrInstruction &;
+
+        const_iterator(IrListPool *pool, const uint32_t index) : pool_(pool), index_(index) {}
+
+        reference operator*() const
+        {
+            return (*pool_)[index_].instruction;
+        }
+
+        pointer operator->() const
+        {
+            return &(*pool_)[index_].instruction;
+        }
+
+        const_iterator &operator++()
+        {
+            index_ = (*pool_)[index_].next;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const const_iterator &other) const
+        {
+            return index_ != other.index_;
+        }
+    };
+
+    IrList() : head_(IrListPool::kNone), tail_(IrListPool::kNone), size_(0) {}
+
+    IrList(std::initializer_list<IrInstruction> instructions) : IrList()
+    {
+        for (auto &instruction : instructions)
+        {
+            PushBack(instruction);
+        }
+    }
+
+    ~IrList()
+    {
+        if (head_ != IrListPool::kNone)
+        {
+            IrListPool::ForThisThread().Free(head_, tail_);
+        }
+    }
+
+    IrList(const IrList &) = delete;
+    IrList &operator=(const IrList &) = delete;
+
+    IrList(IrList &&other) : head_(other.head_), tail_(other.tail_), size_(other.size_)
+    {
+        other.head_ = IrListPool::kNone;
+        other.tail_ = IrListPool::kNone;
+        other.size_ = 0;
+    }
+
+    IrList &operator=(IrList &&other)
+    {
+        if (this != &other)
+        {
+            if (head_ != IrListPool::kNone)
+            {
+                IrListPool::ForThisThread().Free(head_, tail_);
+            }
+
+            head_ = other.head_;
+            tail_ = other.tail_;
+            size_ = other.size_;
+
+            other.head_ = IrListPool::kNone;
+            other.tail_ = IrListPool::kNone;
+            other.size_ = 0;
+        }
+
+        return *this;
+    }
+
+    void PushBack(const IrInstruction &instruction)
+    {
+        IrListPool &pool = IrListPool::ForThisThread();
+        uint32_t index = pool.Allocate(instruction);
+
+        if (tail_ == IrListPool::kNone)
+        {
+            head_ = index;
+        }
+        else
+        {
+            pool[tail_].next = index;
+        }
+
+        tail_ = index;
+        size_++;
+    }
+
+    // Moves all instructions of other to the end of this list, leaving other empty
+    void Splice(IrList &&other)
+    {
+        if (other.head_ == IrListPool::kNone)
+        {
+            return;
+        }
+
+        if (tail_ == IrListPool::kNone)
+        {
+            head_ = other.head_;
+        }
+        else
+        {
+            IrListPool::ForThisThread()[tail_].next = other.head_;
+        }
+
+        tail_ = other.tail_;
+        size_ += other.size_;
+
+        other.head_ = IrListPool::kNone;
+        other.tail_ = IrListPool::kNone;
+        other.size_ = 0;
+    }
+
+    size_t Size() const
+    {
+        return size_;
+    }
+
+    bool Empty() const
+    {
+        return size_ == 0;
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(&IrListPool::ForThisThread(), head_);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(nullptr, IrListPool::kNone);
+    }
+};
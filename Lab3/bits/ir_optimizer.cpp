@@ -0,0 +1,112 @@
+#include <unordered_set>
+
+#include "passes/common_subexpression_elimination_pass.h"
+#include "passes/constant_folding_pass.h"
+#include "passes/control_flow_graph.h"
+#include "passes/copy_propagation_pass.h"
+#include "passes/dead_code_elimination_pass.h"
+#include "passes/liveness.h"
+#include "passes/loop_invariant_code_motion_pass.h"
+#include "passes/sparse_conditional_constant_propagation_pass.h"
+#include "passes/strength_reduction_pass.h"
+#include "passes/variable_coalescing_pass.h"
+#include "ir_optimizer.h"
+
+IrOptimizer::IrOptimizer(const int optimization_level,
+                         IrSink *next_sink,
+                         const Interner *interner)
+    : next_sink_(next_sink),
+      interner_(interner),
+      optimization_report_(nullptr)
+{
+    if (optimization_level >= 1)
+    {
+        passes_.push_back(std::make_unique<ConstantFoldingPass>());
+        passes_.push_back(std::make_unique<CommonSubexpressionEliminationPass>());
+        passes_.push_back(std::make_unique<CopyPropagationPass>());
+        passes_.push_back(std::make_unique<DeadCodeEliminationPass>());
+        passes_.push_back(std::make_unique<LoopInvariantCodeMotionPass>());
+        passes_.push_back(std::make_unique<StrengthReductionPass>());
+        // Removes the copies and multiplications strength reduction leaves
+        passes_.push_back(std::make_unique<CopyPropagationPass>());
+        passes_.push_back(std::make_unique<DeadCodeEliminationPass>());
+    }
+
+    if (optimization_level >= 2)
+    {
+        passes_.push_back(std::make_unique<SparseConditionalConstantPropagationPass>());
+        // Folds what the constants it found expose, e.g. x + 0, and removes
+        // the copies the phis turn into when leaving SSA form
+        passes_.push_back(std::make_unique<ConstantFoldingPass>());
+        passes_.push_back(std::make_unique<CopyPropagationPass>());
+        passes_.push_back(std::make_unique<DeadCodeEliminationPass>());
+    }
+
+    if (optimization_level >= 1)
+    {
+        // Last, as it merges variables the other passes tell apart
+        passes_.push_back(std::make_unique<VariableCoalescingPass>());
+    }
+}
+
+void IrOptimizer::Consume(const IrSequence &sequence)
+{
+    // An ExtDef is either one function or a list of global declarations
+    if (sequence.empty() || sequence.front().opcode != IrOpcode::FUNCTION)
+    {
+        for (auto &instruction : sequence)
+        {
+            if (instruction.opcode == IrOpcode::GLOBAL_DEC)
+            {
+                program_info_.global_variables.insert(instruction.dest.value);
+            }
+        }
+
+        next_sink_->Consume(sequence);
+        return;
+    }
+
+    function_ = sequence;
+
+    if (optimization_report_ != nullptr)
+    {
+        optimization_report_->BeginFunction(
+            InternerGetString(interner_, function_.front().dest.value));
+    }
+
+    for (auto &pass : passes_)
+    {
+        if (optimization_report_ == nullptr)
+        {
+            pass->Run(function_, program_info_);
+            continue;
+        }
+
+        IrSize before = MeasureSize(function_);
+        pass->Run(function_, program_info_);
+        optimization_report_->AddPass(pass->GetName(), before, MeasureSize(function_));
+    }
+
+    next_sink_->Consume(function_);
+}
+
+IrSize IrOptimizer::MeasureSize(const IrSequence &function) const
+{
+    std::unordered_set<uint32_t> variables;
+
+    for (auto &instruction : function)
+    {
+        for (auto operand : {&instruction.dest, &instruction.arg1, &instruction.arg2})
+        {
+            if (operand->IsVariableBased())
+            {
+                variables.insert(operand->value);
+            }
+        }
+    }
+
+    ControlFlowGraph cfg(function);
+    Liveness liveness(cfg, program_info_);
+
+    return {function.size(), variables.size(), liveness.GetMaxLiveCount(cfg, program_info_)};
+}
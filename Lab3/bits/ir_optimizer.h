@@ -0,0 +1,54 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+extern "C"
+{
+#include "../../Lab1/bits/interner.h"
+}
+
+#include "ir_sink.h"
+#include "optimization_report.h"
+#include "passes/ir_pass.h"
+
+// Sits between IrGenerator and the final sink. Every function streamed
+// through it is rewritten by the passes of the requested optimization
+// level before being forwarded; GLOBAL_DECs pass through unchanged.
+class IrOptimizer : public IrSink
+{
+private:
+    IrSink *next_sink_;
+    const Interner *interner_;
+    std::vector<std::unique_ptr<IrPass>> passes_;
+    IrProgramInfo program_info_;
+    // Reused for the function being optimized
+    IrSequence function_;
+
+    // Optional, receives what each pass removed from each function
+    OptimizationReport *optimization_report_;
+
+public:
+    IrOptimizer(const int optimization_level, IrSink *next_sink, const Interner *interner);
+
+    void SetOptimizationReport(OptimizationReport *optimization_report)
+    {
+        optimization_report_ = optimization_report;
+    }
+
+    void SetVariableAllocator(const std::function<uint32_t()> &allocate_variable)
+    {
+        program_info_.allocate_variable = allocate_variable;
+    }
+
+    void SetLabelAllocator(const std::function<uint32_t()> &allocate_label)
+    {
+        program_info_.allocate_label = allocate_label;
+    }
+
+    void Consume(const IrSequence &sequence) override;
+
+private:
+    IrSize MeasureSize(const IrSequence &function) const;
+};
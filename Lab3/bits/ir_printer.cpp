@@ -0,0 +1,182 @@
+#include <charconv>
+
+#include "ir_printer.h"
+
+std::string IrPrinter::ToString(const IrInstruction &instruction) const
+{
+    std::string output;
+    Print(instruction, output);
+    return output;
+}
+
+std::string IrPrinter::ToString(const IrOperand &operand) const
+{
+    std::string output;
+    PrintOperand(operand, output);
+    return output;
+}
+
+const char *IrPrinter::GetOperatorString(const IrOperator op)
+{
+    switch (op)
+    {
+    case IrOperator::ADD:
+        return "+";
+    case IrOperator::SUB:
+        return "-";
+    case IrOperator::MUL:
+        return "*";
+    case IrOperator::DIV:
+        return "/";
+    case IrOperator::EQ:
+        return "==";
+    case IrOperator::NE:
+        return "!=";
+    case IrOperator::LT:
+        return "<";
+    case IrOperator::LE:
+        return "<=";
+    case IrOperator::GT:
+        return ">";
+    case IrOperator::GE:
+        return ">=";
+    default:
+        return "";
+    }
+}
+
+void IrPrinter::PrintNumber(const int64_t number, std::string &output) const
+{
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    output.append(buffer, result.ptr);
+}
+
+void IrPrinter::PrintOperand(const IrOperand &operand, std::string &output) const
+{
+    switch (operand.type)
+    {
+    case IrOperandType::ADDRESS:
+        output += "&var";
+        PrintNumber(operand.value, output);
+        break;
+    case IrOperandType::DEREFERENCE:
+        output += "*var";
+        PrintNumber(operand.value, output);
+        break;
+    case IrOperandType::VARIABLE:
+        output += "var";
+        PrintNumber(operand.value, output);
+        break;
+    case IrOperandType::IMMEDIATE:
+        output += '#';
+        if (operand.lexeme != INTERN_ID_EMPTY)
+        {
+            output += InternerGetString(interner_, operand.lexeme);
+        }
+        else
+        {
+            PrintNumber(operand.GetImmediateValue(), output);
+        }
+        break;
+    case IrOperandType::FLOAT_IMMEDIATE:
+        output += '#';
+        output += InternerGetString(interner_, operand.lexeme);
+        break;
+    case IrOperandType::LABEL:
+        output += "label";
+        PrintNumber(operand.value, output);
+        break;
+    case IrOperandType::FUNCTION:
+        output += InternerGetString(interner_, operand.value);
+        break;
+    default:
+        break;
+    }
+}
+
+void IrPrinter::PrintBinaryOperation(const IrOperator op,
+                                     const IrOperand &left,
+                                     const IrOperand &right,
+                                     std::string &output) const
+{
+    PrintOperand(left, output);
+    output += ' ';
+    output += GetOperatorString(op);
+    output += ' ';
+    PrintOperand(right, output);
+}
+
+void IrPrinter::Print(const IrInstruction &instruction, std::string &output) const
+{
+    switch (instruction.opcode)
+    {
+    case IrOpcode::LABEL:
+        output += "LABEL ";
+        PrintOperand(instruction.dest, output);
+        output += " :";
+        break;
+    case IrOpcode::FUNCTION:
+        output += "FUNCTION ";
+        PrintOperand(instruction.dest, output);
+        output += " :";
+        break;
+    case IrOpcode::ASSIGN:
+        PrintOperand(instruction.dest, output);
+        output += " := ";
+        PrintOperand(instruction.arg1, output);
+        break;
+    case IrOpcode::BINARY:
+        PrintOperand(instruction.dest, output);
+        output += " := ";
+        PrintBinaryOperation(instruction.op, instruction.arg1, instruction.arg2, output);
+        break;
+    case IrOpcode::CALL:
+        if (instruction.dest.type != IrOperandType::NONE)
+        {
+            PrintOperand(instruction.dest, output);
+            output += " := ";
+        }
+        output += "CALL ";
+        PrintOperand(instruction.arg1, output);
+        break;
+    case IrOpcode::GOTO:
+        output += "GOTO ";
+        PrintOperand(instruction.dest, output);
+        break;
+    case IrOpcode::IF:
+        output += "IF ";
+        PrintBinaryOperation(instruction.op, instruction.arg1, instruction.arg2, output);
+        output += " GOTO ";
+        PrintOperand(instruction.dest, output);
+        break;
+    case IrOpcode::RETURN:
+        output += "RETURN ";
+        PrintOperand(instruction.arg1, output);
+        break;
+    case IrOpcode::DEC:
+    case IrOpcode::GLOBAL_DEC:
+        output += instruction.opcode == IrOpcode::DEC ? "DEC " : "GLOBAL_DEC ";
+        PrintOperand(instruction.dest, output);
+        output += ' ';
+        // The size is written without the # prefix
+        PrintNumber(instruction.arg1.GetImmediateValue(), output);
+        break;
+    case IrOpcode::ARG:
+        output += "ARG ";
+        PrintOperand(instruction.arg1, output);
+        break;
+    case IrOpcode::PARAM:
+        output += "PARAM ";
+        PrintOperand(instruction.dest, output);
+        break;
+    case IrOpcode::READ:
+        output += "READ ";
+        PrintOperand(instruction.dest, output);
+        break;
+    case IrOpcode::WRITE:
+        output += "WRITE ";
+        PrintOperand(instruction.arg1, output);
+        break;
+    }
+}
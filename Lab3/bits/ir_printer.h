@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+#include "ir_instruction.h"
+
+// Formats typed IR instructions as the textual IR accepted by the IR virtual machine.
+// This is the only place where IR text is produced.
+class IrPrinter
+{
+private:
+    const Interner *interner_;
+
+public:
+    explicit IrPrinter(const Interner *interner) : interner_(interner) {}
+
+    // Appends the text of instruction to output, without a line terminator
+    void Print(const IrInstruction &instruction, std::string &output) const;
+    std::string ToString(const IrInstruction &instruction) const;
+
+    void PrintOperand(const IrOperand &operand, std::string &output) const;
+    std::string ToString(const IrOperand &operand) const;
+
+    static const char *GetOperatorString(const IrOperator op);
+
+private:
+    void PrintNumber(const int64_t number, std::string &output) const;
+    void PrintBinaryOperation(const IrOperator op,
+                              const IrOperand &left,
+                              const IrOperand &right,
+                              std::string &output) const;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+
+#include "ir_instruction.h"
+
+// Receives IR as soon as the generator finishes each top-level ExtDef,
+// so the generator never has to hold the IR of the whole program.
+class IrSink
+{
+public:
+    virtual ~IrSink() = default;
+
+    virtual void Consume(const IrSequence &sequence) = 0;
+};
+
+// The last sink of a chain, writing everything it receives to a file
+class IrFileSink : public IrSink
+{
+public:
+    virtual bool IsOpen() const = 0;
+
+    // Flushes and closes the file. Returns whether every write succeeded.
+    virtual bool Close() = 0;
+
+    // Whether some IR could not be written in the format of the file.
+    // The sink reports why to stderr itself.
+    virtual bool GetHasTranslationError() const
+    {
+        return false;
+    }
+};
+
+// Forwards every finished sequence to a callback
+class CallbackIrSink : public IrSink
+{
+private:
+    const std::function<void(const IrSequence &)> callback_;
+
+public:
+    explicit CallbackIrSink(const std::function<void(const IrSequence &)> &callback)
+        : callback_(callback) {}
+
+    void Consume(const IrSequence &sequence) override
+    {
+        callback_(sequence);
+    }
+};
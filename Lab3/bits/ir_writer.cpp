@@ -0,0 +1,89 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ir_writer.h"
+
+IrWriter::IrWriter(const std::string &path, const Interner *interner)
+    : fd_(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)),
+      has_error_(false),
+      buffer_(kBufferSize),
+      buffer_size_(0),
+      printer_(interner) {}
+
+IrWriter::~IrWriter()
+{
+    Close();
+}
+
+void IrWriter::WriteLine(const std::string &line)
+{
+    if (buffer_size_ + line.size() + 1 > kBufferSize)
+    {
+        Flush();
+
+        // Lines that cannot fit into an empty buffer bypass it
+        if (line.size() + 1 > kBufferSize)
+        {
+            WriteToFile(line.data(), line.size());
+            WriteToFile("\n", 1);
+            return;
+        }
+    }
+
+    std::memcpy(buffer_.data() + buffer_size_, line.data(), line.size());
+    buffer_size_ += line.size();
+    buffer_[buffer_size_++] = '\n';
+}
+
+void IrWriter::WriteInstruction(const IrInstruction &instruction)
+{
+    line_.clear();
+    printer_.Print(instruction, line_);
+    WriteLine(line_);
+}
+
+bool IrWriter::Close()
+{
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    Flush();
+
+    if (close(fd_) != 0)
+    {
+        has_error_ = true;
+    }
+
+    fd_ = -1;
+
+    return !has_error_;
+}
+
+void IrWriter::Flush()
+{
+    WriteToFile(buffer_.data(), buffer_size_);
+    buffer_size_ = 0;
+}
+
+void IrWriter::WriteToFile(const char *data, size_t size)
+{
+    while (size > 0 && !has_error_)
+    {
+        ssize_t written_size = write(fd_, data, size);
+        if (written_size < 0)
+        {
+            if (errno != EINTR)
+            {
+                has_error_ = true;
+            }
+            continue;
+        }
+
+        data += written_size;
+        size -= written_size;
+    }
+}
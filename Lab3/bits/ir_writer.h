@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ir_printer.h"
+#include "ir_sink.h"
+
+// Writes IR lines to a file through one large user-space buffer.
+// The buffer is only handed to the OS when it fills up or on Close(),
+// so output costs a handful of write() calls instead of a flush per line.
+// As an IrSink it lets IrGenerator stream each function straight to disk,
+// formatting instructions through a reused line buffer.
+class IrWriter : public IrFileSink
+{
+private:
+    static constexpr size_t kBufferSize = 1 << 20;
+
+    int fd_;
+    bool has_error_;
+    std::vector<char> buffer_;
+    size_t buffer_size_;
+
+    const IrPrinter printer_;
+    std::string line_;
+
+public:
+    IrWriter(const std::string &path, const Interner *interner);
+    ~IrWriter() override;
+
+    IrWriter(const IrWriter &) = delete;
+    IrWriter &operator=(const IrWriter &) = delete;
+
+    bool IsOpen() const override
+    {
+        return fd_ >= 0;
+    }
+
+    // Appends line and a line terminator
+    void WriteLine(const std::string &line);
+
+    void WriteInstruction(const IrInstruction &instruction);
+
+    void Consume(const IrSequence &sequence) override
+    {
+        for (auto &instruction : sequence)
+        {
+            WriteInstruction(instruction);
+        }
+    }
+
+    bool Close() override;
+
+private:
+    void Flush();
+    void WriteToFile(const char *data, size_t size);
+};
@@ -0,0 +1,692 @@
+#include <algorithm>
+#include <iostream>
+
+#include "mips32_asm_writer.h"
+
+namespace
+{
+    constexpr size_t kCallerSavedCount = 8;
+    constexpr size_t kCalleeSavedCount = 8;
+    constexpr size_t kArgumentRegisterCount = 4;
+}
+
+Mips32AsmWriter::Mips32AsmWriter(const std::string &path, const Interner *interner)
+    : file_(path),
+      interner_(interner),
+      printer_(interner),
+      has_translation_error_(false),
+      spill_report_(nullptr),
+      allocator_(kCallerSavedCount, kCalleeSavedCount),
+      argument_count_(0),
+      argument_index_(0)
+{
+    file_ << ".data\n"
+          << "_newline: .asciiz \"\\n\"\n"
+          << ".globl main\n"
+          << ".text\n"
+          // MARS starts at the first instruction, SPIM calls main itself
+          << "_start:\n"
+          << "    jal main\n"
+          << "    move $a0, $v0\n"
+          << "    li $v0, 17\n"
+          << "    syscall\n"
+          << "_read:\n"
+          << "    li $v0, 5\n"
+          << "    syscall\n"
+          << "    jr $ra\n"
+          << "_write:\n"
+          << "    li $v0, 1\n"
+          << "    syscall\n"
+          << "    li $v0, 4\n"
+          << "    la $a0, _newline\n"
+          << "    syscall\n"
+          << "    jr $ra\n";
+}
+
+void Mips32AsmWriter::Consume(const IrSequence &sequence)
+{
+    if (sequence.empty())
+    {
+        return;
+    }
+
+    if (sequence.front().opcode == IrOpcode::FUNCTION)
+    {
+        WriteFunction(sequence);
+    }
+    else
+    {
+        WriteGlobals(sequence);
+    }
+}
+
+bool Mips32AsmWriter::Close()
+{
+    if (!file_.is_open())
+    {
+        return false;
+    }
+
+    file_.close();
+
+    return !file_.fail();
+}
+
+void Mips32AsmWriter::PrintError(const std::string &message)
+{
+    has_translation_error_ = true;
+    // One write per line keeps diagnostics of concurrent compilations apart
+    std::cerr << "MIPS32 translation error : " + message + '\n';
+}
+
+void Mips32AsmWriter::WriteGlobals(const IrSequence &sequence)
+{
+    file_ << ".data\n";
+
+    for (auto &instruction : sequence)
+    {
+        if (instruction.opcode == IrOpcode::GLOBAL_DEC)
+        {
+            program_info_.global_variables.insert(instruction.dest.value);
+            file_ << ".align 2\n"
+                  << GetGlobalLabel(instruction.dest.value) << ": .space "
+                  << instruction.arg1.value << '\n';
+        }
+    }
+
+    file_ << ".text\n";
+}
+
+void Mips32AsmWriter::WriteFunction(const IrSequence &function)
+{
+    const InternId name = function.front().dest.value;
+    function_name_ = InternerGetString(interner_, name);
+
+    allocator_.Allocate(function, program_info_);
+
+    int32_t frame_size;
+    if (!AllocateFrame(function, frame_size))
+    {
+        return;
+    }
+
+    size_t register_count = 0;
+    for (size_t i = 0; i < kCallerSavedCount + kCalleeSavedCount; i++)
+    {
+        register_count += allocator_.IsRegisterUsed(static_cast<int>(i));
+    }
+
+    if (spill_report_ != nullptr)
+    {
+        spill_report_->AddFunction(function_name_,
+                                   allocator_.GetIntervals().size(),
+                                   allocator_.GetSpillCount(),
+                                   register_count);
+    }
+
+    file_ << "\n# " << function_name_ << ": "
+          << allocator_.GetIntervals().size() << " variables, "
+          << allocator_.GetSpillCount() << " spilled\n"
+          << GetFunctionLabel(name) << ":\n";
+
+    WritePrologue(function, frame_size);
+
+    argument_count_ = 0;
+    argument_index_ = 0;
+
+    for (size_t i = 1; i < function.size(); i++)
+    {
+        WriteInstruction(function, i);
+    }
+
+    // A function may end without RETURN, e.g. with an infinite loop
+    IrOpcode last_opcode = function.back().opcode;
+    if (last_opcode != IrOpcode::RETURN && last_opcode != IrOpcode::GOTO)
+    {
+        file_ << "    move $v0, $zero\n";
+        WriteEpilogue();
+    }
+}
+
+bool Mips32AsmWriter::AllocateFrame(const IrSequence &function, int32_t &frame_size)
+{
+    spill_offsets_.clear();
+    dec_offsets_.clear();
+    saved_register_offsets_.clear();
+
+    // $ra at -4($fp), the caller's $fp at -8($fp)
+    int32_t offset = -8;
+
+    for (int i = kCallerSavedCount; i < static_cast<int>(kCallerSavedCount + kCalleeSavedCount); i++)
+    {
+        if (allocator_.IsRegisterUsed(i))
+        {
+            offset -= 4;
+            saved_register_offsets_.emplace_back(i, offset);
+        }
+    }
+
+    for (auto &interval : allocator_.GetIntervals())
+    {
+        if (allocator_.GetRegister(interval.variable) == LinearScanAllocator::kSpilled)
+        {
+            offset -= 4;
+            spill_offsets_[interval.variable] = offset;
+        }
+    }
+
+    size_t max_argument_count = 0;
+    size_t argument_count = 0;
+
+    // Optimizations may move an address above its DEC, e.g. out of a loop
+    for (auto &instruction : function)
+    {
+        if (instruction.opcode == IrOpcode::DEC)
+        {
+            offset -= static_cast<int32_t>((instruction.arg1.value + 3) & ~3u);
+            dec_offsets_[instruction.dest.value] = offset;
+        }
+    }
+
+    for (auto &instruction : function)
+    {
+        switch (instruction.opcode)
+        {
+        case IrOpcode::ARG:
+            argument_count++;
+            break;
+        case IrOpcode::CALL:
+            max_argument_count = std::max(max_argument_count, argument_count);
+            argument_count = 0;
+            break;
+        default:
+            break;
+        }
+
+        for (const IrOperand *operand : {&instruction.dest, &instruction.arg1, &instruction.arg2})
+        {
+            if (operand->type == IrOperandType::FLOAT_IMMEDIATE)
+            {
+                PrintError("Function " + function_name_ +
+                           " uses floating point values, which are not supported");
+                return false;
+            }
+
+            if (operand->type == IrOperandType::ADDRESS &&
+                !program_info_.IsGlobal(*operand) &&
+                dec_offsets_.count(operand->value) == 0)
+            {
+                PrintError("Function " + function_name_ +
+                           " takes the address of a variable without DEC");
+                return false;
+            }
+        }
+    }
+
+    int32_t outgoing_size =
+        max_argument_count > kArgumentRegisterCount
+            ? static_cast<int32_t>(4 * (max_argument_count - kArgumentRegisterCount))
+            : 0;
+
+    // Keeps $sp 8-byte aligned
+    frame_size = (-offset + outgoing_size + 7) & ~7;
+
+    return true;
+}
+
+void Mips32AsmWriter::WritePrologue(const IrSequence &function, const int32_t frame_size)
+{
+    file_ << "    sw $ra, -4($sp)\n"
+          << "    sw $fp, -8($sp)\n"
+          << "    move $fp, $sp\n";
+
+    if (IsImmediate16(-frame_size))
+    {
+        file_ << "    addiu $sp, $sp, " << -frame_size << '\n';
+    }
+    else
+    {
+        file_ << "    li $v1, " << frame_size << '\n'
+              << "    subu $sp, $sp, $v1\n";
+    }
+
+    for (auto &[reg, offset] : saved_register_offsets_)
+    {
+        WriteFrameAccess("sw", GetRegisterName(reg), offset);
+    }
+
+    // PARAMs come right after FUNCTION
+    size_t param_index = 0;
+    for (size_t i = 1; i < function.size() && function[i].opcode == IrOpcode::PARAM; i++)
+    {
+        const IrOperand &dest = function[i].dest;
+        std::string reg = GetVariableRegister(dest.value);
+
+        if (param_index < kArgumentRegisterCount)
+        {
+            std::string argument_register = "$a" + std::to_string(param_index);
+
+            if (reg.empty())
+            {
+                WriteFrameAccess("sw", argument_register, spill_offsets_.at(dest.value));
+            }
+            else
+            {
+                file_ << "    move " << reg << ", " << argument_register << '\n';
+            }
+        }
+        else
+        {
+            // In the outgoing argument area of the caller
+            int32_t offset = static_cast<int32_t>(4 * (param_index - kArgumentRegisterCount));
+
+            if (reg.empty())
+            {
+                WriteFrameAccess("lw", "$t8", offset);
+                WriteFrameAccess("sw", "$t8", spill_offsets_.at(dest.value));
+            }
+            else
+            {
+                WriteFrameAccess("lw", reg, offset);
+            }
+        }
+
+        param_index++;
+    }
+}
+
+void Mips32AsmWriter::WriteEpilogue()
+{
+    for (auto &[reg, offset] : saved_register_offsets_)
+    {
+        WriteFrameAccess("lw", GetRegisterName(reg), offset);
+    }
+
+    file_ << "    move $sp, $fp\n"
+          << "    lw $ra, -4($sp)\n"
+          << "    lw $fp, -8($sp)\n"
+          << "    jr $ra\n";
+}
+
+void Mips32AsmWriter::WriteInstruction(const IrSequence &function, const size_t index)
+{
+    const IrInstruction &instruction = function[index];
+
+    if (instruction.opcode == IrOpcode::LABEL)
+    {
+        file_ << GetLabel(instruction.dest) << ":\n";
+        return;
+    }
+
+    line_.clear();
+    printer_.Print(instruction, line_);
+    file_ << "    # " << line_ << '\n';
+
+    switch (instruction.opcode)
+    {
+    case IrOpcode::ASSIGN:
+    {
+        std::string reg = GetDestRegister(instruction.dest);
+        if (reg == "$t8")
+        {
+            // Stores to memory can take the value from any register
+            reg = Use(instruction.arg1, "$t8");
+        }
+        else
+        {
+            WriteLoad(instruction.arg1, reg);
+        }
+
+        WriteDefinition(instruction.dest, reg);
+        break;
+    }
+
+    case IrOpcode::BINARY:
+        WriteBinary(instruction);
+        break;
+
+    case IrOpcode::CALL:
+        file_ << "    jal " << GetFunctionLabel(instruction.arg1.value) << '\n';
+        argument_count_ = 0;
+        argument_index_ = 0;
+
+        if (instruction.dest.type != IrOperandType::NONE)
+        {
+            WriteDefinition(instruction.dest, "$v0");
+        }
+        break;
+
+    case IrOpcode::GOTO:
+        file_ << "    j " << GetLabel(instruction.dest) << '\n';
+        break;
+
+    case IrOpcode::IF:
+    {
+        std::string left = Use(instruction.arg1, "$t8");
+        std::string right = Use(instruction.arg2, "$t9");
+
+        file_ << "    " << GetBranchMnemonic(instruction.op) << ' '
+              << left << ", " << right << ", " << GetLabel(instruction.dest) << '\n';
+        break;
+    }
+
+    case IrOpcode::RETURN:
+        WriteLoad(instruction.arg1, "$v0");
+        WriteEpilogue();
+        break;
+
+    case IrOpcode::ARG:
+        WriteArg(function, index);
+        break;
+
+    case IrOpcode::READ:
+        file_ << "    jal _read\n";
+        WriteDefinition(instruction.dest, "$v0");
+        break;
+
+    case IrOpcode::WRITE:
+        WriteLoad(instruction.arg1, "$a0");
+        file_ << "    jal _write\n";
+        break;
+
+    default:
+        // PARAM is handled by the prologue, DEC by AllocateFrame
+        break;
+    }
+}
+
+void Mips32AsmWriter::WriteBinary(const IrInstruction &instruction)
+{
+    const IrOperand *left = &instruction.arg1;
+    const IrOperand *right = &instruction.arg2;
+
+    if ((instruction.op == IrOperator::ADD || instruction.op == IrOperator::MUL) &&
+        left->type == IrOperandType::IMMEDIATE)
+    {
+        std::swap(left, right);
+    }
+
+    std::string dest = GetDestRegister(instruction.dest);
+    std::string left_register = Use(*left, "$t8");
+
+    // Unsigned additions wrap around instead of trapping on overflow
+    if (right->type == IrOperandType::IMMEDIATE &&
+        ((instruction.op == IrOperator::ADD && IsImmediate16(right->GetImmediateValue())) ||
+         (instruction.op == IrOperator::SUB && IsImmediate16(-int64_t(right->GetImmediateValue())))))
+    {
+        int64_t immediate = right->GetImmediateValue();
+        file_ << "    addiu " << dest << ", " << left_register << ", "
+              << (instruction.op == IrOperator::ADD ? immediate : -immediate) << '\n';
+        WriteDefinition(instruction.dest, dest);
+        return;
+    }
+
+    std::string right_register = Use(*right, "$t9");
+    const std::string operands = left_register + ", " + right_register;
+
+    switch (instruction.op)
+    {
+    case IrOperator::ADD:
+        file_ << "    addu " << dest << ", " << operands << '\n';
+        break;
+    case IrOperator::SUB:
+        file_ << "    subu " << dest << ", " << operands << '\n';
+        break;
+    case IrOperator::MUL:
+        file_ << "    mul " << dest << ", " << operands << '\n';
+        break;
+    case IrOperator::DIV:
+        file_ << "    div " << operands << '\n'
+              << "    mflo " << dest << '\n';
+        break;
+    case IrOperator::EQ:
+        file_ << "    subu " << dest << ", " << operands << '\n'
+              << "    sltiu " << dest << ", " << dest << ", 1\n";
+        break;
+    case IrOperator::NE:
+        file_ << "    subu " << dest << ", " << operands << '\n'
+              << "    sltu " << dest << ", $zero, " << dest << '\n';
+        break;
+    case IrOperator::LT:
+        file_ << "    slt " << dest << ", " << operands << '\n';
+        break;
+    case IrOperator::GT:
+        file_ << "    slt " << dest << ", " << right_register << ", " << left_register << '\n';
+        break;
+    case IrOperator::LE:
+        file_ << "    slt " << dest << ", " << right_register << ", " << left_register << '\n'
+              << "    xori " << dest << ", " << dest << ", 1\n";
+        break;
+    case IrOperator::GE:
+        file_ << "    slt " << dest << ", " << operands << '\n'
+              << "    xori " << dest << ", " << dest << ", 1\n";
+        break;
+    default:
+        break;
+    }
+
+    WriteDefinition(instruction.dest, dest);
+}
+
+void Mips32AsmWriter::WriteArg(const IrSequence &function, const size_t index)
+{
+    // The ARGs of a call are consecutive, the last argument first
+    if (argument_index_ == 0)
+    {
+        argument_count_ = 0;
+        while (index + argument_count_ < function.size() &&
+               function[index + argument_count_].opcode == IrOpcode::ARG)
+        {
+            argument_count_++;
+        }
+    }
+
+    size_t argument = argument_count_ - 1 - argument_index_;
+    argument_index_ = argument_index_ + 1 == argument_count_ ? 0 : argument_index_ + 1;
+
+    const IrOperand &value = function[index].arg1;
+
+    if (argument < kArgumentRegisterCount)
+    {
+        WriteLoad(value, "$a" + std::to_string(argument));
+        return;
+    }
+
+    std::string reg = Use(value, "$t8");
+    file_ << "    sw " << reg << ", " << 4 * (argument - kArgumentRegisterCount) << "($sp)\n";
+}
+
+std::string Mips32AsmWriter::Use(const IrOperand &operand, const char *scratch)
+{
+    if (operand.type == IrOperandType::VARIABLE)
+    {
+        std::string reg = GetVariableRegister(operand.value);
+        if (!reg.empty())
+        {
+            return reg;
+        }
+    }
+
+    if (operand.type == IrOperandType::IMMEDIATE && operand.value == 0)
+    {
+        return "$zero";
+    }
+
+    WriteLoad(operand, scratch);
+    return scratch;
+}
+
+void Mips32AsmWriter::WriteLoad(const IrOperand &operand, const std::string &reg)
+{
+    switch (operand.type)
+    {
+    case IrOperandType::IMMEDIATE:
+        file_ << "    li " << reg << ", " << operand.GetImmediateValue() << '\n';
+        break;
+
+    case IrOperandType::VARIABLE:
+    {
+        if (program_info_.IsGlobal(operand))
+        {
+            file_ << "    lw " << reg << ", " << GetGlobalLabel(operand.value) << '\n';
+            break;
+        }
+
+        std::string variable_register = GetVariableRegister(operand.value);
+        if (variable_register.empty())
+        {
+            WriteFrameAccess("lw", reg, spill_offsets_.at(operand.value));
+        }
+        else if (variable_register != reg)
+        {
+            file_ << "    move " << reg << ", " << variable_register << '\n';
+        }
+        break;
+    }
+
+    case IrOperandType::ADDRESS:
+        if (program_info_.IsGlobal(operand))
+        {
+            file_ << "    la " << reg << ", " << GetGlobalLabel(operand.value) << '\n';
+        }
+        else
+        {
+            WriteFrameAddress(reg, dec_offsets_.at(operand.value));
+        }
+        break;
+
+    case IrOperandType::DEREFERENCE:
+    {
+        std::string address = Use(IrOperand::Variable(operand.value), reg.c_str());
+        file_ << "    lw " << reg << ", 0(" << address << ")\n";
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+std::string Mips32AsmWriter::GetDestRegister(const IrOperand &dest) const
+{
+    if (dest.type == IrOperandType::VARIABLE)
+    {
+        std::string reg = GetVariableRegister(dest.value);
+        if (!reg.empty())
+        {
+            return reg;
+        }
+    }
+
+    return "$t8";
+}
+
+void Mips32AsmWriter::WriteDefinition(const IrOperand &dest, const std::string &reg)
+{
+    if (dest.type == IrOperandType::DEREFERENCE)
+    {
+        std::string address = Use(IrOperand::Variable(dest.value), "$t9");
+        file_ << "    sw " << reg << ", 0(" << address << ")\n";
+        return;
+    }
+
+    if (program_info_.IsGlobal(dest))
+    {
+        file_ << "    sw " << reg << ", " << GetGlobalLabel(dest.value) << '\n';
+        return;
+    }
+
+    std::string variable_register = GetVariableRegister(dest.value);
+    if (variable_register.empty())
+    {
+        WriteFrameAccess("sw", reg, spill_offsets_.at(dest.value));
+    }
+    else if (variable_register != reg)
+    {
+        file_ << "    move " << variable_register << ", " << reg << '\n';
+    }
+}
+
+void Mips32AsmWriter::WriteFrameAccess(const char *mnemonic,
+                                       const std::string &reg,
+                                       const int32_t offset)
+{
+    if (IsImmediate16(offset))
+    {
+        file_ << "    " << mnemonic << ' ' << reg << ", " << offset << "($fp)\n";
+        return;
+    }
+
+    file_ << "    li $v1, " << offset << '\n'
+          << "    addu $v1, $v1, $fp\n"
+          << "    " << mnemonic << ' ' << reg << ", 0($v1)\n";
+}
+
+void Mips32AsmWriter::WriteFrameAddress(const std::string &reg, const int32_t offset)
+{
+    if (IsImmediate16(offset))
+    {
+        file_ << "    addiu " << reg << ", $fp, " << offset << '\n';
+        return;
+    }
+
+    file_ << "    li " << reg << ", " << offset << '\n'
+          << "    addu " << reg << ", $fp, " << reg << '\n';
+}
+
+std::string Mips32AsmWriter::GetVariableRegister(const uint32_t variable) const
+{
+    if (program_info_.global_variables.count(variable) > 0)
+    {
+        return "";
+    }
+
+    int reg = allocator_.GetRegister(variable);
+    return reg == LinearScanAllocator::kSpilled ? "" : GetRegisterName(reg);
+}
+
+std::string Mips32AsmWriter::GetFunctionLabel(const InternId name) const
+{
+    std::string function_name = InternerGetString(interner_, name);
+
+    // Keeps C-- functions apart from the runtime and from mnemonics
+    return function_name == "main" ? function_name : "cmm_" + function_name;
+}
+
+std::string Mips32AsmWriter::GetLabel(const IrOperand &label)
+{
+    return "_label" + std::to_string(label.value);
+}
+
+std::string Mips32AsmWriter::GetGlobalLabel(const uint32_t variable)
+{
+    return "_var" + std::to_string(variable);
+}
+
+std::string Mips32AsmWriter::GetRegisterName(const int reg)
+{
+    return reg < static_cast<int>(kCallerSavedCount)
+               ? "$t" + std::to_string(reg)
+               : "$s" + std::to_string(reg - kCallerSavedCount);
+}
+
+const char *Mips32AsmWriter::GetBranchMnemonic(const IrOperator op)
+{
+    switch (op)
+    {
+    case IrOperator::EQ:
+        return "beq";
+    case IrOperator::NE:
+        return "bne";
+    case IrOperator::LT:
+        return "blt";
+    case IrOperator::LE:
+        return "ble";
+    case IrOperator::GT:
+        return "bgt";
+    case IrOperator::GE:
+        return "bge";
+    default:
+        return "";
+    }
+}
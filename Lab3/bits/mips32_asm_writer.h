@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ir_printer.h"
+#include "ir_sink.h"
+#include "spill_report.h"
+#include "passes/ir_pass.h"
+#include "passes/linear_scan_allocator.h"
+
+// Translates IR to MIPS32 assembly for the SPIM and MARS simulators, one
+// function at a time, and writes it to a file together with read() and
+// write() implemented by system calls.
+//
+// Non-global variables get registers from LinearScanAllocator: $t0-$t7,
+// which calls clobber, and $s0-$s7, which functions save. Spilled
+// variables live in the stack frame; $t8, $t9 and $v1 hold their values
+// while an instruction uses them. Global variables are labelled words in
+// .data, arrays and structs (DEC) are on the stack below the spill slots.
+//
+// C-- functions other than main are named cmm_<name>. The first four
+// arguments are passed in $a0-$a3, the rest in the caller's outgoing
+// argument area at 0($sp), 4($sp)... The first PARAM is the first
+// argument, that is the last ARG before the CALL. $fp holds $sp at entry.
+// Floating point values are not supported.
+class Mips32AsmWriter : public IrFileSink
+{
+private:
+    std::ofstream file_;
+    const Interner *interner_;
+    const IrPrinter printer_;
+    std::string line_;
+    bool has_translation_error_;
+    SpillReport *spill_report_;
+
+    IrProgramInfo program_info_;
+    LinearScanAllocator allocator_;
+
+    // State of the function being written
+    std::string function_name_;
+    // Maps spilled variable number to its offset from $fp
+    std::unordered_map<uint32_t, int32_t> spill_offsets_;
+    // Maps DEC variable number to its offset from $fp
+    std::unordered_map<uint32_t, int32_t> dec_offsets_;
+    // The callee-saved registers the function uses and where they are saved
+    std::vector<std::pair<int, int32_t>> saved_register_offsets_;
+    // Argument count and index of the next ARG of the current call
+    size_t argument_count_;
+    size_t argument_index_;
+
+public:
+    Mips32AsmWriter(const std::string &path, const Interner *interner);
+
+    bool IsOpen() const override
+    {
+        return file_.is_open();
+    }
+
+    void Consume(const IrSequence &sequence) override;
+
+    bool Close() override;
+
+    bool GetHasTranslationError() const override
+    {
+        return has_translation_error_;
+    }
+
+    // Records the register allocation of each function if not nullptr
+    void SetSpillReport(SpillReport *spill_report)
+    {
+        spill_report_ = spill_report;
+    }
+
+private:
+    void PrintError(const std::string &message);
+
+    void WriteGlobals(const IrSequence &sequence);
+    void WriteFunction(const IrSequence &function);
+    // Lays out the stack frame. Returns false on unsupported operands.
+    bool AllocateFrame(const IrSequence &function, int32_t &frame_size);
+    void WritePrologue(const IrSequence &function, const int32_t frame_size);
+    void WriteEpilogue();
+    void WriteInstruction(const IrSequence &function, const size_t index);
+    void WriteBinary(const IrInstruction &instruction);
+    void WriteArg(const IrSequence &function, const size_t index);
+
+    // Returns a register holding the value of operand, loading it into
+    // scratch unless it already is in one
+    std::string Use(const IrOperand &operand, const char *scratch);
+    // Loads the value of operand into reg
+    void WriteLoad(const IrOperand &operand, const std::string &reg);
+    // Returns the register the value for dest should be computed into
+    std::string GetDestRegister(const IrOperand &dest) const;
+    // Moves the value computed into reg to dest, using $t9 for addresses
+    void WriteDefinition(const IrOperand &dest, const std::string &reg);
+    // Writes lw or sw between reg and offset($fp), for offsets of any size
+    void WriteFrameAccess(const char *mnemonic, const std::string &reg, const int32_t offset);
+    // Writes reg := $fp + offset, for offsets of any size
+    void WriteFrameAddress(const std::string &reg, const int32_t offset);
+
+    // Returns the register of a non-global variable, or an empty string
+    std::string GetVariableRegister(const uint32_t variable) const;
+
+    std::string GetFunctionLabel(const InternId name) const;
+    static std::string GetLabel(const IrOperand &label);
+    static std::string GetGlobalLabel(const uint32_t variable);
+    static std::string GetRegisterName(const int reg);
+    static const char *GetBranchMnemonic(const IrOperator op);
+    static bool IsImmediate16(const int64_t value)
+    {
+        return value >= -32768 && value <= 32767;
+    }
+};
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "optimization_report.h"
+
+void OptimizationReport::BeginFunction(const std::string &name)
+{
+    functions_.push_back({name, {}});
+}
+
+void OptimizationReport::AddPass(const std::string &name,
+                                 const IrSize &before,
+                                 const IrSize &after)
+{
+    functions_.back().passes.push_back({name, before, after});
+}
+
+void OptimizationReport::PrintTextRow(std::ostream &stream,
+                                      const size_t name_width,
+                                      const std::string &name,
+                                      const IrSize &before,
+                                      const IrSize &after)
+{
+    auto format_change = [](const size_t before, const size_t after)
+    {
+        std::ostringstream change;
+        change << before << " -> " << after;
+        // Unchanged counts get no delta, so that the passes that did
+        // something stand out
+        if (after > before)
+        {
+            change << " (+" << after - before << ')';
+        }
+        else if (after < before)
+        {
+            change << " (-" << before - after << ')';
+        }
+        return change.str();
+    };
+
+    stream << std::left << std::setw(name_width) << name
+           << std::setw(26) << format_change(before.instruction_count, after.instruction_count)
+           << std::setw(26) << format_change(before.variable_count, after.variable_count)
+           << format_change(before.max_live_count, after.max_live_count)
+           << '\n';
+}
+
+void OptimizationReport::PrintText(std::ostream &stream) const
+{
+    IrSize total_before = {0, 0, 0};
+    IrSize total_after = {0, 0, 0};
+
+    // Wide enough for the longest function or indented pass name
+    size_t name_width = 28;
+    for (auto &function : functions_)
+    {
+        name_width = std::max(name_width, function.name.size() + 2);
+        for (auto &pass : function.passes)
+        {
+            name_width = std::max(name_width, pass.name.size() + 4);
+        }
+    }
+
+    stream << "[Optimization Report] " << input_path_ << '\n'
+           << std::left << std::setw(name_width) << "Function/Pass"
+           << std::setw(26) << "Instructions"
+           << std::setw(26) << "Variables"
+           << "Max live"
+           << '\n';
+
+    for (auto &function : functions_)
+    {
+        if (function.passes.empty())
+        {
+            continue;
+        }
+
+        const IrSize &before = function.passes.front().before;
+        const IrSize &after = function.passes.back().after;
+
+        PrintTextRow(stream, name_width, function.name, before, after);
+
+        for (auto &pass : function.passes)
+        {
+            PrintTextRow(stream, name_width, "  " + pass.name, pass.before, pass.after);
+        }
+
+        total_before.instruction_count += before.instruction_count;
+        total_before.variable_count += before.variable_count;
+        total_after.instruction_count += after.instruction_count;
+        total_after.variable_count += after.variable_count;
+        // Functions do not run at once, so the total is the largest
+        total_before.max_live_count = std::max(total_before.max_live_count,
+                                               before.max_live_count);
+        total_after.max_live_count = std::max(total_after.max_live_count,
+                                              after.max_live_count);
+    }
+
+    PrintTextRow(stream, name_width, "Total", total_before, total_after);
+    stream.flush();
+}
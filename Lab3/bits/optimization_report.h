@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Size of a function's IR at some point of the optimization pipeline
+struct IrSize
+{
+    size_t instruction_count;
+    // Distinct IR variables, temporaries and source variables alike
+    size_t variable_count;
+    // Most local variables live at once at any point
+    size_t max_live_count;
+};
+
+// Collects what each optimization pass removed from each function of one
+// compilation and prints it as a table.
+class OptimizationReport
+{
+private:
+    struct PassMeasurement
+    {
+        std::string name;
+        IrSize before;
+        IrSize after;
+    };
+
+    struct FunctionMeasurement
+    {
+        std::string name;
+        std::vector<PassMeasurement> passes;
+    };
+
+    const std::string input_path_;
+
+    std::vector<FunctionMeasurement> functions_;
+
+public:
+    explicit OptimizationReport(const std::string &input_path)
+        : input_path_(input_path) {}
+
+    void BeginFunction(const std::string &name);
+    // Records a pass run on the function of the last BeginFunction()
+    void AddPass(const std::string &name, const IrSize &before, const IrSize &after);
+
+    void PrintText(std::ostream &stream) const;
+
+private:
+    static void PrintTextRow(std::ostream &stream,
+                             const size_t name_width,
+                             const std::string &name,
+                             const IrSize &before,
+                             const IrSize &after);
+};
@@ -0,0 +1,293 @@
+#include <tuple>
+#include <utility>
+
+#include "ir_operands.h"
+#include "control_flow_graph.h"
+#include "common_subexpression_elimination_pass.h"
+
+size_t CommonSubexpressionEliminationPass::ExpressionHash::operator()(
+    const Expression &expression) const
+{
+    size_t hash = static_cast<size_t>(expression.op);
+
+    for (auto operand : {&expression.arg1, &expression.arg2})
+    {
+        hash = hash * 31 + static_cast<size_t>(operand->type);
+        hash = hash * 31 + operand->value;
+        hash = hash * 31 + operand->lexeme;
+    }
+
+    return hash;
+}
+
+bool CommonSubexpressionEliminationPass::Run(IrSequence &function,
+                                             const IrProgramInfo &program_info)
+{
+    bool is_changed = false;
+
+    // Only rewrites instructions in place, so the graph stays valid
+    ControlFlowGraph cfg(function);
+
+    for (auto &block : cfg.GetBlocks())
+    {
+        Clear();
+
+        for (size_t i = block.begin; i < block.end; i++)
+        {
+            IrInstruction &instruction = function[i];
+
+            Expression expression;
+            bool is_expression = GetExpression(instruction, program_info, expression);
+
+            if (is_expression)
+            {
+                auto available_expression = available_expressions_.find(expression);
+                if (available_expression != available_expressions_.end())
+                {
+                    bool is_held_by_dest = available_expression->second == instruction.dest.value;
+
+                    // x := y, or x := x for dead code elimination to remove
+                    instruction.opcode = IrOpcode::ASSIGN;
+                    instruction.op = IrOperator::NONE;
+                    instruction.arg1 = IrOperand::Variable(available_expression->second);
+                    instruction.arg2 = IrOperand::None();
+                    is_changed = true;
+
+                    if (is_held_by_dest)
+                    {
+                        continue;
+                    }
+
+                    is_expression = false;
+                }
+            }
+
+            if (instruction.dest.type == IrOperandType::DEREFERENCE ||
+                instruction.opcode == IrOpcode::CALL)
+            {
+                KillLoads();
+            }
+
+            const IrOperand *defined_variable = GetDefinedVariable(instruction);
+            if (defined_variable != nullptr)
+            {
+                Kill(defined_variable->value);
+            }
+
+            if (defined_variable == nullptr)
+            {
+                continue;
+            }
+
+            // x := x + 1 does not hold x + 1 afterwards, nor x := *x the
+            // value at the address x held before
+            if (is_expression &&
+                !IsOperandOf(expression.arg1, defined_variable->value) &&
+                !IsOperandOf(expression.arg2, defined_variable->value))
+            {
+                Record(expression, instruction.dest.value);
+            }
+            else if (instruction.opcode == IrOpcode::ASSIGN &&
+                     instruction.arg1.type == IrOperandType::VARIABLE &&
+                     !program_info.IsGlobal(instruction.dest) &&
+                     !program_info.IsGlobal(instruction.arg1))
+            {
+                IrOperand source = GetValueNumber(instruction.arg1);
+                if (source.value != instruction.dest.value)
+                {
+                    RecordCopy(instruction.dest.value, source.value);
+                }
+            }
+        }
+    }
+
+    Clear();
+
+    return is_changed;
+}
+
+void CommonSubexpressionEliminationPass::Clear()
+{
+    available_expressions_.clear();
+    variable_uses_.clear();
+    variable_holdings_.clear();
+    loads_.clear();
+    copy_sources_.clear();
+    copy_holders_.clear();
+}
+
+bool CommonSubexpressionEliminationPass::GetExpression(const IrInstruction &instruction,
+                                                       const IrProgramInfo &program_info,
+                                                       Expression &expression) const
+{
+    // Globals may be changed by any call, so neither hold nor read them
+    if (instruction.dest.type != IrOperandType::VARIABLE ||
+        program_info.IsGlobal(instruction.dest) ||
+        program_info.IsGlobal(instruction.arg1) ||
+        program_info.IsGlobal(instruction.arg2))
+    {
+        return false;
+    }
+
+    switch (instruction.opcode)
+    {
+    case IrOpcode::ASSIGN:
+        // Copies and immediates are left to the other passes
+        if (instruction.arg1.type != IrOperandType::ADDRESS &&
+            instruction.arg1.type != IrOperandType::DEREFERENCE)
+        {
+            return false;
+        }
+
+        expression = {IrOperator::NONE,
+                      GetValueNumber(instruction.arg1),
+                      IrOperand::None()};
+        return true;
+    case IrOpcode::BINARY:
+        // Floating point operands are rare and compared by lexeme only
+        if (instruction.arg1.type == IrOperandType::FLOAT_IMMEDIATE ||
+            instruction.arg2.type == IrOperandType::FLOAT_IMMEDIATE)
+        {
+            return false;
+        }
+
+        expression = {instruction.op,
+                      GetValueNumber(instruction.arg1),
+                      GetValueNumber(instruction.arg2)};
+
+        if (instruction.op == IrOperator::ADD || instruction.op == IrOperator::MUL)
+        {
+            auto order = [](const IrOperand &operand)
+            {
+                return std::make_tuple(operand.type, operand.value, operand.lexeme);
+            };
+
+            if (order(expression.arg2) < order(expression.arg1))
+            {
+                std::swap(expression.arg1, expression.arg2);
+            }
+        }
+
+        return true;
+    default:
+        return false;
+    }
+}
+
+IrOperand CommonSubexpressionEliminationPass::GetValueNumber(const IrOperand &operand) const
+{
+    // &v names v itself rather than its value
+    if (operand.type != IrOperandType::VARIABLE &&
+        operand.type != IrOperandType::DEREFERENCE)
+    {
+        return operand;
+    }
+
+    auto copy_source = copy_sources_.find(operand.value);
+    if (copy_source == copy_sources_.end())
+    {
+        return operand;
+    }
+
+    IrOperand value_number = operand;
+    value_number.value = copy_source->second;
+
+    return value_number;
+}
+
+void CommonSubexpressionEliminationPass::Kill(const uint32_t variable)
+{
+    auto uses = variable_uses_.find(variable);
+    if (uses != variable_uses_.end())
+    {
+        // Any expression equal to one listed still reads variable
+        for (auto &expression : uses->second)
+        {
+            available_expressions_.erase(expression);
+        }
+
+        variable_uses_.erase(uses);
+    }
+
+    auto holdings = variable_holdings_.find(variable);
+    if (holdings != variable_holdings_.end())
+    {
+        for (auto &expression : holdings->second)
+        {
+            auto available_expression = available_expressions_.find(expression);
+            if (available_expression != available_expressions_.end() &&
+                available_expression->second == variable)
+            {
+                available_expressions_.erase(available_expression);
+            }
+        }
+
+        variable_holdings_.erase(holdings);
+    }
+
+    copy_sources_.erase(variable);
+
+    auto copy_holders = copy_holders_.find(variable);
+    if (copy_holders != copy_holders_.end())
+    {
+        for (uint32_t holder : copy_holders->second)
+        {
+            auto copy_source = copy_sources_.find(holder);
+            if (copy_source != copy_sources_.end() && copy_source->second == variable)
+            {
+                copy_sources_.erase(copy_source);
+            }
+        }
+
+        copy_holders_.erase(copy_holders);
+    }
+}
+
+void CommonSubexpressionEliminationPass::KillLoads()
+{
+    for (auto &expression : loads_)
+    {
+        available_expressions_.erase(expression);
+    }
+
+    loads_.clear();
+}
+
+void CommonSubexpressionEliminationPass::Record(const Expression &expression,
+                                                const uint32_t holder)
+{
+    available_expressions_[expression] = holder;
+    variable_holdings_[holder].push_back(expression);
+
+    bool is_load = false;
+
+    for (auto operand : {&expression.arg1, &expression.arg2})
+    {
+        // &v does not read v, but the value of v never changes its address
+        if (operand->type == IrOperandType::VARIABLE ||
+            operand->type == IrOperandType::DEREFERENCE)
+        {
+            variable_uses_[operand->value].push_back(expression);
+        }
+
+        is_load |= operand->type == IrOperandType::DEREFERENCE;
+    }
+
+    if (is_load)
+    {
+        loads_.push_back(expression);
+    }
+}
+
+bool CommonSubexpressionEliminationPass::IsOperandOf(const IrOperand &operand,
+                                                     const uint32_t variable)
+{
+    return operand.IsVariableBased() && operand.value == variable;
+}
+
+void CommonSubexpressionEliminationPass::RecordCopy(const uint32_t holder,
+                                                    const uint32_t source)
+{
+    copy_sources_[holder] = source;
+    copy_holders_[source].push_back(holder);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ir_pass.h"
+
+// Local common subexpression elimination.
+// Within each basic block, remembers which local variable holds the result
+// of each binary operation, address (&v) and load (*p) computed so far.
+// Recomputing one while its operands and its holder are unchanged becomes a
+// copy of the holder, which copy propagation then forwards. This mostly
+// removes repeated address arithmetic, as in a[i][j] = a[i][j] + 1.
+// Operands are compared by value number: a variable copied from another
+// one (x := y) counts as that variable, so t2 := #4 * i; t3 := t2 + #8
+// matches t0 := #4 * i; t1 := t0 + #8.
+// Loads are forgotten at every store and call, since any of them may
+// write the memory read.
+class CommonSubexpressionEliminationPass : public IrPass
+{
+private:
+    // The right-hand side of an ASSIGN or BINARY. Commutative operations
+    // are stored with their operands in a fixed order.
+    struct Expression
+    {
+        IrOperator op;
+        IrOperand arg1;
+        IrOperand arg2;
+
+        bool operator==(const Expression &other) const
+        {
+            return op == other.op && arg1 == other.arg1 && arg2 == other.arg2;
+        }
+    };
+
+    struct ExpressionHash
+    {
+        size_t operator()(const Expression &expression) const;
+    };
+
+    // Maps expression to the variable holding its value
+    std::unordered_map<Expression, uint32_t, ExpressionHash> available_expressions_;
+    // Maps variable number to the expressions reading it. May hold
+    // expressions already forgotten, each is looked up again when killed.
+    std::unordered_map<uint32_t, std::vector<Expression>> variable_uses_;
+    // Maps variable number to the expressions it has held
+    std::unordered_map<uint32_t, std::vector<Expression>> variable_holdings_;
+    // Expressions reading memory
+    std::vector<Expression> loads_;
+    // Maps variable number to the variable it currently is a copy of
+    std::unordered_map<uint32_t, uint32_t> copy_sources_;
+    // Maps variable number to the variables that have been copies of it
+    std::unordered_map<uint32_t, std::vector<uint32_t>> copy_holders_;
+
+public:
+    const char *GetName() const override
+    {
+        return "common-subexpression-elimination";
+    }
+
+    bool Run(IrSequence &function, const IrProgramInfo &program_info) override;
+
+private:
+    void Clear();
+    // Returns whether instruction computes an expression worth remembering,
+    // in which case it is stored to expression
+    bool GetExpression(const IrInstruction &instruction,
+                       const IrProgramInfo &program_info,
+                       Expression &expression) const;
+    // Returns operand with its variable replaced by the one it is a copy of
+    IrOperand GetValueNumber(const IrOperand &operand) const;
+    // Forgets every expression reading variable or held by it
+    void Kill(const uint32_t variable);
+    void KillLoads();
+    void Record(const Expression &expression, const uint32_t holder);
+    void RecordCopy(const uint32_t holder, const uint32_t source);
+
+    // Whether operand is variable, &variable or *variable
+    static bool IsOperandOf(const IrOperand &operand, const uint32_t variable);
+};
@@ -0,0 +1,289 @@
+#include <climits>
+
+#include "ir_operands.h"
+#include "dead_code_elimination_pass.h"
+#include "constant_folding_pass.h"
+
+bool ConstantFoldingPass::Run(IrSequence &function, const IrProgramInfo &program_info)
+{
+    bool is_changed = false;
+    bool is_branch_folded = true;
+
+    // Removing a branch may leave a label with fewer incoming jumps,
+    // so that more constants survive it in the next walk
+    while (is_branch_folded)
+    {
+        is_branch_folded = false;
+        is_changed |= RunOnce(function, program_info, is_branch_folded);
+    }
+
+    return is_changed;
+}
+
+bool ConstantFoldingPass::RunOnce(IrSequence &function,
+                                  const IrProgramInfo &program_info,
+                                  bool &is_branch_folded)
+{
+    constants_.clear();
+    label_joins_.Count(function);
+
+    bool is_changed = false;
+    size_t kept_count = 0;
+
+    for (size_t i = 0; i < function.size(); i++)
+    {
+        IrInstruction instruction = function[i];
+
+        if (instruction.opcode == IrOpcode::LABEL &&
+            label_joins_.IsJoin(instruction,
+                                kept_count > 0 ? &function[kept_count - 1] : nullptr))
+        {
+            constants_.clear();
+        }
+
+        ForEachUsedOperand(instruction,
+                           [this, &is_changed](IrOperand &operand)
+                           {
+                               is_changed |= Propagate(operand);
+                           });
+
+        bool is_removed = false;
+        if (Fold(instruction, is_removed))
+        {
+            is_changed = true;
+            is_branch_folded |= instruction.opcode == IrOpcode::GOTO || is_removed;
+        }
+
+        if (is_removed)
+        {
+            continue;
+        }
+
+        RecordDefinition(instruction, program_info);
+
+        function[kept_count++] = instruction;
+    }
+
+    function.resize(kept_count);
+
+    if (is_branch_folded)
+    {
+        DeadCodeEliminationPass::RemoveUnreachableBlocks(function);
+    }
+
+    return is_changed;
+}
+
+bool ConstantFoldingPass::Evaluate(const IrOperator op,
+                                   const int32_t left,
+                                   const int32_t right,
+                                   int32_t &result)
+{
+    // Wrap around like the 32-bit ints of the target
+    auto wrap = [](const int64_t value)
+    {
+        return static_cast<int32_t>(static_cast<uint32_t>(value));
+    };
+
+    switch (op)
+    {
+    case IrOperator::ADD:
+        result = wrap(static_cast<int64_t>(left) + right);
+        return true;
+    case IrOperator::SUB:
+        result = wrap(static_cast<int64_t>(left) - right);
+        return true;
+    case IrOperator::MUL:
+        result = wrap(static_cast<int64_t>(left) * right);
+        return true;
+    case IrOperator::DIV:
+        // Leave the fault to run time
+        if (right == 0 || (left == INT32_MIN && right == -1))
+        {
+            return false;
+        }
+        result = left / right;
+        return true;
+    case IrOperator::EQ:
+        result = left == right;
+        return true;
+    case IrOperator::NE:
+        result = left != right;
+        return true;
+    case IrOperator::LT:
+        result = left < right;
+        return true;
+    case IrOperator::LE:
+        result = left <= right;
+        return true;
+    case IrOperator::GT:
+        result = left > right;
+        return true;
+    case IrOperator::GE:
+        result = left >= right;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ConstantFoldingPass::Propagate(IrOperand &operand) const
+{
+    if (operand.type != IrOperandType::VARIABLE)
+    {
+        return false;
+    }
+
+    auto constant = constants_.find(operand.value);
+    if (constant == constants_.end())
+    {
+        return false;
+    }
+
+    operand = constant->second;
+    return true;
+}
+
+bool ConstantFoldingPass::Fold(IrInstruction &instruction, bool &is_removed) const
+{
+    const bool is_arg1_int = instruction.arg1.type == IrOperandType::IMMEDIATE;
+    const bool is_arg2_int = instruction.arg2.type == IrOperandType::IMMEDIATE;
+
+    int32_t result;
+
+    if (instruction.opcode == IrOpcode::IF)
+    {
+        if (!is_arg1_int || !is_arg2_int ||
+            !Evaluate(instruction.op,
+                      instruction.arg1.GetImmediateValue(),
+                      instruction.arg2.GetImmediateValue(),
+                      result))
+        {
+            return false;
+        }
+
+        if (result)
+        {
+            instruction = {IrOpcode::GOTO,
+                           IrOperator::NONE,
+                           instruction.dest,
+                           IrOperand::None(),
+                           IrOperand::None()};
+        }
+        else
+        {
+            is_removed = true;
+        }
+
+        return true;
+    }
+
+    if (instruction.opcode != IrOpcode::BINARY)
+    {
+        return false;
+    }
+
+    auto make_assign = [&instruction](const IrOperand &value)
+    {
+        instruction = {IrOpcode::ASSIGN,
+                       IrOperator::NONE,
+                       instruction.dest,
+                       value,
+                       IrOperand::None()};
+    };
+
+    if (is_arg1_int && is_arg2_int)
+    {
+        if (!Evaluate(instruction.op,
+                      instruction.arg1.GetImmediateValue(),
+                      instruction.arg2.GetImmediateValue(),
+                      result))
+        {
+            return false;
+        }
+
+        make_assign(IrOperand::Immediate(result));
+        return true;
+    }
+
+    // Algebraic identities with one constant operand.
+    // Type checking guarantees the other operand is an int or an address.
+    auto is_immediate = [](const IrOperand &operand, const int32_t value)
+    {
+        return operand.type == IrOperandType::IMMEDIATE &&
+               operand.GetImmediateValue() == value;
+    };
+
+    const IrOperand &arg1 = instruction.arg1;
+    const IrOperand &arg2 = instruction.arg2;
+
+    switch (instruction.op)
+    {
+    case IrOperator::ADD:
+        if (is_immediate(arg2, 0))
+        {
+            make_assign(arg1);
+            return true;
+        }
+        if (is_immediate(arg1, 0))
+        {
+            make_assign(arg2);
+            return true;
+        }
+        return false;
+    case IrOperator::SUB:
+        if (is_immediate(arg2, 0))
+        {
+            make_assign(arg1);
+            return true;
+        }
+        return false;
+    case IrOperator::MUL:
+        if (is_immediate(arg1, 0) || is_immediate(arg2, 0))
+        {
+            make_assign(IrOperand::Immediate(0));
+            return true;
+        }
+        if (is_immediate(arg2, 1))
+        {
+            make_assign(arg1);
+            return true;
+        }
+        if (is_immediate(arg1, 1))
+        {
+            make_assign(arg2);
+            return true;
+        }
+        return false;
+    case IrOperator::DIV:
+        if (is_immediate(arg2, 1))
+        {
+            make_assign(arg1);
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+void ConstantFoldingPass::RecordDefinition(const IrInstruction &instruction,
+                                           const IrProgramInfo &program_info)
+{
+    const IrOperand *defined_variable = GetDefinedVariable(instruction);
+    if (defined_variable == nullptr || program_info.IsGlobal(*defined_variable))
+    {
+        return;
+    }
+
+    if (instruction.opcode == IrOpcode::ASSIGN &&
+        (instruction.arg1.type == IrOperandType::IMMEDIATE ||
+         instruction.arg1.type == IrOperandType::FLOAT_IMMEDIATE))
+    {
+        constants_[defined_variable->value] = instruction.arg1;
+    }
+    else
+    {
+        constants_.erase(defined_variable->value);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "ir_pass.h"
+#include "label_joins.h"
+
+// Constant folding and propagation.
+// Walks each function once, remembering which local variables currently hold
+// an immediate. Uses of such variables are replaced by the immediate, integer
+// binary operations on two immediates are evaluated and IFs whose condition
+// becomes constant turn into a GOTO or disappear, after which the code they
+// no longer reach is removed.
+// Knowledge is dropped at a LABEL if another path may join there, that is
+// unless it is only reached by falling through or by the GOTO right before it.
+class ConstantFoldingPass : public IrPass
+{
+private:
+    // Maps variable number to the IMMEDIATE or FLOAT_IMMEDIATE it holds
+    std::unordered_map<uint32_t, IrOperand> constants_;
+    LabelJoins label_joins_;
+
+public:
+    const char *GetName() const override
+    {
+        return "constant-folding";
+    }
+
+    bool Run(IrSequence &function, const IrProgramInfo &program_info) override;
+
+    // Evaluates left op right as C would on 32-bit ints.
+    // Returns false if it cannot be done at compile time (division by zero).
+    static bool Evaluate(const IrOperator op,
+                         const int32_t left,
+                         const int32_t right,
+                         int32_t &result);
+
+private:
+    // One walk over function. Sets is_branch_folded if an IF became constant.
+    bool RunOnce(IrSequence &function,
+                 const IrProgramInfo &program_info,
+                 bool &is_branch_folded);
+    bool Propagate(IrOperand &operand) const;
+    // Returns whether instruction changed. Sets is_removed if it should be deleted.
+    bool Fold(IrInstruction &instruction, bool &is_removed) const;
+    void RecordDefinition(const IrInstruction &instruction,
+                          const IrProgramInfo &program_info);
+};
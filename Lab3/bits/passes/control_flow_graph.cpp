@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <utility>
+
+#include "ir_operands.h"
+#include "control_flow_graph.h"
+
+ControlFlowGraph::ControlFlowGraph(const IrSequence &function)
+    : function_(function)
+{
+    SplitBlocks();
+    LinkBlocks();
+    ComputeReversePostorder();
+}
+
+void ControlFlowGraph::SplitBlocks()
+{
+    size_t begin = 0;
+
+    for (size_t i = 0; i < function_.size(); i++)
+    {
+        const IrInstruction &instruction = function_[i];
+
+        if (instruction.opcode == IrOpcode::LABEL)
+        {
+            if (i > begin)
+            {
+                blocks_.push_back({begin, i, {}, {}});
+                begin = i;
+            }
+
+            label_blocks_[instruction.dest.value] = blocks_.size();
+        }
+
+        if (IsJump(instruction) || instruction.opcode == IrOpcode::RETURN)
+        {
+            blocks_.push_back({begin, i + 1, {}, {}});
+            begin = i + 1;
+        }
+    }
+
+    if (begin < function_.size())
+    {
+        blocks_.push_back({begin, function_.size(), {}, {}});
+    }
+}
+
+void ControlFlowGraph::LinkBlocks()
+{
+    for (size_t i = 0; i < blocks_.size(); i++)
+    {
+        const IrInstruction &last_instruction = GetLastInstruction(i);
+
+        if (!EndsControlFlow(last_instruction) && i + 1 < blocks_.size())
+        {
+            AddEdge(i, i + 1);
+        }
+
+        if (IsJump(last_instruction))
+        {
+            AddEdge(i, GetLabelBlock(last_instruction.dest.value));
+        }
+    }
+}
+
+void ControlFlowGraph::AddEdge(const size_t from, const size_t to)
+{
+    // IF x GOTO L right before LABEL L reaches the same block both ways
+    auto &successors = blocks_[from].successors;
+    if (std::find(successors.begin(), successors.end(), to) != successors.end())
+    {
+        return;
+    }
+
+    successors.push_back(to);
+    blocks_[to].predecessors.push_back(from);
+}
+
+void ControlFlowGraph::ComputeReversePostorder()
+{
+    is_reachable_.assign(blocks_.size(), false);
+
+    if (blocks_.empty())
+    {
+        return;
+    }
+
+    // Iterative depth-first search, so that deeply nested code cannot
+    // overflow the stack. Each entry holds a block and the index of its
+    // next successor to visit.
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.push_back({0, 0});
+    is_reachable_[0] = true;
+
+    while (!stack.empty())
+    {
+        auto &[block, next_successor] = stack.back();
+        const auto &successors = blocks_[block].successors;
+
+        if (next_successor == successors.size())
+        {
+            reverse_postorder_.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+
+        size_t successor = successors[next_successor++];
+        if (!is_reachable_[successor])
+        {
+            is_reachable_[successor] = true;
+            stack.push_back({successor, 0});
+        }
+    }
+
+    std::reverse(reverse_postorder_.begin(), reverse_postorder_.end());
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../ir_instruction.h"
+
+// A maximal run of instructions entered only at its first instruction and
+// left only after its last one. Instructions are referred to by their
+// index in the function the graph was built from.
+struct BasicBlock
+{
+    // Instructions [begin, end) of the function
+    size_t begin;
+    size_t end;
+
+    // Block indices. An IF block lists its fall-through successor first.
+    std::vector<size_t> predecessors;
+    std::vector<size_t> successors;
+};
+
+// Splits the IR of one function into basic blocks linked by the jumps and
+// fall-throughs between them. Block 0 is the entry block, starting with the
+// FUNCTION instruction. A new block starts at every LABEL and after every
+// GOTO, IF and RETURN.
+// The graph refers to instructions by index, so it must be rebuilt after
+// instructions are inserted into or removed from the function.
+class ControlFlowGraph
+{
+private:
+    const IrSequence &function_;
+
+    std::vector<BasicBlock> blocks_;
+    // Maps label number to the block it starts
+    std::unordered_map<uint32_t, size_t> label_blocks_;
+    // Blocks reachable from the entry block, in reverse postorder
+    std::vector<size_t> reverse_postorder_;
+    std::vector<bool> is_reachable_;
+
+public:
+    explicit ControlFlowGraph(const IrSequence &function);
+
+    ControlFlowGraph(const ControlFlowGraph &) = delete;
+    ControlFlowGraph &operator=(const ControlFlowGraph &) = delete;
+
+    const IrSequence &GetFunction() const
+    {
+        return function_;
+    }
+
+    size_t GetBlockCount() const
+    {
+        return blocks_.size();
+    }
+
+    const BasicBlock &GetBlock(const size_t index) const
+    {
+        return blocks_[index];
+    }
+
+    const std::vector<BasicBlock> &GetBlocks() const
+    {
+        return blocks_;
+    }
+
+    // Returns the index of the block starting with LABEL label
+    size_t GetLabelBlock(const uint32_t label) const
+    {
+        return label_blocks_.at(label);
+    }
+
+    const IrInstruction &GetLastInstruction(const size_t index) const
+    {
+        return function_[blocks_[index].end - 1];
+    }
+
+    // Every block reachable from the entry block comes after all of its
+    // predecessors except those reaching it through a loop back edge.
+    // Unreachable blocks are left out.
+    const std::vector<size_t> &GetReversePostorder() const
+    {
+        return reverse_postorder_;
+    }
+
+    bool IsReachable(const size_t index) const
+    {
+        return is_reachable_[index];
+    }
+
+private:
+    void SplitBlocks();
+    void LinkBlocks();
+    void AddEdge(const size_t from, const size_t to);
+    void ComputeReversePostorder();
+};
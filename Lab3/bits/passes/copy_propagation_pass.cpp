@@ -0,0 +1,128 @@
+#include "ir_operands.h"
+#include "dead_code_elimination_pass.h"
+#include "copy_propagation_pass.h"
+
+bool CopyPropagationPass::Run(IrSequence &function, const IrProgramInfo &program_info)
+{
+    copies_.clear();
+    copy_holders_.clear();
+    label_joins_.Count(function);
+
+    bool is_changed = false;
+
+    for (size_t i = 0; i < function.size(); i++)
+    {
+        IrInstruction &instruction = function[i];
+
+        if (instruction.opcode == IrOpcode::LABEL &&
+            label_joins_.IsJoin(instruction, i > 0 ? &function[i - 1] : nullptr))
+        {
+            copies_.clear();
+            copy_holders_.clear();
+        }
+
+        ForEachUsedOperand(instruction,
+                           [this, &is_changed](IrOperand &operand)
+                           {
+                               is_changed |= Propagate(operand);
+                           });
+
+        RecordDefinition(instruction, program_info);
+    }
+
+    is_changed |= DeadCodeEliminationPass::RemoveDeadAssignments(function, program_info);
+
+    return is_changed;
+}
+
+bool CopyPropagationPass::Propagate(IrOperand &operand) const
+{
+    if (operand.type != IrOperandType::VARIABLE &&
+        operand.type != IrOperandType::DEREFERENCE)
+    {
+        return false;
+    }
+
+    auto copy = copies_.find(operand.value);
+    if (copy == copies_.end())
+    {
+        return false;
+    }
+
+    if (operand.type == IrOperandType::VARIABLE)
+    {
+        operand = copy->second;
+        return true;
+    }
+
+    // *x with x := &y would be y itself, but y is an array or a struct
+    // and never accessed without an offset, so only *x with x := y is rewritten
+    if (copy->second.type != IrOperandType::VARIABLE)
+    {
+        return false;
+    }
+
+    operand.value = copy->second.value;
+    return true;
+}
+
+void CopyPropagationPass::Kill(const uint32_t variable)
+{
+    auto copy = copies_.find(variable);
+    if (copy != copies_.end())
+    {
+        // Stale entries in copy_holders_ are tolerated and checked below
+        copies_.erase(copy);
+    }
+
+    auto holders = copy_holders_.find(variable);
+    if (holders == copy_holders_.end())
+    {
+        return;
+    }
+
+    for (auto holder : holders->second)
+    {
+        auto holder_copy = copies_.find(holder);
+        if (holder_copy != copies_.end() &&
+            holder_copy->second.type == IrOperandType::VARIABLE &&
+            holder_copy->second.value == variable)
+        {
+            copies_.erase(holder_copy);
+        }
+    }
+
+    copy_holders_.erase(holders);
+}
+
+void CopyPropagationPass::RecordDefinition(const IrInstruction &instruction,
+                                           const IrProgramInfo &program_info)
+{
+    const IrOperand *defined_variable = GetDefinedVariable(instruction);
+    if (defined_variable == nullptr)
+    {
+        return;
+    }
+
+    Kill(defined_variable->value);
+
+    if (instruction.opcode != IrOpcode::ASSIGN || program_info.IsGlobal(*defined_variable))
+    {
+        return;
+    }
+
+    const IrOperand &source = instruction.arg1;
+
+    // The value of an address never changes
+    if (source.type == IrOperandType::ADDRESS)
+    {
+        copies_[defined_variable->value] = source;
+    }
+    else if (source.type == IrOperandType::VARIABLE &&
+             !program_info.IsGlobal(source) &&
+             source.value != defined_variable->value)
+    {
+        copies_[defined_variable->value] = source;
+        copy_holders_[source.value].push_back(defined_variable->value);
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ir_pass.h"
+#include "label_joins.h"
+
+// Copy propagation and dead assignment removal.
+// Walking each function top to bottom, uses of a local variable that holds
+// a copy of another local variable or of an address (x := y, x := &y) are
+// rewritten to use the source directly, until either side is redefined or
+// paths join at a LABEL. Assignments whose variable is then never read in
+// the function are deleted, and unread CALL results are dropped.
+class CopyPropagationPass : public IrPass
+{
+private:
+    // Maps variable number to the VARIABLE or ADDRESS operand it is a copy of
+    std::unordered_map<uint32_t, IrOperand> copies_;
+    // Maps variable number to the variables currently holding a copy of it
+    std::unordered_map<uint32_t, std::vector<uint32_t>> copy_holders_;
+    LabelJoins label_joins_;
+
+public:
+    const char *GetName() const override
+    {
+        return "copy-propagation";
+    }
+
+    bool Run(IrSequence &function, const IrProgramInfo &program_info) override;
+
+private:
+    bool Propagate(IrOperand &operand) const;
+    // Forgets every copy variable is part of
+    void Kill(const uint32_t variable);
+    void RecordDefinition(const IrInstruction &instruction,
+                          const IrProgramInfo &program_info);
+};
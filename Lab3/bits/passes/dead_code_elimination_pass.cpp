@@ -0,0 +1,222 @@
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ir_operands.h"
+#include "control_flow_graph.h"
+#include "dead_code_elimination_pass.h"
+
+bool DeadCodeEliminationPass::Run(IrSequence &function, const IrProgramInfo &program_info)
+{
+    bool is_changed = false;
+    bool is_round_changed = true;
+
+    // E.g. dropping a jump to the next label may leave that label unused,
+    // which may in turn place another jump right before its target
+    while (is_round_changed)
+    {
+        is_round_changed = RemoveUnreachableBlocks(function);
+        is_round_changed |= RemoveJumpsToNext(function);
+        is_round_changed |= RemoveUnusedLabels(function);
+        is_changed |= is_round_changed;
+    }
+
+    is_changed |= RemoveDeadAssignments(function, program_info);
+
+    return is_changed;
+}
+
+bool DeadCodeEliminationPass::RemoveUnreachableBlocks(IrSequence &function)
+{
+    std::vector<bool> is_kept(function.size(), true);
+    bool is_changed = false;
+
+    {
+        ControlFlowGraph cfg(function);
+
+        for (size_t i = 0; i < cfg.GetBlockCount(); i++)
+        {
+            if (cfg.IsReachable(i))
+            {
+                continue;
+            }
+
+            const BasicBlock &block = cfg.GetBlock(i);
+            for (size_t j = block.begin; j < block.end; j++)
+            {
+                is_kept[j] = false;
+            }
+
+            is_changed = true;
+        }
+    }
+
+    if (!is_changed)
+    {
+        return false;
+    }
+
+    size_t kept_count = 0;
+    for (size_t i = 0; i < function.size(); i++)
+    {
+        if (is_kept[i])
+        {
+            function[kept_count++] = function[i];
+        }
+    }
+
+    function.resize(kept_count);
+
+    return true;
+}
+
+bool DeadCodeEliminationPass::RemoveJumpsToNext(IrSequence &function)
+{
+    size_t kept_count = 0;
+
+    for (size_t i = 0; i < function.size(); i++)
+    {
+        const IrInstruction &instruction = function[i];
+
+        // Conditions only read variables, so an IF may go as well as a GOTO
+        if (IsJump(instruction))
+        {
+            bool is_jump_to_next = false;
+
+            for (size_t j = i + 1;
+                 j < function.size() && function[j].opcode == IrOpcode::LABEL;
+                 j++)
+            {
+                if (function[j].dest == instruction.dest)
+                {
+                    is_jump_to_next = true;
+                    break;
+                }
+            }
+
+            if (is_jump_to_next)
+            {
+                continue;
+            }
+        }
+
+        function[kept_count++] = instruction;
+    }
+
+    if (kept_count == function.size())
+    {
+        return false;
+    }
+
+    function.resize(kept_count);
+
+    return true;
+}
+
+bool DeadCodeEliminationPass::RemoveUnusedLabels(IrSequence &function)
+{
+    std::unordered_set<uint32_t> jump_targets;
+    for (auto &instruction : function)
+    {
+        if (IsJump(instruction))
+        {
+            jump_targets.insert(instruction.dest.value);
+        }
+    }
+
+    size_t kept_count = 0;
+    for (size_t i = 0; i < function.size(); i++)
+    {
+        const IrInstruction &instruction = function[i];
+
+        if (instruction.opcode == IrOpcode::LABEL &&
+            jump_targets.count(instruction.dest.value) == 0)
+        {
+            continue;
+        }
+
+        function[kept_count++] = instruction;
+    }
+
+    if (kept_count == function.size())
+    {
+        return false;
+    }
+
+    function.resize(kept_count);
+
+    return true;
+}
+
+bool DeadCodeEliminationPass::RemoveDeadAssignments(IrSequence &function,
+                                                    const IrProgramInfo &program_info)
+{
+    bool is_changed = false;
+
+    // Maps variable number to the number of instructions reading it
+    std::unordered_map<uint32_t, size_t> use_counts;
+
+    for (auto &instruction : function)
+    {
+        ForEachUsedOperand(instruction,
+                           [&use_counts](const IrOperand &operand)
+                           {
+                               if (operand.type == IrOperandType::VARIABLE ||
+                                   operand.type == IrOperandType::DEREFERENCE)
+                               {
+                                   use_counts[operand.value]++;
+                               }
+                           });
+    }
+
+    // Deleting an assignment may leave its operands unread in turn
+    bool is_round_changed = true;
+    while (is_round_changed)
+    {
+        is_round_changed = false;
+        size_t kept_count = 0;
+
+        for (size_t i = 0; i < function.size(); i++)
+        {
+            IrInstruction &instruction = function[i];
+            const IrOperand *defined_variable = GetDefinedVariable(instruction);
+
+            bool is_dead = defined_variable != nullptr &&
+                           !program_info.IsGlobal(*defined_variable) &&
+                           use_counts[defined_variable->value] == 0;
+
+            // x := x is dead even if x is read later
+            bool is_self_copy = instruction.opcode == IrOpcode::ASSIGN &&
+                                instruction.dest.type == IrOperandType::VARIABLE &&
+                                instruction.dest == instruction.arg1;
+
+            if ((is_dead && !HasSideEffect(instruction)) || is_self_copy)
+            {
+                ForEachUsedOperand(instruction,
+                                   [&use_counts](const IrOperand &operand)
+                                   {
+                                       if (operand.type == IrOperandType::VARIABLE ||
+                                           operand.type == IrOperandType::DEREFERENCE)
+                                       {
+                                           use_counts[operand.value]--;
+                                       }
+                                   });
+                is_round_changed = true;
+                continue;
+            }
+
+            if (is_dead && instruction.opcode == IrOpcode::CALL)
+            {
+                instruction.dest = IrOperand::None();
+                is_round_changed = true;
+            }
+
+            function[kept_count++] = instruction;
+        }
+
+        function.resize(kept_count);
+        is_changed |= is_round_changed;
+    }
+
+    return is_changed;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "ir_pass.h"
+
+// Dead code elimination over the control flow graph.
+// Deletes blocks not reachable from the entry block, GOTOs and IFs whose
+// target is the label they would fall through to anyway, labels nothing
+// jumps to and assignments to local variables that are never read,
+// repeating until none is left since each removal may expose more.
+class DeadCodeEliminationPass : public IrPass
+{
+public:
+    const char *GetName() const override
+    {
+        return "dead-code-elimination";
+    }
+
+    bool Run(IrSequence &function, const IrProgramInfo &program_info) override;
+
+    // Each returns whether anything changed
+    static bool RemoveUnreachableBlocks(IrSequence &function);
+    static bool RemoveJumpsToNext(IrSequence &function);
+    static bool RemoveUnusedLabels(IrSequence &function);
+    // Deletes assignments to local variables that are never read in function
+    // and drops unread CALL results, until none is left
+    static bool RemoveDeadAssignments(IrSequence &function, const IrProgramInfo &program_info);
+};
@@ -0,0 +1,168 @@
+#include <utility>
+
+#include "dominator_tree.h"
+
+DominatorTree::DominatorTree(const ControlFlowGraph &cfg)
+    : cfg_(cfg),
+      immediate_dominators_(cfg.GetBlockCount(), kNone),
+      children_(cfg.GetBlockCount()),
+      preorder_numbers_(cfg.GetBlockCount(), 0),
+      postorder_numbers_(cfg.GetBlockCount(), 0)
+{
+    ComputeImmediateDominators();
+    NumberTree();
+}
+
+// The iterative algorithm of Cooper, Harvey and Kennedy: blocks are visited in
+// reverse postorder and the dominators of the predecessors processed so far
+// are intersected by walking up the tree, until nothing changes.
+void DominatorTree::ComputeImmediateDominators()
+{
+    const auto &reverse_postorder = cfg_.GetReversePostorder();
+    if (reverse_postorder.empty())
+    {
+        return;
+    }
+
+    std::vector<size_t> rpo_numbers(cfg_.GetBlockCount(), kNone);
+    for (size_t i = 0; i < reverse_postorder.size(); i++)
+    {
+        rpo_numbers[reverse_postorder[i]] = i;
+    }
+
+    const size_t entry = reverse_postorder.front();
+
+    // The entry block temporarily dominates itself to end the walks up the tree
+    immediate_dominators_[entry] = entry;
+
+    auto intersect = [&](size_t a, size_t b)
+    {
+        while (a != b)
+        {
+            while (rpo_numbers[a] > rpo_numbers[b])
+            {
+                a = immediate_dominators_[a];
+            }
+            while (rpo_numbers[b] > rpo_numbers[a])
+            {
+                b = immediate_dominators_[b];
+            }
+        }
+
+        return a;
+    };
+
+    bool is_changed = true;
+    while (is_changed)
+    {
+        is_changed = false;
+
+        for (size_t i = 1; i < reverse_postorder.size(); i++)
+        {
+            size_t block = reverse_postorder[i];
+            size_t new_immediate_dominator = kNone;
+
+            for (size_t predecessor : cfg_.GetBlock(block).predecessors)
+            {
+                if (immediate_dominators_[predecessor] == kNone)
+                {
+                    continue;
+                }
+
+                new_immediate_dominator =
+                    new_immediate_dominator == kNone
+                        ? predecessor
+                        : intersect(predecessor, new_immediate_dominator);
+            }
+
+            if (immediate_dominators_[block] != new_immediate_dominator)
+            {
+                immediate_dominators_[block] = new_immediate_dominator;
+                is_changed = true;
+            }
+        }
+    }
+
+    immediate_dominators_[entry] = kNone;
+
+    for (size_t block : reverse_postorder)
+    {
+        if (immediate_dominators_[block] != kNone)
+        {
+            children_[immediate_dominators_[block]].push_back(block);
+        }
+    }
+}
+
+void DominatorTree::NumberTree()
+{
+    const auto &reverse_postorder = cfg_.GetReversePostorder();
+    if (reverse_postorder.empty())
+    {
+        return;
+    }
+
+    size_t preorder_number = 0;
+    size_t postorder_number = 0;
+
+    // Iterative, as the tree is as deep as the statements are nested
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.push_back({reverse_postorder.front(), 0});
+    preorder_numbers_[reverse_postorder.front()] = preorder_number++;
+
+    while (!stack.empty())
+    {
+        auto &[block, next_child] = stack.back();
+
+        if (next_child == children_[block].size())
+        {
+            postorder_numbers_[block] = postorder_number++;
+            stack.pop_back();
+            continue;
+        }
+
+        size_t child = children_[block][next_child++];
+        preorder_numbers_[child] = preorder_number++;
+        stack.push_back({child, 0});
+    }
+}
+
+// Also by Cooper, Harvey and Kennedy: a join block is in the frontier of
+// each block on the path up the tree from any of its predecessors to its
+// immediate dominator, excluding the latter.
+std::vector<std::vector<size_t>> DominatorTree::ComputeDominanceFrontiers() const
+{
+    std::vector<std::vector<size_t>> frontiers(cfg_.GetBlockCount());
+
+    for (size_t block : cfg_.GetReversePostorder())
+    {
+        const auto &predecessors = cfg_.GetBlock(block).predecessors;
+        if (predecessors.size() < 2)
+        {
+            continue;
+        }
+
+        for (size_t predecessor : predecessors)
+        {
+            if (!cfg_.IsReachable(predecessor))
+            {
+                continue;
+            }
+
+            for (size_t runner = predecessor;
+                 runner != immediate_dominators_[block];
+                 runner = immediate_dominators_[runner])
+            {
+                // Two predecessors may share the tail of their paths
+                if (!frontiers[runner].empty() && frontiers[runner].back() == block)
+                {
+                    break;
+                }
+
+                frontiers[runner].push_back(block);
+            }
+        }
+    }
+
+    return frontiers;
+}
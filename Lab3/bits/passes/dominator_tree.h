@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "control_flow_graph.h"
+
+// Immediate dominators of the reachable blocks of a control flow graph.
+// Block a dominates block b if every path from the entry block to b
+// passes through a. Every block dominates itself.
+class DominatorTree
+{
+private:
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    const ControlFlowGraph &cfg_;
+
+    // Indexed by block, kNone for the entry block and unreachable blocks
+    std::vector<size_t> immediate_dominators_;
+    std::vector<std::vector<size_t>> children_;
+    // Preorder and postorder numbers in the tree, to answer Dominates() in O(1)
+    std::vector<size_t> preorder_numbers_;
+    std::vector<size_t> postorder_numbers_;
+
+public:
+    explicit DominatorTree(const ControlFlowGraph &cfg);
+
+    DominatorTree(const DominatorTree &) = delete;
+    DominatorTree &operator=(const DominatorTree &) = delete;
+
+    // Returns whether block a dominates block b. Both must be reachable.
+    bool Dominates(const size_t a, const size_t b) const
+    {
+        return preorder_numbers_[a] <= preorder_numbers_[b] &&
+               postorder_numbers_[b] <= postorder_numbers_[a];
+    }
+
+    bool HasImmediateDominator(const size_t block) const
+    {
+        return immediate_dominators_[block] != kNone;
+    }
+
+    size_t GetImmediateDominator(const size_t block) const
+    {
+        return immediate_dominators_[block];
+    }
+
+    // Blocks immediately dominated by block
+    const std::vector<size_t> &GetChildren(const size_t block) const
+    {
+        return children_[block];
+    }
+
+    // Returns the dominance frontier of each block: the blocks where its
+    // dominance ends, that is which it does not strictly dominate but
+    // dominates a predecessor of. Empty for unreachable blocks.
+    std::vector<std::vector<size_t>> ComputeDominanceFrontiers() const;
+
+private:
+    void ComputeImmediateDominators();
+    void NumberTree();
+};
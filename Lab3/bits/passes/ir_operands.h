@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../ir_instruction.h"
+
+// Which operands of an instruction are read and which variable it writes,
+// shared by every pass so that they agree on IR semantics.
+
+// Returns the VARIABLE operand instruction assigns to, or nullptr.
+// A DEREFERENCE dest is a store to memory, not a variable definition.
+inline const IrOperand *GetDefinedVariable(const IrInstruction &instruction)
+{
+    switch (instruction.opcode)
+    {
+    case IrOpcode::ASSIGN:
+    case IrOpcode::BINARY:
+    case IrOpcode::CALL:
+    case IrOpcode::READ:
+    case IrOpcode::PARAM:
+        return instruction.dest.type == IrOperandType::VARIABLE ? &instruction.dest : nullptr;
+    default:
+        return nullptr;
+    }
+}
+
+// Calls visit(IrOperand &) on each value operand instruction reads: arguments
+// of any type plus a DEREFERENCE dest, whose variable holds the store address.
+// Labels, function names and DEC sizes are not visited.
+template <typename Instruction, typename Visitor>
+void ForEachUsedOperand(Instruction &instruction, Visitor visit)
+{
+    switch (instruction.opcode)
+    {
+    case IrOpcode::BINARY:
+    case IrOpcode::IF:
+        visit(instruction.arg1);
+        visit(instruction.arg2);
+        break;
+    case IrOpcode::ASSIGN:
+    case IrOpcode::RETURN:
+    case IrOpcode::ARG:
+    case IrOpcode::WRITE:
+        visit(instruction.arg1);
+        break;
+    default:
+        break;
+    }
+
+    if (instruction.dest.type == IrOperandType::DEREFERENCE)
+    {
+        visit(instruction.dest);
+    }
+}
+
+// Whether instruction has an effect besides defining its variable:
+// memory stores, calls, I/O, control flow and declarations.
+inline bool HasSideEffect(const IrInstruction &instruction)
+{
+    switch (instruction.opcode)
+    {
+    case IrOpcode::ASSIGN:
+    case IrOpcode::BINARY:
+        return instruction.dest.type != IrOperandType::VARIABLE;
+    default:
+        return true;
+    }
+}
+
+inline bool IsJump(const IrInstruction &instruction)
+{
+    return instruction.opcode == IrOpcode::GOTO || instruction.opcode == IrOpcode::IF;
+}
+
+// Whether control never falls through to the next instruction
+inline bool EndsControlFlow(const IrInstruction &instruction)
+{
+    return instruction.opcode == IrOpcode::GOTO || instruction.opcode == IrOpcode::RETURN;
+}
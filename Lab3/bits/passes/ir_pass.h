@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+
+#include "../ir_instruction.h"
+
+// What passes need to know about the program beyond the function at hand
+struct IrProgramInfo
+{
+    // Variables declared with GLOBAL_DEC. They live across calls and
+    // may be changed by any callee, so passes never track their values.
+    std::unordered_set<uint32_t> global_variables;
+    // Returns a variable number unused in the whole program.
+    // Passes introducing variables do nothing if it is not set.
+    std::function<uint32_t()> allocate_variable;
+    // Likewise for label numbers
+    std::function<uint32_t()> allocate_label;
+
+    bool IsGlobal(const IrOperand &operand) const
+    {
+        return operand.IsVariableBased() && global_variables.count(operand.value) > 0;
+    }
+};
+
+// An optimization over the IR of one function, from FUNCTION to
+// the instruction before the next FUNCTION.
+class IrPass
+{
+public:
+    virtual ~IrPass() = default;
+
+    virtual const char *GetName() const = 0;
+
+    // Rewrites function in place. Returns whether anything changed.
+    virtual bool Run(IrSequence &function, const IrProgramInfo &program_info) = 0;
+};
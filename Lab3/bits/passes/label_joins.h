@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "../ir_instruction.h"
+#include "ir_operands.h"
+
+// Lets passes that walk a function top to bottom decide whether what they
+// know before a LABEL still holds after it.
+class LabelJoins
+{
+private:
+    // Maps label number to the number of jumps to it
+    std::unordered_map<uint32_t, size_t> jump_counts_;
+
+public:
+    void Count(const IrSequence &function)
+    {
+        jump_counts_.clear();
+
+        for (auto &instruction : function)
+        {
+            if (IsJump(instruction))
+            {
+                jump_counts_[instruction.dest.value]++;
+            }
+        }
+    }
+
+    // Whether other paths may join at label, that is unless it is only reached
+    // by falling through or by previous, the GOTO right before it.
+    // previous is nullptr at the start of the function.
+    bool IsJoin(const IrInstruction &label, const IrInstruction *previous) const
+    {
+        auto jump_count = jump_counts_.find(label.dest.value);
+        if (jump_count == jump_counts_.end() || jump_count->second == 0)
+        {
+            return false;
+        }
+
+        return jump_count->second > 1 ||
+               previous == nullptr ||
+               previous->opcode != IrOpcode::GOTO ||
+               previous->dest != label.dest;
+    }
+};
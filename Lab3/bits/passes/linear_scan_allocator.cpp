@@ -0,0 +1,154 @@
+#include <algorithm>
+
+#include "control_flow_graph.h"
+#include "liveness.h"
+#include "linear_scan_allocator.h"
+
+void LinearScanAllocator::Allocate(const IrSequence &function, const IrProgramInfo &program_info)
+{
+    BuildIntervals(function, program_info);
+
+    registers_.clear();
+    spill_count_ = 0;
+
+    const size_t register_count = caller_saved_count_ + callee_saved_count_;
+    is_register_used_.assign(register_count, false);
+    std::vector<bool> is_register_free(register_count, true);
+
+    std::vector<size_t> call_positions;
+    for (size_t i = 0; i < function.size(); i++)
+    {
+        if (function[i].opcode == IrOpcode::CALL)
+        {
+            call_positions.push_back(i);
+        }
+    }
+
+    // Indices into intervals_ of those holding a register, by ascending end
+    std::vector<size_t> active;
+
+    auto spill = [this](const LiveInterval &interval)
+    {
+        registers_[interval.variable] = kSpilled;
+        spill_count_++;
+    };
+
+    for (size_t i = 0; i < intervals_.size(); i++)
+    {
+        const LiveInterval &interval = intervals_[i];
+
+        // A register read for the last time by an instruction may receive
+        // its result, so intervals ending at this start are expired too
+        while (!active.empty() && intervals_[active.front()].end <= interval.start)
+        {
+            is_register_free[registers_.at(intervals_[active.front()].variable)] = true;
+            active.erase(active.begin());
+        }
+
+        // The result of a CALL is defined after the call returns
+        auto next_call = std::upper_bound(call_positions.begin(),
+                                          call_positions.end(),
+                                          interval.start);
+        bool is_across_call = next_call != call_positions.end() && *next_call < interval.end;
+
+        size_t first_register = is_across_call ? caller_saved_count_ : 0;
+        int reg = kSpilled;
+
+        for (size_t j = first_register; j < register_count; j++)
+        {
+            if (is_register_free[j])
+            {
+                reg = static_cast<int>(j);
+                break;
+            }
+        }
+
+        if (reg == kSpilled)
+        {
+            // Steals the register of the allowed interval ending last
+            // if it ends after this one
+            auto victim = active.rend();
+            for (auto j = active.rbegin(); j != active.rend(); ++j)
+            {
+                if (static_cast<size_t>(registers_.at(intervals_[*j].variable)) >= first_register)
+                {
+                    victim = j;
+                    break;
+                }
+            }
+
+            if (victim == active.rend() || intervals_[*victim].end <= interval.end)
+            {
+                spill(interval);
+                continue;
+            }
+
+            reg = registers_.at(intervals_[*victim].variable);
+            spill(intervals_[*victim]);
+            active.erase(std::next(victim).base());
+        }
+
+        registers_[interval.variable] = reg;
+        is_register_free[reg] = false;
+        is_register_used_[reg] = true;
+
+        active.insert(std::upper_bound(active.begin(),
+                                       active.end(),
+                                       interval.end,
+                                       [this](const size_t end, const size_t index)
+                                       {
+                                           return end < intervals_[index].end;
+                                       }),
+                      i);
+    }
+}
+
+void LinearScanAllocator::BuildIntervals(const IrSequence &function,
+                                         const IrProgramInfo &program_info)
+{
+    ControlFlowGraph cfg(function);
+    Liveness liveness(cfg, program_info);
+
+    intervals_.clear();
+    for (size_t i = 0; i < liveness.GetVariableCount(); i++)
+    {
+        intervals_.push_back({liveness.GetVariable(i), function.size(), 0});
+    }
+
+    auto extend = [this](const size_t index, const size_t position)
+    {
+        intervals_[index].start = std::min(intervals_[index].start, position);
+        intervals_[index].end = std::max(intervals_[index].end, position);
+    };
+
+    for (size_t i = 0; i < cfg.GetBlockCount(); i++)
+    {
+        const BasicBlock &block = cfg.GetBlock(i);
+
+        liveness.ForEachLiveIn(i, [&](const size_t index)
+                               { extend(index, block.begin); });
+        liveness.ForEachLiveOut(i, [&](const size_t index)
+                                { extend(index, block.end - 1); });
+
+        for (size_t j = block.begin; j < block.end; j++)
+        {
+            const IrOperand *defined_variable = Liveness::VisitInstruction(
+                function[j],
+                program_info,
+                [&](const uint32_t variable)
+                { extend(liveness.GetVariableIndex(variable), j); });
+
+            if (defined_variable != nullptr)
+            {
+                extend(liveness.GetVariableIndex(defined_variable->value), j);
+            }
+        }
+    }
+
+    std::stable_sort(intervals_.begin(),
+                     intervals_.end(),
+                     [](const LiveInterval &a, const LiveInterval &b)
+                     {
+                         return a.start < b.start;
+                     });
+}
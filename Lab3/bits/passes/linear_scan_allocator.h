@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ir_pass.h"
+
+// The instructions from the first to the last one where a variable may
+// hold a value that is still needed, by their index in the function
+struct LiveInterval
+{
+    uint32_t variable;
+    size_t start;
+    size_t end;
+};
+
+// Assigns registers to the non-global variables of a function by linear
+// scan over their live intervals (Poletto and Sarkar, 1999). Intervals are
+// built from Liveness over the control flow graph, so a variable live
+// around a loop holds its register for the whole loop.
+// Registers are numbered from 0: first the caller-saved ones, which CALL
+// clobbers, then the callee-saved ones. An interval spanning a CALL only
+// gets a callee-saved register. When no register is free, the interval
+// ending last is spilled, that is left in memory for its whole lifetime.
+class LinearScanAllocator
+{
+public:
+    static constexpr int kSpilled = -1;
+
+private:
+    const size_t caller_saved_count_;
+    const size_t callee_saved_count_;
+
+    std::vector<LiveInterval> intervals_;
+    // Maps variable number to its register or kSpilled
+    std::unordered_map<uint32_t, int> registers_;
+    size_t spill_count_;
+    // Indexed by register
+    std::vector<bool> is_register_used_;
+
+public:
+    LinearScanAllocator(const size_t caller_saved_count, const size_t callee_saved_count)
+        : caller_saved_count_(caller_saved_count),
+          callee_saved_count_(callee_saved_count),
+          spill_count_(0) {}
+
+    void Allocate(const IrSequence &function, const IrProgramInfo &program_info);
+
+    // Returns the register of a non-global variable, or kSpilled
+    int GetRegister(const uint32_t variable) const
+    {
+        return registers_.at(variable);
+    }
+
+    bool IsCalleeSaved(const int reg) const
+    {
+        return static_cast<size_t>(reg) >= caller_saved_count_;
+    }
+
+    // Whether some variable of the function got reg
+    bool IsRegisterUsed(const int reg) const
+    {
+        return is_register_used_[reg];
+    }
+
+    // Sorted by start
+    const std::vector<LiveInterval> &GetIntervals() const
+    {
+        return intervals_;
+    }
+
+    size_t GetSpillCount() const
+    {
+        return spill_count_;
+    }
+
+private:
+    void BuildIntervals(const IrSequence &function, const IrProgramInfo &program_info);
+};
@@ -0,0 +1,152 @@
+#include <algorithm>
+
+#include "liveness.h"
+
+Liveness::Liveness(const ControlFlowGraph &cfg, const IrProgramInfo &program_info)
+{
+    const IrSequence &function = cfg.GetFunction();
+
+    auto track = [this](const uint32_t variable)
+    {
+        if (variable_indices_.emplace(variable, variables_.size()).second)
+        {
+            variables_.push_back(variable);
+        }
+    };
+
+    for (auto &instruction : function)
+    {
+        const IrOperand *defined_variable = VisitInstruction(instruction, program_info, track);
+        if (defined_variable != nullptr)
+        {
+            track(defined_variable->value);
+        }
+    }
+
+    word_count_ = (variables_.size() + 63) / 64;
+
+    const size_t block_count = cfg.GetBlockCount();
+
+    // Variables each block reads before assigning them, and those it assigns
+    std::vector<uint64_t> uses(block_count * word_count_, 0);
+    std::vector<uint64_t> definitions(block_count * word_count_, 0);
+
+    for (size_t i = 0; i < block_count; i++)
+    {
+        const BasicBlock &block = cfg.GetBlock(i);
+        uint64_t *block_uses = uses.data() + i * word_count_;
+        uint64_t *block_definitions = definitions.data() + i * word_count_;
+
+        for (size_t j = block.begin; j < block.end; j++)
+        {
+            const IrOperand *defined_variable = VisitInstruction(
+                function[j],
+                program_info,
+                [&](const uint32_t variable)
+                {
+                    size_t index = variable_indices_.at(variable);
+                    if (!((block_definitions[index / 64] >> (index % 64)) & 1))
+                    {
+                        block_uses[index / 64] |= uint64_t(1) << (index % 64);
+                    }
+                });
+
+            if (defined_variable != nullptr)
+            {
+                size_t index = variable_indices_.at(defined_variable->value);
+                block_definitions[index / 64] |= uint64_t(1) << (index % 64);
+            }
+        }
+    }
+
+    live_in_ = uses;
+    live_out_.assign(block_count * word_count_, 0);
+
+    // Visiting blocks last to first follows most edges backwards,
+    // so few rounds are needed
+    bool is_changed = true;
+    while (is_changed)
+    {
+        is_changed = false;
+
+        for (size_t i = block_count; i-- > 0;)
+        {
+            uint64_t *block_live_in = live_in_.data() + i * word_count_;
+            uint64_t *block_live_out = live_out_.data() + i * word_count_;
+
+            for (size_t successor : cfg.GetBlock(i).successors)
+            {
+                const uint64_t *successor_live_in = live_in_.data() + successor * word_count_;
+                for (size_t j = 0; j < word_count_; j++)
+                {
+                    block_live_out[j] |= successor_live_in[j];
+                }
+            }
+
+            for (size_t j = 0; j < word_count_; j++)
+            {
+                uint64_t live_in = uses[i * word_count_ + j] |
+                                   (block_live_out[j] & ~definitions[i * word_count_ + j]);
+                if (live_in != block_live_in[j])
+                {
+                    block_live_in[j] = live_in;
+                    is_changed = true;
+                }
+            }
+        }
+    }
+}
+
+size_t Liveness::GetMaxLiveCount(const ControlFlowGraph &cfg,
+                                 const IrProgramInfo &program_info) const
+{
+    const IrSequence &function = cfg.GetFunction();
+    std::vector<uint64_t> live(word_count_);
+    std::vector<size_t> used_indices;
+    size_t max_live_count = 0;
+
+    auto count_live = [&]()
+    {
+        size_t live_count = 0;
+        for (uint64_t word : live)
+        {
+            live_count += __builtin_popcountll(word);
+        }
+        max_live_count = std::max(max_live_count, live_count);
+    };
+
+    for (size_t i = 0; i < cfg.GetBlockCount(); i++)
+    {
+        const BasicBlock &block = cfg.GetBlock(i);
+        std::copy(live_out_.begin() + i * word_count_,
+                  live_out_.begin() + (i + 1) * word_count_,
+                  live.begin());
+        count_live();
+
+        // Each instruction kills what it assigns, then revives what it reads
+        for (size_t j = block.end; j-- > block.begin;)
+        {
+            used_indices.clear();
+            const IrOperand *defined_variable = VisitInstruction(
+                function[j],
+                program_info,
+                [&](const uint32_t variable)
+                { used_indices.push_back(variable_indices_.at(variable)); });
+
+            if (defined_variable != nullptr)
+            {
+                size_t index = variable_indices_.at(defined_variable->value);
+                live[index / 64] &= ~(uint64_t(1) << (index % 64));
+            }
+
+            for (size_t index : used_indices)
+            {
+                live[index / 64] |= uint64_t(1) << (index % 64);
+            }
+
+            count_live();
+        }
+    }
+
+    return max_live_count;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "control_flow_graph.h"
+#include "ir_operands.h"
+#include "ir_pass.h"
+
+// Which variables are live, that is may still be read before being
+// assigned again, at the start and at the end of each basic block.
+// Only non-global variables are tracked; arrays and structs are memory
+// accessed through their address and are not variables here. Tracked
+// variables are numbered densely in order of first appearance, and the
+// sets are bit vectors indexed by these numbers.
+class Liveness
+{
+private:
+    // Maps variable number to its index in variables_
+    std::unordered_map<uint32_t, size_t> variable_indices_;
+    std::vector<uint32_t> variables_;
+    size_t word_count_;
+
+    // word_count_ words per block
+    std::vector<uint64_t> live_in_;
+    std::vector<uint64_t> live_out_;
+
+public:
+    Liveness(const ControlFlowGraph &cfg, const IrProgramInfo &program_info);
+
+    size_t GetVariableCount() const
+    {
+        return variables_.size();
+    }
+
+    uint32_t GetVariable(const size_t index) const
+    {
+        return variables_[index];
+    }
+
+    bool IsTracked(const uint32_t variable) const
+    {
+        return variable_indices_.count(variable) > 0;
+    }
+
+    // Returns the index of a tracked variable
+    size_t GetVariableIndex(const uint32_t variable) const
+    {
+        return variable_indices_.at(variable);
+    }
+
+    bool IsLiveIn(const size_t block, const size_t index) const
+    {
+        return (live_in_[block * word_count_ + index / 64] >> (index % 64)) & 1;
+    }
+
+    bool IsLiveOut(const size_t block, const size_t index) const
+    {
+        return (live_out_[block * word_count_ + index / 64] >> (index % 64)) & 1;
+    }
+
+    // Calls visit(size_t index) for each variable live at the start of block
+    template <typename Visitor>
+    void ForEachLiveIn(const size_t block, Visitor visit) const
+    {
+        ForEachSetBit(live_in_, block, visit);
+    }
+
+    // Calls visit(size_t index) for each variable live at the end of block
+    template <typename Visitor>
+    void ForEachLiveOut(const size_t block, Visitor visit) const
+    {
+        ForEachSetBit(live_out_, block, visit);
+    }
+
+    // Returns the largest number of variables live at once at any point
+    // of the function cfg was built from
+    size_t GetMaxLiveCount(const ControlFlowGraph &cfg, const IrProgramInfo &program_info) const;
+
+    // Calls visit(uint32_t variable) for each tracked variable instruction
+    // reads, and returns the variable it assigns or nullptr
+    template <typename Visitor>
+    static const IrOperand *VisitInstruction(const IrInstruction &instruction,
+                                             const IrProgramInfo &program_info,
+                                             Visitor visit)
+    {
+        ForEachUsedOperand(instruction,
+                           [&](const IrOperand &operand)
+                           {
+                               if ((operand.type == IrOperandType::VARIABLE ||
+                                    operand.type == IrOperandType::DEREFERENCE) &&
+                                   !program_info.IsGlobal(operand))
+                               {
+                                   visit(operand.value);
+                               }
+                           });
+
+        const IrOperand *defined_variable = GetDefinedVariable(instruction);
+        if (defined_variable != nullptr && program_info.IsGlobal(*defined_variable))
+        {
+            return nullptr;
+        }
+
+        return defined_variable;
+    }
+
+private:
+    template <typename Visitor>
+    void ForEachSetBit(const std::vector<uint64_t> &sets,
+                       const size_t block,
+                       Visitor visit) const
+    {
+        for (size_t i = 0; i < word_count_; i++)
+        {
+            uint64_t word = sets[block * word_count_ + i];
+            while (word != 0)
+            {
+                visit(i * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+};
@@ -0,0 +1,100 @@
+#include <algorithm>
+
+#include "ir_operands.h"
+#include "loop_info.h"
+
+LoopInfo::LoopInfo(const ControlFlowGraph &cfg, const DominatorTree &dominator_tree)
+{
+    // Maps header block to its index in loops_
+    std::vector<size_t> header_loops(cfg.GetBlockCount(), static_cast<size_t>(-1));
+
+    for (size_t block : cfg.GetReversePostorder())
+    {
+        for (size_t successor : cfg.GetBlock(block).successors)
+        {
+            if (!dominator_tree.Dominates(successor, block))
+            {
+                continue;
+            }
+
+            if (header_loops[successor] == static_cast<size_t>(-1))
+            {
+                header_loops[successor] = loops_.size();
+                loops_.push_back({successor, {}, {}, {}, false});
+            }
+
+            loops_[header_loops[successor]].latches.push_back(block);
+        }
+    }
+
+    for (auto &loop : loops_)
+    {
+        loop.contains.assign(cfg.GetBlockCount(), false);
+        loop.contains[loop.header] = true;
+
+        loop.blocks.push_back(loop.header);
+
+        std::vector<size_t> worklist;
+        for (size_t latch : loop.latches)
+        {
+            if (!loop.contains[latch])
+            {
+                loop.contains[latch] = true;
+                loop.blocks.push_back(latch);
+                worklist.push_back(latch);
+            }
+        }
+
+        while (!worklist.empty())
+        {
+            size_t block = worklist.back();
+            worklist.pop_back();
+
+            for (size_t predecessor : cfg.GetBlock(block).predecessors)
+            {
+                if (!loop.contains[predecessor] && cfg.IsReachable(predecessor))
+                {
+                    loop.contains[predecessor] = true;
+                    loop.blocks.push_back(predecessor);
+                    worklist.push_back(predecessor);
+                }
+            }
+        }
+
+        std::sort(loop.blocks.begin(), loop.blocks.end());
+
+        loop.has_preheader = HasPreheader(cfg, loop);
+    }
+
+    // A loop nested in another one has fewer blocks
+    std::stable_sort(loops_.begin(),
+                     loops_.end(),
+                     [](const Loop &a, const Loop &b)
+                     {
+                         return a.blocks.size() < b.blocks.size();
+                     });
+}
+
+bool LoopInfo::HasPreheader(const ControlFlowGraph &cfg, const Loop &loop)
+{
+    const BasicBlock &header = cfg.GetBlock(loop.header);
+    bool has_entry = false;
+
+    for (size_t predecessor : header.predecessors)
+    {
+        if (loop.contains[predecessor])
+        {
+            continue;
+        }
+
+        // Code placed before the header LABEL is skipped by jumps to it
+        if (predecessor + 1 != loop.header || IsJump(cfg.GetLastInstruction(predecessor)))
+        {
+            return false;
+        }
+
+        has_entry = true;
+    }
+
+    return has_entry;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "control_flow_graph.h"
+#include "dominator_tree.h"
+
+// A natural loop: the header and every block that can reach one of the
+// latches without passing through the header. The header dominates them all.
+struct Loop
+{
+    size_t header;
+    // Blocks jumping back to the header
+    std::vector<size_t> latches;
+    // Every block of the loop, header included, in ascending order
+    std::vector<size_t> blocks;
+    // Indexed by block
+    std::vector<bool> contains;
+    // Whether code placed right before the header LABEL runs exactly once
+    // each time the loop is entered, that is whether the loop is only
+    // entered by falling through from the block before the header, as
+    // every while loop IrGenerator emits is. That block is the preheader.
+    bool has_preheader;
+};
+
+// Finds the natural loops of a function from the back edges of its control
+// flow graph, that is edges whose target dominates their source.
+// Back edges to the same header form one loop.
+class LoopInfo
+{
+private:
+    std::vector<Loop> loops_;
+
+public:
+    LoopInfo(const ControlFlowGraph &cfg, const DominatorTree &dominator_tree);
+
+    // The block before the header. Only meaningful if loop.has_preheader.
+    static size_t GetPreheader(const Loop &loop)
+    {
+        return loop.header - 1;
+    }
+
+    // Inner loops come before the loops containing them
+    const std::vector<Loop> &GetLoops() const
+    {
+        return loops_;
+    }
+
+private:
+    static bool HasPreheader(const ControlFlowGraph &cfg, const Loop &loop);
+};
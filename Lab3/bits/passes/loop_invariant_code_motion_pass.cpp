@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "ir_operands.h"
+#include "loop_invariant_code_motion_pass.h"
+
+bool LoopInvariantCodeMotionPass::Run(IrSequence &function, const IrProgramInfo &program_info)
+{
+    bool is_changed = false;
+
+    {
+        ControlFlowGraph cfg(function);
+        DominatorTree dominator_tree(cfg);
+        LoopInfo loop_info(cfg, dominator_tree);
+
+        IndexFunction(cfg);
+
+        // Instructions only move in positions_, so the analyses stay valid
+        for (auto &loop : loop_info.GetLoops())
+        {
+            if (!loop.has_preheader)
+            {
+                continue;
+            }
+
+            const size_t preheader = LoopInfo::GetPreheader(loop);
+            const size_t preheader_end = cfg.GetBlock(preheader).end;
+
+            for (size_t i : FindInvariants(cfg, dominator_tree, loop, program_info))
+            {
+                positions_[i] = {preheader_end - 1, next_order_++};
+                blocks_[i] = preheader;
+                is_changed = true;
+            }
+        }
+    }
+
+    if (is_changed)
+    {
+        std::vector<size_t> order(function.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+
+        std::sort(order.begin(),
+                  order.end(),
+                  [this](const size_t a, const size_t b)
+                  {
+                      return positions_[a] < positions_[b];
+                  });
+
+        IrSequence moved_function;
+        moved_function.reserve(function.size());
+        for (size_t i : order)
+        {
+            moved_function.push_back(function[i]);
+        }
+
+        function = std::move(moved_function);
+    }
+
+    positions_.clear();
+    blocks_.clear();
+    variable_uses_.clear();
+
+    return is_changed;
+}
+
+void LoopInvariantCodeMotionPass::IndexFunction(const ControlFlowGraph &cfg)
+{
+    const IrSequence &function = cfg.GetFunction();
+
+    positions_.resize(function.size());
+    blocks_.resize(function.size());
+    next_order_ = 1;
+
+    for (size_t i = 0; i < cfg.GetBlockCount(); i++)
+    {
+        const BasicBlock &block = cfg.GetBlock(i);
+
+        for (size_t j = block.begin; j < block.end; j++)
+        {
+            positions_[j] = {j, 0};
+            blocks_[j] = i;
+
+            ForEachUsedOperand(function[j],
+                               [this, j](const IrOperand &operand)
+                               {
+                                   if (operand.type == IrOperandType::VARIABLE ||
+                                       operand.type == IrOperandType::DEREFERENCE)
+                                   {
+                                       variable_uses_[operand.value].push_back(j);
+                                   }
+                               });
+        }
+    }
+}
+
+std::vector<size_t> LoopInvariantCodeMotionPass::FindInvariants(
+    const ControlFlowGraph &cfg,
+    const DominatorTree &dominator_tree,
+    const Loop &loop,
+    const IrProgramInfo &program_info) const
+{
+    const IrSequence &function = cfg.GetFunction();
+
+    // Maps variable number to the number of its assignments in the loop.
+    // Code moved out of an inner loop is still in this one.
+    std::unordered_map<uint32_t, size_t> definition_counts;
+    for (size_t block : loop.blocks)
+    {
+        for (size_t i = cfg.GetBlock(block).begin; i < cfg.GetBlock(block).end; i++)
+        {
+            const IrOperand *defined_variable = GetDefinedVariable(function[i]);
+            if (defined_variable != nullptr)
+            {
+                definition_counts[defined_variable->value]++;
+            }
+        }
+    }
+
+    // Variables assigned by instructions already found invariant
+    std::unordered_set<uint32_t> invariant_variables;
+    std::vector<size_t> invariants;
+
+    auto is_invariant_operand = [&](const IrOperand &operand)
+    {
+        switch (operand.type)
+        {
+        case IrOperandType::NONE:
+        case IrOperandType::IMMEDIATE:
+        case IrOperandType::FLOAT_IMMEDIATE:
+        case IrOperandType::ADDRESS:
+            return true;
+        case IrOperandType::VARIABLE:
+            return !program_info.IsGlobal(operand) &&
+                   (definition_counts.count(operand.value) == 0 ||
+                    invariant_variables.count(operand.value) > 0);
+        default:
+            return false;
+        }
+    };
+
+    // An instruction may only become invariant once those it reads are
+    bool is_found = true;
+    while (is_found)
+    {
+        is_found = false;
+
+        for (size_t block : loop.blocks)
+        {
+            for (size_t i = cfg.GetBlock(block).begin; i < cfg.GetBlock(block).end; i++)
+            {
+                const IrInstruction &instruction = function[i];
+
+                if (!IsMovable(instruction, program_info) ||
+                    invariant_variables.count(instruction.dest.value) > 0 ||
+                    definition_counts[instruction.dest.value] != 1 ||
+                    !is_invariant_operand(instruction.arg1) ||
+                    !is_invariant_operand(instruction.arg2) ||
+                    !IsOnlyReadAfter(i, dominator_tree, loop, instruction.dest.value))
+                {
+                    continue;
+                }
+
+                invariant_variables.insert(instruction.dest.value);
+                invariants.push_back(i);
+                is_found = true;
+            }
+        }
+    }
+
+    return invariants;
+}
+
+bool LoopInvariantCodeMotionPass::IsMovable(const IrInstruction &instruction,
+                                            const IrProgramInfo &program_info)
+{
+    if ((instruction.opcode != IrOpcode::ASSIGN && instruction.opcode != IrOpcode::BINARY) ||
+        instruction.dest.type != IrOperandType::VARIABLE ||
+        program_info.IsGlobal(instruction.dest))
+    {
+        return false;
+    }
+
+    // Executing a division the loop might have skipped could fault
+    if (instruction.opcode == IrOpcode::BINARY && instruction.op == IrOperator::DIV)
+    {
+        return instruction.arg2.type == IrOperandType::IMMEDIATE &&
+               instruction.arg2.GetImmediateValue() != 0 &&
+               instruction.arg2.GetImmediateValue() != -1;
+    }
+
+    return true;
+}
+
+bool LoopInvariantCodeMotionPass::IsOnlyReadAfter(const size_t instruction,
+                                                  const DominatorTree &dominator_tree,
+                                                  const Loop &loop,
+                                                  const uint32_t variable) const
+{
+    auto uses = variable_uses_.find(variable);
+    if (uses == variable_uses_.end())
+    {
+        return true;
+    }
+
+    const size_t block = blocks_[instruction];
+
+    for (size_t use : uses->second)
+    {
+        const size_t use_block = blocks_[use];
+
+        if (!loop.contains[use_block] ||
+            !dominator_tree.Dominates(block, use_block) ||
+            (use_block == block && positions_[use] <= positions_[instruction]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
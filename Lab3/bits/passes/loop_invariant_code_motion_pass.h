@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ir_pass.h"
+#include "control_flow_graph.h"
+#include "dominator_tree.h"
+#include "loop_info.h"
+
+// Loop-invariant code motion.
+// Finds the natural loops of each function and moves assignments whose value
+// cannot change while a loop runs into a preheader right before its header
+// LABEL, innermost loops first, so that e.g. the row address of a[i][j]
+// is computed once per row instead of once per element. Code moved out of
+// an inner loop may move on out of the loops around it.
+// An assignment x := y op z is moved if y and z are immediates, addresses or
+// local variables not assigned in the loop or assigned by moved instructions,
+// x is assigned nowhere else in the loop and only read in the loop, after
+// the assignment. Loads, globals and divisions that may trap stay.
+// Loops without a preheader are left alone.
+class LoopInvariantCodeMotionPass : public IrPass
+{
+private:
+    // Where an instruction is to be placed: instructions are sorted by
+    // (index, order). Moved instructions take the index of the last
+    // instruction before a header and an increasing order after it.
+    using Position = std::pair<size_t, size_t>;
+
+    // Built once per function, updated as instructions are moved
+    std::vector<Position> positions_;
+    std::vector<size_t> blocks_;
+    size_t next_order_;
+    // Maps variable number to the instructions reading it
+    std::unordered_map<uint32_t, std::vector<size_t>> variable_uses_;
+
+public:
+    const char *GetName() const override
+    {
+        return "loop-invariant-code-motion";
+    }
+
+    bool Run(IrSequence &function, const IrProgramInfo &program_info) override;
+
+private:
+    void IndexFunction(const ControlFlowGraph &cfg);
+    // Returns the indices of the instructions of loop to move, in order
+    std::vector<size_t> FindInvariants(const ControlFlowGraph &cfg,
+                                       const DominatorTree &dominator_tree,
+                                       const Loop &loop,
+                                       const IrProgramInfo &program_info) const;
+    static bool IsMovable(const IrInstruction &instruction, const IrProgramInfo &program_info);
+    // Whether every read of the variable instruction assigns is in loop and
+    // placed after instruction in a block it dominates
+    bool IsOnlyReadAfter(const size_t instruction,
+                         const DominatorTree &dominator_tree,
+                         const Loop &loop,
+                         const uint32_t variable) const;
+};
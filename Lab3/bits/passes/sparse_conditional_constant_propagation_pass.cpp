@@ -0,0 +1,462 @@
+#include <algorithm>
+
+#include "constant_folding_pass.h"
+#include "dead_code_elimination_pass.h"
+#include "ir_operands.h"
+#include "sparse_conditional_constant_propagation_pass.h"
+
+bool SparseConditionalConstantPropagationPass::Run(IrSequence &function,
+                                                   const IrProgramInfo &program_info)
+{
+    if (!program_info.allocate_variable || !program_info.allocate_label)
+    {
+        return false;
+    }
+
+    // Leaving SSA form renames variables and adds copies, which is only
+    // worth it if something was found
+    IrSequence original_function = function;
+
+    SsaForm ssa_form(function, program_info);
+    ssa_form_ = &ssa_form;
+
+    Propagate();
+
+    bool is_branch_folded = false;
+    bool is_changed = Rewrite(function, is_branch_folded);
+    is_changed |= ssa_form.RemoveDeadDefinitions();
+
+    if (!is_changed)
+    {
+        function = std::move(original_function);
+        return false;
+    }
+
+    ssa_form.Destruct();
+
+    if (is_branch_folded)
+    {
+        DeadCodeEliminationPass::RemoveUnreachableBlocks(function);
+    }
+
+    return true;
+}
+
+void SparseConditionalConstantPropagationPass::Propagate()
+{
+    const ControlFlowGraph &cfg = ssa_form_->GetControlFlowGraph();
+    const IrSequence &function = cfg.GetFunction();
+
+    values_.clear();
+    uses_.clear();
+    is_edge_executable_.assign(cfg.GetBlockCount(), {});
+    is_block_visited_.assign(cfg.GetBlockCount(), false);
+    block_worklist_.clear();
+    variable_worklist_.clear();
+
+    for (size_t block : cfg.GetReversePostorder())
+    {
+        is_edge_executable_[block].assign(cfg.GetBlock(block).predecessors.size(), false);
+
+        auto &phis = ssa_form_->GetPhis(block);
+        for (size_t i = 0; i < phis.size(); i++)
+        {
+            for (auto &arg : phis[i].args)
+            {
+                if (arg.type == IrOperandType::VARIABLE && ssa_form_->IsDefined(arg.value))
+                {
+                    uses_[arg.value].push_back({block, i, true});
+                }
+            }
+        }
+
+        for (size_t i = cfg.GetBlock(block).begin; i < cfg.GetBlock(block).end; i++)
+        {
+            ForEachUsedOperand(function[i],
+                               [&](const IrOperand &operand)
+                               {
+                                   if (operand.type == IrOperandType::VARIABLE &&
+                                       ssa_form_->IsDefined(operand.value))
+                                   {
+                                       uses_[operand.value].push_back({block, i, false});
+                                   }
+                               });
+        }
+    }
+
+    if (cfg.GetReversePostorder().empty())
+    {
+        return;
+    }
+
+    VisitBlock(cfg.GetReversePostorder().front());
+
+    while (!block_worklist_.empty() || !variable_worklist_.empty())
+    {
+        if (!block_worklist_.empty())
+        {
+            size_t block = block_worklist_.back();
+            block_worklist_.pop_back();
+
+            if (!is_block_visited_[block])
+            {
+                VisitBlock(block);
+                continue;
+            }
+
+            // Only the phis depend on which edges are executable
+            for (size_t i = 0; i < ssa_form_->GetPhis(block).size(); i++)
+            {
+                EvaluatePhi(block, i);
+            }
+            continue;
+        }
+
+        uint32_t variable = variable_worklist_.back();
+        variable_worklist_.pop_back();
+
+        for (const SsaSite &use : uses_[variable])
+        {
+            if (!is_block_visited_[use.block])
+            {
+                continue;
+            }
+
+            if (use.is_phi)
+            {
+                EvaluatePhi(use.block, use.index);
+            }
+            else
+            {
+                EvaluateInstruction(use.block, use.index);
+            }
+        }
+    }
+}
+
+bool SparseConditionalConstantPropagationPass::Rewrite(IrSequence &function,
+                                                       bool &is_branch_folded)
+{
+    const ControlFlowGraph &cfg = ssa_form_->GetControlFlowGraph();
+    bool is_changed = false;
+
+    auto replace_constant = [&](IrOperand &operand)
+    {
+        if (operand.type != IrOperandType::VARIABLE)
+        {
+            return;
+        }
+
+        LatticeValue value = GetValue(operand);
+        if (value.state == LatticeState::CONSTANT)
+        {
+            operand = value.constant;
+            is_changed = true;
+        }
+    };
+
+    for (size_t block : cfg.GetReversePostorder())
+    {
+        // Left to become unreachable once the IFs leading to it are folded
+        if (!is_block_visited_[block])
+        {
+            continue;
+        }
+
+        for (auto &phi : ssa_form_->GetPhis(block))
+        {
+            for (size_t i = 0; i < phi.args.size(); i++)
+            {
+                if (is_edge_executable_[block][i])
+                {
+                    replace_constant(phi.args[i]);
+                }
+                else
+                {
+                    phi.args[i] = IrOperand::None();
+                }
+            }
+        }
+
+        for (size_t i = cfg.GetBlock(block).begin; i < cfg.GetBlock(block).end; i++)
+        {
+            IrInstruction &instruction = function[i];
+
+            ForEachUsedOperand(instruction, replace_constant);
+
+            if (instruction.opcode == IrOpcode::BINARY &&
+                instruction.dest.type == IrOperandType::VARIABLE)
+            {
+                // Both operands constant, or a product with zero
+                LatticeValue value = GetValue(instruction.dest);
+                if (value.state == LatticeState::CONSTANT)
+                {
+                    instruction = {IrOpcode::ASSIGN,
+                                   IrOperator::NONE,
+                                   instruction.dest,
+                                   value.constant,
+                                   IrOperand::None()};
+                    is_changed = true;
+                }
+            }
+
+            int32_t result;
+            if (instruction.opcode == IrOpcode::IF &&
+                instruction.arg1.type == IrOperandType::IMMEDIATE &&
+                instruction.arg2.type == IrOperandType::IMMEDIATE &&
+                ConstantFoldingPass::Evaluate(instruction.op,
+                                              instruction.arg1.GetImmediateValue(),
+                                              instruction.arg2.GetImmediateValue(),
+                                              result))
+            {
+                if (result)
+                {
+                    instruction = {IrOpcode::GOTO,
+                                   IrOperator::NONE,
+                                   instruction.dest,
+                                   IrOperand::None(),
+                                   IrOperand::None()};
+                }
+                else
+                {
+                    ssa_form_->RemoveInstruction(i);
+                }
+
+                is_branch_folded = true;
+                is_changed = true;
+            }
+        }
+    }
+
+    return is_changed;
+}
+
+void SparseConditionalConstantPropagationPass::VisitBlock(const size_t block)
+{
+    const ControlFlowGraph &cfg = ssa_form_->GetControlFlowGraph();
+    const BasicBlock &basic_block = cfg.GetBlock(block);
+
+    is_block_visited_[block] = true;
+
+    for (size_t i = 0; i < ssa_form_->GetPhis(block).size(); i++)
+    {
+        EvaluatePhi(block, i);
+    }
+
+    for (size_t i = basic_block.begin; i < basic_block.end; i++)
+    {
+        EvaluateInstruction(block, i);
+    }
+
+    // IFs mark their fall-through edge themselves, when it may be taken
+    const IrInstruction &last_instruction = cfg.GetLastInstruction(block);
+    if (!EndsControlFlow(last_instruction) &&
+        last_instruction.opcode != IrOpcode::IF &&
+        block + 1 < cfg.GetBlockCount())
+    {
+        MarkEdgeExecutable(block, block + 1);
+    }
+}
+
+void SparseConditionalConstantPropagationPass::EvaluatePhi(const size_t block,
+                                                           const size_t index)
+{
+    const Phi &phi = ssa_form_->GetPhis(block)[index];
+
+    LatticeValue value = Undefined();
+    for (size_t i = 0; i < phi.args.size(); i++)
+    {
+        if (is_edge_executable_[block][i])
+        {
+            value = Meet(value, GetValue(phi.args[i]));
+        }
+    }
+
+    SetValue(phi.dest.value, value);
+}
+
+void SparseConditionalConstantPropagationPass::EvaluateInstruction(const size_t block,
+                                                                   const size_t index)
+{
+    const ControlFlowGraph &cfg = ssa_form_->GetControlFlowGraph();
+    const IrInstruction &instruction = cfg.GetFunction()[index];
+
+    if (instruction.opcode == IrOpcode::GOTO)
+    {
+        MarkEdgeExecutable(block, cfg.GetLabelBlock(instruction.dest.value));
+        return;
+    }
+
+    if (instruction.opcode == IrOpcode::IF)
+    {
+        LatticeValue left = GetValue(instruction.arg1);
+        LatticeValue right = GetValue(instruction.arg2);
+
+        if (left.state == LatticeState::UNDEFINED || right.state == LatticeState::UNDEFINED)
+        {
+            return;
+        }
+
+        int32_t result;
+        bool is_constant = left.state == LatticeState::CONSTANT &&
+                           right.state == LatticeState::CONSTANT &&
+                           left.constant.type == IrOperandType::IMMEDIATE &&
+                           right.constant.type == IrOperandType::IMMEDIATE &&
+                           ConstantFoldingPass::Evaluate(instruction.op,
+                                                         left.constant.GetImmediateValue(),
+                                                         right.constant.GetImmediateValue(),
+                                                         result);
+
+        if ((!is_constant || !result) && block + 1 < cfg.GetBlockCount())
+        {
+            MarkEdgeExecutable(block, block + 1);
+        }
+
+        if (!is_constant || result)
+        {
+            MarkEdgeExecutable(block, cfg.GetLabelBlock(instruction.dest.value));
+        }
+
+        return;
+    }
+
+    const IrOperand *defined_variable = GetDefinedVariable(instruction);
+    if (defined_variable != nullptr && ssa_form_->IsDefined(defined_variable->value))
+    {
+        SetValue(defined_variable->value, EvaluateDefinition(instruction));
+    }
+}
+
+SparseConditionalConstantPropagationPass::LatticeValue
+SparseConditionalConstantPropagationPass::EvaluateDefinition(const IrInstruction &instruction) const
+{
+    if (instruction.opcode == IrOpcode::ASSIGN)
+    {
+        return GetValue(instruction.arg1);
+    }
+
+    if (instruction.opcode != IrOpcode::BINARY)
+    {
+        // CALL, READ and PARAM
+        return Varying();
+    }
+
+    LatticeValue left = GetValue(instruction.arg1);
+    LatticeValue right = GetValue(instruction.arg2);
+
+    auto is_zero = [](const LatticeValue &value)
+    {
+        return value.state == LatticeState::CONSTANT &&
+               value.constant.type == IrOperandType::IMMEDIATE &&
+               value.constant.GetImmediateValue() == 0;
+    };
+
+    // Whatever the other operand turns out to be
+    if (instruction.op == IrOperator::MUL && (is_zero(left) || is_zero(right)))
+    {
+        return Constant(IrOperand::Immediate(0));
+    }
+
+    if (left.state == LatticeState::UNDEFINED || right.state == LatticeState::UNDEFINED)
+    {
+        return Undefined();
+    }
+
+    int32_t result;
+    if (left.state == LatticeState::CONSTANT &&
+        right.state == LatticeState::CONSTANT &&
+        left.constant.type == IrOperandType::IMMEDIATE &&
+        right.constant.type == IrOperandType::IMMEDIATE &&
+        ConstantFoldingPass::Evaluate(instruction.op,
+                                      left.constant.GetImmediateValue(),
+                                      right.constant.GetImmediateValue(),
+                                      result))
+    {
+        return Constant(IrOperand::Immediate(result));
+    }
+
+    return Varying();
+}
+
+SparseConditionalConstantPropagationPass::LatticeValue
+SparseConditionalConstantPropagationPass::GetValue(const IrOperand &operand) const
+{
+    switch (operand.type)
+    {
+    case IrOperandType::IMMEDIATE:
+    case IrOperandType::FLOAT_IMMEDIATE:
+        return Constant(operand);
+    case IrOperandType::VARIABLE:
+        // Global variables, and variables read before being assigned, vary
+        if (ssa_form_->IsDefined(operand.value))
+        {
+            auto value = values_.find(operand.value);
+            return value == values_.end() ? Undefined() : value->second;
+        }
+        return Varying();
+    default:
+        return Varying();
+    }
+}
+
+void SparseConditionalConstantPropagationPass::SetValue(const uint32_t variable,
+                                                        const LatticeValue &value)
+{
+    LatticeValue &current_value = values_.try_emplace(variable, Undefined()).first->second;
+
+    // Values only ever go down, so that propagation ends
+    LatticeValue new_value = Meet(current_value, value);
+    if (new_value != current_value)
+    {
+        current_value = new_value;
+        variable_worklist_.push_back(variable);
+    }
+}
+
+void SparseConditionalConstantPropagationPass::MarkEdgeExecutable(const size_t from,
+                                                                  const size_t to)
+{
+    const auto &predecessors = ssa_form_->GetControlFlowGraph().GetBlock(to).predecessors;
+    const size_t predecessor_index =
+        std::find(predecessors.begin(), predecessors.end(), from) - predecessors.begin();
+
+    if (!is_edge_executable_[to][predecessor_index])
+    {
+        is_edge_executable_[to][predecessor_index] = true;
+        block_worklist_.push_back(to);
+    }
+}
+
+SparseConditionalConstantPropagationPass::LatticeValue
+SparseConditionalConstantPropagationPass::Meet(const LatticeValue &a, const LatticeValue &b)
+{
+    if (a.state == LatticeState::UNDEFINED)
+    {
+        return b;
+    }
+
+    if (b.state == LatticeState::UNDEFINED)
+    {
+        return a;
+    }
+
+    if (a.state == LatticeState::VARYING || b.state == LatticeState::VARYING)
+    {
+        return Varying();
+    }
+
+    if (a.constant == b.constant)
+    {
+        return a;
+    }
+
+    // The same integer written differently in the source
+    if (a.constant.type == IrOperandType::IMMEDIATE &&
+        b.constant.type == IrOperandType::IMMEDIATE &&
+        a.constant.value == b.constant.value)
+    {
+        return Constant(IrOperand::Immediate(a.constant.GetImmediateValue()));
+    }
+
+    return Varying();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ir_pass.h"
+#include "ssa_form.h"
+
+// Sparse conditional constant propagation (Wegman and Zadeck) in SSA form.
+// Every SSA variable starts out undefined and is lowered to a constant or
+// to varying as the instructions and phis assigning it are evaluated, while
+// blocks are only evaluated once a jump or fall-through that has been found
+// executable leads to them. A phi merges the values of executable edges only,
+// so unlike ConstantFoldingPass it sees through joins and loops, e.g. a
+// variable that stays constant because the branch changing it never runs.
+//
+// Constant uses are then replaced, IFs with a constant condition turn into a
+// GOTO or disappear and assignments nothing reads are removed, including
+// cycles of them through loops. The function leaves SSA form afterwards, or
+// is left untouched if none of this applied.
+class SparseConditionalConstantPropagationPass : public IrPass
+{
+private:
+    enum class LatticeState : uint8_t
+    {
+        // No assignment evaluated yet, may still become any value
+        UNDEFINED,
+        // Always the IMMEDIATE or FLOAT_IMMEDIATE constant
+        CONSTANT,
+        VARYING
+    };
+
+    struct LatticeValue
+    {
+        LatticeState state;
+        IrOperand constant;
+
+        bool operator==(const LatticeValue &other) const
+        {
+            return state == other.state &&
+                   (state != LatticeState::CONSTANT || constant == other.constant);
+        }
+
+        bool operator!=(const LatticeValue &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    SsaForm *ssa_form_;
+
+    // Maps SSA variable number to its value, UNDEFINED if absent
+    std::unordered_map<uint32_t, LatticeValue> values_;
+    // Maps SSA variable number to the instructions and phis reading it
+    std::unordered_map<uint32_t, std::vector<SsaSite>> uses_;
+    // Indexed by block, then by predecessor index
+    std::vector<std::vector<bool>> is_edge_executable_;
+    std::vector<bool> is_block_visited_;
+
+    // Blocks with a new executable edge, and variables whose value changed
+    std::vector<size_t> block_worklist_;
+    std::vector<uint32_t> variable_worklist_;
+
+public:
+    const char *GetName() const override
+    {
+        return "sparse-conditional-constant-propagation";
+    }
+
+    bool Run(IrSequence &function, const IrProgramInfo &program_info) override;
+
+private:
+    void Propagate();
+    // Replaces constant uses and folds IFs. Returns whether anything changed.
+    // Sets is_branch_folded if an IF was folded.
+    bool Rewrite(IrSequence &function, bool &is_branch_folded);
+
+    void VisitBlock(const size_t block);
+    void EvaluatePhi(const size_t block, const size_t index);
+    void EvaluateInstruction(const size_t block, const size_t index);
+    LatticeValue EvaluateDefinition(const IrInstruction &instruction) const;
+    LatticeValue GetValue(const IrOperand &operand) const;
+    void SetValue(const uint32_t variable, const LatticeValue &value);
+    void MarkEdgeExecutable(const size_t from, const size_t to);
+
+    static LatticeValue Meet(const LatticeValue &a, const LatticeValue &b);
+
+    static LatticeValue Undefined()
+    {
+        return {LatticeState::UNDEFINED, IrOperand::None()};
+    }
+
+    static LatticeValue Constant(const IrOperand &constant)
+    {
+        return {LatticeState::CONSTANT, constant};
+    }
+
+    static LatticeValue Varying()
+    {
+        return {LatticeState::VARYING, IrOperand::None()};
+    }
+};
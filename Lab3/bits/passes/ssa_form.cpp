@@ -0,0 +1,522 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "dominator_tree.h"
+#include "ir_operands.h"
+#include "liveness.h"
+#include "ssa_form.h"
+
+SsaForm::SsaForm(IrSequence &function, const IrProgramInfo &program_info)
+    : function_(function),
+      program_info_(program_info),
+      cfg_(function),
+      phis_(cfg_.GetBlockCount()),
+      is_removed_(function.size(), false)
+{
+    Liveness liveness(cfg_, program_info);
+    DominatorTree dominator_tree(cfg_);
+
+    // Reads and writes through an address bypass the variable's name
+    std::vector<bool> is_renamable(liveness.GetVariableCount(), true);
+    for (auto &instruction : function_)
+    {
+        for (auto operand : {&instruction.dest, &instruction.arg1, &instruction.arg2})
+        {
+            if (operand->type == IrOperandType::ADDRESS && liveness.IsTracked(operand->value))
+            {
+                is_renamable[liveness.GetVariableIndex(operand->value)] = false;
+            }
+        }
+    }
+
+    auto phi_variables = PlacePhis(dominator_tree, liveness, is_renamable);
+    Rename(dominator_tree, liveness, is_renamable, phi_variables);
+}
+
+std::vector<std::vector<size_t>> SsaForm::PlacePhis(const DominatorTree &dominator_tree,
+                                                    const Liveness &liveness,
+                                                    const std::vector<bool> &is_renamable)
+{
+    constexpr size_t kNone = SIZE_MAX;
+
+    const size_t block_count = cfg_.GetBlockCount();
+    const size_t variable_count = liveness.GetVariableCount();
+
+    std::vector<std::vector<size_t>> defining_blocks(variable_count);
+    for (size_t block : cfg_.GetReversePostorder())
+    {
+        for (size_t i = cfg_.GetBlock(block).begin; i < cfg_.GetBlock(block).end; i++)
+        {
+            const IrOperand *defined_variable = GetDefinedVariable(function_[i]);
+            if (defined_variable == nullptr || !liveness.IsTracked(defined_variable->value))
+            {
+                continue;
+            }
+
+            size_t index = liveness.GetVariableIndex(defined_variable->value);
+            if (is_renamable[index] &&
+                (defining_blocks[index].empty() || defining_blocks[index].back() != block))
+            {
+                defining_blocks[index].push_back(block);
+            }
+        }
+    }
+
+    const auto frontiers = dominator_tree.ComputeDominanceFrontiers();
+
+    std::vector<std::vector<size_t>> phi_variables(block_count);
+    // Hold the index of the last variable that had a phi placed in or was
+    // queued for each block, so that they need no clearing between variables
+    std::vector<size_t> phi_marks(block_count, kNone);
+    std::vector<size_t> queue_marks(block_count, kNone);
+    std::vector<size_t> worklist;
+
+    for (size_t i = 0; i < variable_count; i++)
+    {
+        if (!is_renamable[i])
+        {
+            continue;
+        }
+
+        worklist = defining_blocks[i];
+        for (size_t block : worklist)
+        {
+            queue_marks[block] = i;
+        }
+
+        // A phi assigns the variable too, so its own frontier needs phis
+        while (!worklist.empty())
+        {
+            size_t block = worklist.back();
+            worklist.pop_back();
+
+            for (size_t frontier_block : frontiers[block])
+            {
+                if (phi_marks[frontier_block] != i)
+                {
+                    phi_marks[frontier_block] = i;
+
+                    // Where the variable is dead its value is never merged
+                    if (liveness.IsLiveIn(frontier_block, i))
+                    {
+                        phis_[frontier_block].push_back(
+                            {IrOperand::Variable(liveness.GetVariable(i)),
+                             std::vector<IrOperand>(
+                                 cfg_.GetBlock(frontier_block).predecessors.size(),
+                                 IrOperand::None()),
+                             false});
+                        phi_variables[frontier_block].push_back(i);
+                    }
+                }
+
+                if (queue_marks[frontier_block] != i)
+                {
+                    queue_marks[frontier_block] = i;
+                    worklist.push_back(frontier_block);
+                }
+            }
+        }
+    }
+
+    return phi_variables;
+}
+
+void SsaForm::Rename(const DominatorTree &dominator_tree,
+                     const Liveness &liveness,
+                     const std::vector<bool> &is_renamable,
+                     const std::vector<std::vector<size_t>> &phi_variables)
+{
+    if (cfg_.GetReversePostorder().empty())
+    {
+        return;
+    }
+
+    // The names each variable currently has, innermost last. A variable read
+    // before being assigned keeps its own.
+    std::vector<std::vector<uint32_t>> names(liveness.GetVariableCount());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        names[i].push_back(liveness.GetVariable(i));
+    }
+
+    // Variables each block on the walk gave a new name, to restore on leaving it
+    std::vector<std::vector<size_t>> renamed_variables(cfg_.GetBlockCount());
+
+    auto get_renamable_index = [&](const IrOperand &operand)
+    {
+        if ((operand.type == IrOperandType::VARIABLE ||
+             operand.type == IrOperandType::DEREFERENCE) &&
+            liveness.IsTracked(operand.value))
+        {
+            size_t index = liveness.GetVariableIndex(operand.value);
+            if (is_renamable[index])
+            {
+                return index;
+            }
+        }
+
+        return SIZE_MAX;
+    };
+
+    auto rename_block = [&](const size_t block)
+    {
+        auto assign = [&](IrOperand &dest, const size_t index, const SsaSite &site)
+        {
+            uint32_t name = program_info_.allocate_variable();
+            dest.value = name;
+            names[index].push_back(name);
+            renamed_variables[block].push_back(index);
+            definitions_[name] = site;
+        };
+
+        for (size_t i = 0; i < phis_[block].size(); i++)
+        {
+            assign(phis_[block][i].dest, phi_variables[block][i], {block, i, true});
+        }
+
+        for (size_t i = cfg_.GetBlock(block).begin; i < cfg_.GetBlock(block).end; i++)
+        {
+            IrInstruction &instruction = function_[i];
+
+            ForEachUsedOperand(instruction,
+                               [&](IrOperand &operand)
+                               {
+                                   size_t index = get_renamable_index(operand);
+                                   if (index != SIZE_MAX)
+                                   {
+                                       operand.value = names[index].back();
+                                   }
+                               });
+
+            if (GetDefinedVariable(instruction) != nullptr)
+            {
+                size_t index = get_renamable_index(instruction.dest);
+                if (index != SIZE_MAX)
+                {
+                    assign(instruction.dest, index, {block, i, false});
+                }
+            }
+        }
+
+        for (size_t successor : cfg_.GetBlock(block).successors)
+        {
+            const auto &predecessors = cfg_.GetBlock(successor).predecessors;
+            const size_t predecessor_index =
+                std::find(predecessors.begin(), predecessors.end(), block) -
+                predecessors.begin();
+
+            for (size_t i = 0; i < phis_[successor].size(); i++)
+            {
+                phis_[successor][i].args[predecessor_index] =
+                    IrOperand::Variable(names[phi_variables[successor][i]].back());
+            }
+        }
+    };
+
+    // Iterative, as the tree is as deep as the statements are nested
+    std::vector<std::pair<size_t, size_t>> stack;
+    const size_t entry = cfg_.GetReversePostorder().front();
+    rename_block(entry);
+    stack.push_back({entry, 0});
+
+    while (!stack.empty())
+    {
+        auto &[block, next_child] = stack.back();
+        const auto &children = dominator_tree.GetChildren(block);
+
+        if (next_child == children.size())
+        {
+            for (size_t index : renamed_variables[block])
+            {
+                names[index].pop_back();
+            }
+            stack.pop_back();
+            continue;
+        }
+
+        size_t child = children[next_child++];
+        rename_block(child);
+        stack.push_back({child, 0});
+    }
+}
+
+bool SsaForm::RemoveDeadDefinitions()
+{
+    std::unordered_set<uint32_t> live_variables;
+    std::vector<SsaSite> worklist;
+
+    auto mark_live = [&](const IrOperand &operand)
+    {
+        if ((operand.type == IrOperandType::VARIABLE ||
+             operand.type == IrOperandType::DEREFERENCE) &&
+            IsDefined(operand.value) &&
+            live_variables.insert(operand.value).second)
+        {
+            worklist.push_back(definitions_.at(operand.value));
+        }
+    };
+
+    // Whether instruction only assigns an SSA variable
+    auto is_pure_definition = [this](const IrInstruction &instruction)
+    {
+        return !HasSideEffect(instruction) && IsDefined(instruction.dest.value);
+    };
+
+    // Everything else is needed, and so are the variables it reads
+    for (size_t block : cfg_.GetReversePostorder())
+    {
+        for (size_t i = cfg_.GetBlock(block).begin; i < cfg_.GetBlock(block).end; i++)
+        {
+            if (!is_removed_[i] && !is_pure_definition(function_[i]))
+            {
+                ForEachUsedOperand(function_[i], mark_live);
+            }
+        }
+    }
+
+    while (!worklist.empty())
+    {
+        SsaSite definition = worklist.back();
+        worklist.pop_back();
+
+        if (definition.is_phi)
+        {
+            for (auto &arg : phis_[definition.block][definition.index].args)
+            {
+                mark_live(arg);
+            }
+        }
+        else
+        {
+            ForEachUsedOperand(function_[definition.index], mark_live);
+        }
+    }
+
+    bool is_changed = false;
+
+    for (size_t block : cfg_.GetReversePostorder())
+    {
+        for (auto &phi : phis_[block])
+        {
+            if (!phi.is_removed && live_variables.count(phi.dest.value) == 0)
+            {
+                phi.is_removed = true;
+                is_changed = true;
+            }
+        }
+
+        for (size_t i = cfg_.GetBlock(block).begin; i < cfg_.GetBlock(block).end; i++)
+        {
+            IrInstruction &instruction = function_[i];
+            if (is_removed_[i] ||
+                instruction.dest.type != IrOperandType::VARIABLE ||
+                !IsDefined(instruction.dest.value) ||
+                live_variables.count(instruction.dest.value) > 0)
+            {
+                continue;
+            }
+
+            if (is_pure_definition(instruction))
+            {
+                is_removed_[i] = true;
+                is_changed = true;
+            }
+            else if (instruction.opcode == IrOpcode::CALL)
+            {
+                instruction.dest = IrOperand::None();
+                is_changed = true;
+            }
+        }
+    }
+
+    return is_changed;
+}
+
+void SsaForm::Destruct()
+{
+    const size_t block_count = cfg_.GetBlockCount();
+
+    // Copies on the edge from block to successor, for the phis of successor
+    auto collect_copies = [this](const size_t block, const size_t successor)
+    {
+        std::vector<std::pair<IrOperand, IrOperand>> copies;
+
+        const auto &predecessors = cfg_.GetBlock(successor).predecessors;
+        const size_t predecessor_index =
+            std::find(predecessors.begin(), predecessors.end(), block) - predecessors.begin();
+
+        for (auto &phi : phis_[successor])
+        {
+            const IrOperand &arg = phi.args[predecessor_index];
+            if (!phi.is_removed && arg.type != IrOperandType::NONE && arg != phi.dest)
+            {
+                copies.push_back({phi.dest, arg});
+            }
+        }
+
+        return copies;
+    };
+
+    // A block reached from an IF through copies, placed right before
+    // the IF's target
+    struct EdgeBlock
+    {
+        uint32_t label;
+        IrSequence copies;
+    };
+
+    // Indexed by the block they lead to
+    std::vector<std::vector<EdgeBlock>> edge_blocks(block_count);
+    // For each block, copies to run last if it falls through, and before
+    // its GOTO if it ends with one
+    std::vector<IrSequence> exit_copies(block_count);
+
+    for (size_t i = 0; i < block_count; i++)
+    {
+        if (!cfg_.IsReachable(i))
+        {
+            continue;
+        }
+
+        const BasicBlock &block = cfg_.GetBlock(i);
+
+        size_t last = block.end;
+        while (last > block.begin && is_removed_[last - 1])
+        {
+            last--;
+        }
+
+        const IrInstruction *last_instruction = last > block.begin ? &function_[last - 1] : nullptr;
+
+        if (last_instruction == nullptr || !EndsControlFlow(*last_instruction))
+        {
+            if (i + 1 < block_count)
+            {
+                auto copies = collect_copies(i, i + 1);
+                AppendParallelCopies(copies, exit_copies[i]);
+            }
+        }
+
+        if (last_instruction != nullptr && IsJump(*last_instruction))
+        {
+            const size_t target = cfg_.GetLabelBlock(last_instruction->dest.value);
+            auto copies = collect_copies(i, target);
+            if (copies.empty())
+            {
+                continue;
+            }
+
+            if (last_instruction->opcode == IrOpcode::GOTO)
+            {
+                AppendParallelCopies(copies, exit_copies[i]);
+                continue;
+            }
+
+            // Copies placed before an IF would also run when it falls through
+            EdgeBlock edge_block{program_info_.allocate_label(), {}};
+            AppendParallelCopies(copies, edge_block.copies);
+            edge_blocks[target].push_back(std::move(edge_block));
+            function_[last - 1].dest = IrOperand::Label(edge_blocks[target].back().label);
+        }
+    }
+
+    IrSequence sequence;
+    sequence.reserve(function_.size());
+
+    for (size_t i = 0; i < block_count; i++)
+    {
+        if (!cfg_.IsReachable(i))
+        {
+            continue;
+        }
+
+        const BasicBlock &block = cfg_.GetBlock(i);
+
+        for (auto &edge_block : edge_blocks[i])
+        {
+            // Jumping over it keeps the code falling through in the block
+            if (!EndsControlFlow(sequence.back()))
+            {
+                sequence.push_back({IrOpcode::GOTO,
+                                    IrOperator::NONE,
+                                    function_[block.begin].dest,
+                                    IrOperand::None(),
+                                    IrOperand::None()});
+            }
+
+            sequence.push_back({IrOpcode::LABEL,
+                                IrOperator::NONE,
+                                IrOperand::Label(edge_block.label),
+                                IrOperand::None(),
+                                IrOperand::None()});
+            sequence.insert(sequence.end(), edge_block.copies.begin(), edge_block.copies.end());
+        }
+
+        for (size_t j = block.begin; j < block.end; j++)
+        {
+            if (is_removed_[j])
+            {
+                continue;
+            }
+
+            if (function_[j].opcode == IrOpcode::GOTO)
+            {
+                sequence.insert(sequence.end(), exit_copies[i].begin(), exit_copies[i].end());
+                exit_copies[i].clear();
+            }
+
+            sequence.push_back(function_[j]);
+        }
+
+        sequence.insert(sequence.end(), exit_copies[i].begin(), exit_copies[i].end());
+    }
+
+    function_ = std::move(sequence);
+}
+
+void SsaForm::AppendParallelCopies(std::vector<std::pair<IrOperand, IrOperand>> &copies,
+                                   IrSequence &sequence) const
+{
+    auto append_copy = [&sequence](const IrOperand &dest, const IrOperand &src)
+    {
+        sequence.push_back({IrOpcode::ASSIGN, IrOperator::NONE, dest, src, IrOperand::None()});
+    };
+
+    auto is_read = [&copies](const IrOperand &variable)
+    {
+        return std::any_of(copies.begin(),
+                           copies.end(),
+                           [&variable](const std::pair<IrOperand, IrOperand> &copy)
+                           { return copy.second == variable; });
+    };
+
+    while (!copies.empty())
+    {
+        // A copy may go once no other copy still reads the variable it assigns
+        auto ready_copy = std::find_if(copies.begin(),
+                                       copies.end(),
+                                       [&is_read](const std::pair<IrOperand, IrOperand> &copy)
+                                       { return !is_read(copy.first); });
+
+        if (ready_copy != copies.end())
+        {
+            append_copy(ready_copy->first, ready_copy->second);
+            copies.erase(ready_copy);
+            continue;
+        }
+
+        // The remaining copies form cycles, e.g. a swap. Saving one assigned
+        // variable elsewhere frees its copy.
+        const IrOperand saved = IrOperand::Variable(program_info_.allocate_variable());
+        const IrOperand dest = copies.front().first;
+        append_copy(saved, dest);
+
+        for (auto &copy : copies)
+        {
+            if (copy.second == dest)
+            {
+                copy.second = saved;
+            }
+        }
+    }
+}
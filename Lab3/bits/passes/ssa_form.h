@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "control_flow_graph.h"
+#include "ir_pass.h"
+
+class DominatorTree;
+class Liveness;
+
+// A phi at the start of a block: dest := the arg of the predecessor
+// control came from. args is parallel to the predecessors of the block;
+// an arg is NONE for a predecessor that is unreachable or no longer jumps
+// to the block. Args may be immediates once constants are propagated.
+struct Phi
+{
+    IrOperand dest;
+    std::vector<IrOperand> args;
+    bool is_removed;
+};
+
+// An instruction of the function, or a phi of a block, that assigns or
+// reads an SSA variable
+struct SsaSite
+{
+    size_t block;
+    // Instruction index, or phi index within the block
+    size_t index;
+    bool is_phi;
+};
+
+// Static single assignment form of one function, in which every local
+// variable is assigned exactly once. Built by the algorithm of Cytron et al.:
+// a phi for variable x is placed at the iterated dominance frontier of the
+// blocks assigning x, where x is live (pruned SSA), then the variables are
+// renamed walking the dominator tree, each assignment getting a new variable.
+// A variable read before any assignment keeps its original number.
+//
+// Phis are kept beside the function instead of in it, so that the IR needs
+// no phi instruction. Instructions keep their indices while in SSA form:
+// removed instructions are only marked until Destruct().
+// Global variables and variables whose address is taken are left alone.
+class SsaForm
+{
+private:
+    IrSequence &function_;
+    const IrProgramInfo &program_info_;
+    // Built before renaming, and still valid since indices do not change
+    ControlFlowGraph cfg_;
+
+    // Indexed by block
+    std::vector<std::vector<Phi>> phis_;
+    // Maps each variable assigned in SSA form to its definition
+    std::unordered_map<uint32_t, SsaSite> definitions_;
+    std::vector<bool> is_removed_;
+
+public:
+    // Converts function into SSA form. Requires program_info.allocate_variable,
+    // and program_info.allocate_label for Destruct().
+    SsaForm(IrSequence &function, const IrProgramInfo &program_info);
+
+    SsaForm(const SsaForm &) = delete;
+    SsaForm &operator=(const SsaForm &) = delete;
+
+    const ControlFlowGraph &GetControlFlowGraph() const
+    {
+        return cfg_;
+    }
+
+    std::vector<Phi> &GetPhis(const size_t block)
+    {
+        return phis_[block];
+    }
+
+    // Returns whether variable is assigned in SSA form. Variables that are
+    // not are global, address-taken or read before being assigned.
+    bool IsDefined(const uint32_t variable) const
+    {
+        return definitions_.count(variable) > 0;
+    }
+
+    const SsaSite &GetDefinition(const uint32_t variable) const
+    {
+        return definitions_.at(variable);
+    }
+
+    void RemoveInstruction(const size_t index)
+    {
+        is_removed_[index] = true;
+    }
+
+    bool IsRemoved(const size_t index) const
+    {
+        return is_removed_[index];
+    }
+
+    // Deletes phis and assignments whose variables are never read by an
+    // instruction with a side effect, even through a chain of other
+    // variables or a loop. Returns whether anything changed.
+    bool RemoveDeadDefinitions();
+
+    // Leaves SSA form, writing the function back: the phis of each block
+    // become copies at the end of its predecessors, with the edges from
+    // IFs split so that copies only run on the way to their block.
+    // Unreachable blocks are dropped. The form is unusable afterwards.
+    void Destruct();
+
+private:
+    // Places phis for the renamable variables, returning the Liveness index
+    // of the variable of each phi, indexed like phis_
+    std::vector<std::vector<size_t>> PlacePhis(const DominatorTree &dominator_tree,
+                                               const Liveness &liveness,
+                                               const std::vector<bool> &is_renamable);
+    void Rename(const DominatorTree &dominator_tree,
+                const Liveness &liveness,
+                const std::vector<bool> &is_renamable,
+                const std::vector<std::vector<size_t>> &phi_variables);
+    // Appends instructions to sequence that perform the copies dest := src
+    // as if all at once, using a new variable to break cycles
+    void AppendParallelCopies(std::vector<std::pair<IrOperand, IrOperand>> &copies,
+                              IrSequence &sequence) const;
+};
@@ -0,0 +1,438 @@
+#include <utility>
+
+#include "ir_operands.h"
+#include "dominator_tree.h"
+#include "strength_reduction_pass.h"
+
+namespace
+{
+    // Wraps around like the 32-bit ints of the target
+    int32_t MultiplyWrapped(const int32_t a, const int32_t b)
+    {
+        return static_cast<int32_t>(
+            static_cast<uint32_t>(static_cast<int64_t>(a) * b));
+    }
+}
+
+bool StrengthReductionPass::Run(IrSequence &function, const IrProgramInfo &program_info)
+{
+    if (!program_info.allocate_variable)
+    {
+        return false;
+    }
+
+    bool is_changed = false;
+
+    {
+        ControlFlowGraph cfg(function);
+        DominatorTree dominator_tree(cfg);
+        LoopInfo loop_info(cfg, dominator_tree);
+
+        variable_uses_.clear();
+        for (size_t i = 0; i < function.size(); i++)
+        {
+            ForEachUsedOperand(function[i],
+                               [this, i](const IrOperand &operand)
+                               {
+                                   if (operand.type == IrOperandType::VARIABLE ||
+                                       operand.type == IrOperandType::DEREFERENCE)
+                                   {
+                                       variable_uses_[operand.value].push_back(i);
+                                   }
+                               });
+        }
+
+        insertions_.assign(function.size(), {});
+        // An instruction in nested loops is only rewritten for one of them
+        std::vector<bool> is_rewritten(function.size(), false);
+
+        // Rewriting in place keeps indices and the analyses valid
+        for (auto &loop : loop_info.GetLoops())
+        {
+            if (loop.has_preheader)
+            {
+                is_changed |= ReduceLoop(function, cfg, loop, program_info, is_rewritten);
+            }
+        }
+    }
+
+    if (is_changed)
+    {
+        IrSequence reduced_function;
+        reduced_function.reserve(function.size());
+
+        for (size_t i = 0; i < function.size(); i++)
+        {
+            reduced_function.push_back(function[i]);
+            reduced_function.insert(reduced_function.end(),
+                                    insertions_[i].begin(),
+                                    insertions_[i].end());
+        }
+
+        function = std::move(reduced_function);
+    }
+
+    variable_uses_.clear();
+    insertions_.clear();
+
+    return is_changed;
+}
+
+bool StrengthReductionPass::ReduceLoop(IrSequence &function,
+                                       const ControlFlowGraph &cfg,
+                                       const Loop &loop,
+                                       const IrProgramInfo &program_info,
+                                       std::vector<bool> &is_rewritten)
+{
+    // Maps variable number to the instructions assigning it in the loop
+    std::unordered_map<uint32_t, std::vector<size_t>> definitions;
+    for (size_t block : loop.blocks)
+    {
+        for (size_t i = cfg.GetBlock(block).begin; i < cfg.GetBlock(block).end; i++)
+        {
+            const IrOperand *defined_variable = GetDefinedVariable(function[i]);
+            if (defined_variable != nullptr)
+            {
+                definitions[defined_variable->value].push_back(i);
+            }
+        }
+    }
+
+    auto induction_variables = FindInductionVariables(
+        function, cfg, loop, definitions, program_info);
+    if (induction_variables.empty())
+    {
+        return false;
+    }
+
+    auto is_invariant = [&](const IrOperand &operand)
+    {
+        switch (operand.type)
+        {
+        case IrOperandType::IMMEDIATE:
+        case IrOperandType::ADDRESS:
+            return true;
+        case IrOperandType::VARIABLE:
+            return !program_info.IsGlobal(operand) && definitions.count(operand.value) == 0;
+        default:
+            return false;
+        }
+    };
+
+    std::vector<Family> families;
+    std::vector<Reduction> reductions;
+    // Maps variable number to the reduction of its only assignment in the
+    // loop, while that still holds the value of the family
+    std::unordered_map<uint32_t, size_t> reduced_variables;
+
+    // Returns the family set up by initialization, creating it if needed
+    auto get_family = [&](const uint32_t induction_variable,
+                          const int32_t step,
+                          IrInstruction initialization)
+    {
+        for (size_t i = 0; i < families.size(); i++)
+        {
+            const IrInstruction &other = families[i].initialization;
+
+            if (other.op == initialization.op &&
+                other.arg1 == initialization.arg1 &&
+                other.arg2 == initialization.arg2)
+            {
+                return i;
+            }
+        }
+
+        initialization.dest = IrOperand::Variable(program_info.allocate_variable());
+        families.push_back({initialization.dest.value,
+                            induction_variable,
+                            step,
+                            initialization,
+                            false});
+
+        return families.size() - 1;
+    };
+
+    for (size_t block : loop.blocks)
+    {
+        reduced_variables.clear();
+
+        for (size_t i = cfg.GetBlock(block).begin; i < cfg.GetBlock(block).end; i++)
+        {
+            const IrInstruction &instruction = function[i];
+
+            if (instruction.opcode != IrOpcode::BINARY ||
+                instruction.dest.type != IrOperandType::VARIABLE ||
+                program_info.IsGlobal(instruction.dest) ||
+                induction_variables.count(instruction.dest.value) > 0 ||
+                is_rewritten[i])
+            {
+                continue;
+            }
+
+            const IrOperand *variable_operand = nullptr;
+            const IrOperand *other_operand = nullptr;
+
+            // y := i * #k or y := #k * i
+            if (instruction.op == IrOperator::MUL)
+            {
+                for (auto [left, right] : {std::make_pair(&instruction.arg1, &instruction.arg2),
+                                           std::make_pair(&instruction.arg2, &instruction.arg1)})
+                {
+                    if (left->type == IrOperandType::VARIABLE &&
+                        right->type == IrOperandType::IMMEDIATE &&
+                        induction_variables.count(left->value) > 0)
+                    {
+                        variable_operand = left;
+                        other_operand = right;
+                        break;
+                    }
+                }
+
+                if (variable_operand != nullptr)
+                {
+                    auto &induction_variable = induction_variables.at(variable_operand->value);
+
+                    size_t family = get_family(
+                        variable_operand->value,
+                        MultiplyWrapped(induction_variable.step,
+                                        other_operand->GetImmediateValue()),
+                        instruction);
+
+                    reductions.push_back({i, family, variable_operand->value});
+                    reduced_variables[instruction.dest.value] = reductions.size() - 1;
+                }
+
+                continue;
+            }
+
+            // z := y + w, z := w + y or z := y - w, y reduced, w invariant
+            if (instruction.op != IrOperator::ADD && instruction.op != IrOperator::SUB)
+            {
+                continue;
+            }
+
+            for (auto [left, right] : {std::make_pair(&instruction.arg1, &instruction.arg2),
+                                       std::make_pair(&instruction.arg2, &instruction.arg1)})
+            {
+                if (instruction.op == IrOperator::SUB && left != &instruction.arg1)
+                {
+                    break;
+                }
+
+                if (left->type == IrOperandType::VARIABLE &&
+                    reduced_variables.count(left->value) > 0 &&
+                    definitions.at(left->value).size() == 1 &&
+                    is_invariant(*right))
+                {
+                    variable_operand = left;
+                    other_operand = right;
+                    break;
+                }
+            }
+
+            if (variable_operand == nullptr)
+            {
+                continue;
+            }
+
+            const Reduction &source = reductions[reduced_variables.at(variable_operand->value)];
+            const Family &source_family = families[source.family];
+
+            // The induction variable must not have been advanced since
+            size_t update = induction_variables.at(source_family.induction_variable).update;
+            if (source.instruction < update && update < i)
+            {
+                continue;
+            }
+
+            IrInstruction initialization = instruction;
+            *(variable_operand == &instruction.arg1
+                  ? &initialization.arg1
+                  : &initialization.arg2) = IrOperand::Variable(source_family.variable);
+
+            size_t family = get_family(source_family.induction_variable,
+                                       source_family.step,
+                                       initialization);
+
+            reductions.push_back({i, family, variable_operand->value});
+            reduced_variables[instruction.dest.value] = reductions.size() - 1;
+        }
+    }
+
+    if (reductions.empty())
+    {
+        return false;
+    }
+
+    // Maps instruction index to the variable its reduction read
+    std::unordered_map<size_t, uint32_t> reduction_sources;
+    for (auto &reduction : reductions)
+    {
+        reduction_sources[reduction.instruction] = reduction.source;
+    }
+
+    // An instruction whose variable is only read by reductions of it will
+    // be dead once they are rewritten, so it is left for dead code elimination
+    bool is_changed = false;
+
+    for (auto &reduction : reductions)
+    {
+        IrInstruction &instruction = function[reduction.instruction];
+        bool is_read_elsewhere = false;
+
+        auto uses = variable_uses_.find(instruction.dest.value);
+        if (uses != variable_uses_.end())
+        {
+            for (size_t use : uses->second)
+            {
+                auto use_source = reduction_sources.find(use);
+                if (use_source == reduction_sources.end() ||
+                    use_source->second != instruction.dest.value)
+                {
+                    is_read_elsewhere = true;
+                    break;
+                }
+            }
+        }
+
+        if (!is_read_elsewhere)
+        {
+            continue;
+        }
+
+        Family &family = families[reduction.family];
+        family.is_read_in_loop = true;
+
+        instruction.opcode = IrOpcode::ASSIGN;
+        instruction.op = IrOperator::NONE;
+        instruction.arg1 = IrOperand::Variable(family.variable);
+        instruction.arg2 = IrOperand::None();
+        is_rewritten[reduction.instruction] = true;
+        is_changed = true;
+    }
+
+    if (!is_changed)
+    {
+        return false;
+    }
+
+    // Families are created after those they are initialized from, so
+    // initializing them in order is safe. Unused ones are left to dead
+    // code elimination.
+    const size_t preheader_end = cfg.GetBlock(LoopInfo::GetPreheader(loop)).end;
+
+    for (auto &family : families)
+    {
+        insertions_[preheader_end - 1].push_back(family.initialization);
+
+        if (!family.is_read_in_loop)
+        {
+            continue;
+        }
+
+        IrInstruction advance = {IrOpcode::BINARY,
+                                 IrOperator::ADD,
+                                 IrOperand::Variable(family.variable),
+                                 IrOperand::Variable(family.variable),
+                                 IrOperand::Immediate(family.step)};
+        insertions_[induction_variables.at(family.induction_variable).update].push_back(advance);
+    }
+
+    return true;
+}
+
+std::unordered_map<uint32_t, StrengthReductionPass::InductionVariable>
+StrengthReductionPass::FindInductionVariables(
+    const IrSequence &function,
+    const ControlFlowGraph &cfg,
+    const Loop &loop,
+    const std::unordered_map<uint32_t, std::vector<size_t>> &definitions,
+    const IrProgramInfo &program_info)
+{
+    std::unordered_map<uint32_t, InductionVariable> induction_variables;
+
+    for (auto &[variable, variable_definitions] : definitions)
+    {
+        if (variable_definitions.size() != 1 ||
+            program_info.IsGlobal(IrOperand::Variable(variable)))
+        {
+            continue;
+        }
+
+        size_t update = variable_definitions.front();
+        const IrInstruction &instruction = function[update];
+        int32_t step;
+
+        // i := i +/- #c
+        if (GetIncrement(instruction, variable, step))
+        {
+            induction_variables[variable] = {step, update};
+            continue;
+        }
+
+        // t := i +/- #c; i := t, with t assigned once, earlier in the same block
+        if (instruction.opcode != IrOpcode::ASSIGN ||
+            instruction.arg1.type != IrOperandType::VARIABLE)
+        {
+            continue;
+        }
+
+        auto temporary_definitions = definitions.find(instruction.arg1.value);
+        if (temporary_definitions == definitions.end() ||
+            temporary_definitions->second.size() != 1)
+        {
+            continue;
+        }
+
+        size_t increment = temporary_definitions->second.front();
+        bool is_same_block = false;
+        for (size_t block : loop.blocks)
+        {
+            const BasicBlock &basic_block = cfg.GetBlock(block);
+            if (basic_block.begin <= update && update < basic_block.end)
+            {
+                is_same_block = basic_block.begin <= increment && increment < update;
+                break;
+            }
+        }
+
+        if (is_same_block && GetIncrement(function[increment], variable, step))
+        {
+            induction_variables[variable] = {step, update};
+        }
+    }
+
+    return induction_variables;
+}
+
+bool StrengthReductionPass::GetIncrement(const IrInstruction &instruction,
+                                         const uint32_t variable,
+                                         int32_t &step)
+{
+    if (instruction.opcode != IrOpcode::BINARY ||
+        (instruction.op != IrOperator::ADD && instruction.op != IrOperator::SUB))
+    {
+        return false;
+    }
+
+    const IrOperand induction_variable = IrOperand::Variable(variable);
+
+    if (instruction.arg1 == induction_variable &&
+        instruction.arg2.type == IrOperandType::IMMEDIATE)
+    {
+        step = instruction.op == IrOperator::ADD
+                   ? instruction.arg2.GetImmediateValue()
+                   : MultiplyWrapped(instruction.arg2.GetImmediateValue(), -1);
+        return true;
+    }
+
+    if (instruction.op == IrOperator::ADD &&
+        instruction.arg2 == induction_variable &&
+        instruction.arg1.type == IrOperandType::IMMEDIATE)
+    {
+        step = instruction.arg1.GetImmediateValue();
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ir_pass.h"
+#include "control_flow_graph.h"
+#include "loop_info.h"
+
+// Strength reduction of induction variable multiplications.
+// A basic induction variable i of a loop is a local variable assigned once
+// in it, by i := i +/- #c or by t := i +/- #c; i := t. Array indexing
+// computes x := i * #k and then addresses such as y := &a + x or
+// z := y + w with loop-invariant operands. Each of these becomes a copy of
+// a new variable that is set before the loop and advanced by #(c * k)
+// right after i is, turning the multiplication into an addition and the
+// address arithmetic into an incremented pointer.
+// Variables only needed to set up others are not advanced, so a chain
+// i * #k, &a + x collapses into one pointer.
+class StrengthReductionPass : public IrPass
+{
+private:
+    struct InductionVariable
+    {
+        int32_t step;
+        // Index of the instruction assigning it in the loop
+        size_t update;
+    };
+
+    // A new variable equal to some linear function of an induction variable
+    struct Family
+    {
+        uint32_t variable;
+        uint32_t induction_variable;
+        int32_t step;
+        // Sets variable from the induction variable or from a parent family
+        IrInstruction initialization;
+        // Whether some rewritten instruction copies it, so it must be
+        // advanced in the loop rather than only set before it
+        bool is_read_in_loop;
+    };
+
+    // An instruction to be rewritten as a copy of family
+    struct Reduction
+    {
+        size_t instruction;
+        size_t family;
+        // The variable the instruction computed its value from
+        uint32_t source;
+    };
+
+    // Maps variable number to the instructions reading it
+    std::unordered_map<uint32_t, std::vector<size_t>> variable_uses_;
+    // Indexed by instruction, what to insert after it
+    std::vector<IrSequence> insertions_;
+
+public:
+    const char *GetName() const override
+    {
+        return "strength-reduction";
+    }
+
+    bool Run(IrSequence &function, const IrProgramInfo &program_info) override;
+
+private:
+    bool ReduceLoop(IrSequence &function,
+                    const ControlFlowGraph &cfg,
+                    const Loop &loop,
+                    const IrProgramInfo &program_info,
+                    std::vector<bool> &is_rewritten);
+    // Finds the basic induction variables of loop
+    static std::unordered_map<uint32_t, InductionVariable> FindInductionVariables(
+        const IrSequence &function,
+        const ControlFlowGraph &cfg,
+        const Loop &loop,
+        const std::unordered_map<uint32_t, std::vector<size_t>> &definitions,
+        const IrProgramInfo &program_info);
+    // Returns the step of i := i +/- #c, or false if instruction is not one
+    static bool GetIncrement(const IrInstruction &instruction,
+                             const uint32_t variable,
+                             int32_t &step);
+};
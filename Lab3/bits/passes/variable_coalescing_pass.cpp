@@ -0,0 +1,221 @@
+#include <algorithm>
+
+#include "control_flow_graph.h"
+#include "liveness.h"
+#include "variable_coalescing_pass.h"
+
+bool VariableCoalescingPass::Run(IrSequence &function, const IrProgramInfo &program_info)
+{
+    ControlFlowGraph cfg(function);
+    Liveness liveness(cfg, program_info);
+
+    const size_t variable_count = liveness.GetVariableCount();
+    if (variable_count < 2)
+    {
+        return false;
+    }
+
+    interferences_.assign(variable_count, {});
+    copy_partners_.assign(variable_count, {});
+
+    // Variables whose address is taken live in memory under their own name
+    std::vector<bool> is_fixed(variable_count, false);
+    std::vector<size_t> params;
+    for (auto &instruction : function)
+    {
+        for (auto operand : {&instruction.dest, &instruction.arg1, &instruction.arg2})
+        {
+            if (operand->type == IrOperandType::ADDRESS && liveness.IsTracked(operand->value))
+            {
+                is_fixed[liveness.GetVariableIndex(operand->value)] = true;
+            }
+        }
+
+        if (instruction.opcode == IrOpcode::PARAM && liveness.IsTracked(instruction.dest.value))
+        {
+            params.push_back(liveness.GetVariableIndex(instruction.dest.value));
+        }
+    }
+
+    // Each PARAM receives its own argument, even if unused
+    for (size_t i = 0; i < params.size(); i++)
+    {
+        for (size_t j = i + 1; j < params.size(); j++)
+        {
+            AddInterference(params[i], params[j]);
+        }
+    }
+
+    // Walks each block backwards from its live-out set
+    std::vector<bool> is_live(variable_count);
+    std::vector<size_t> live_indices;
+    std::vector<size_t> used_indices;
+
+    for (size_t i = 0; i < cfg.GetBlockCount(); i++)
+    {
+        const BasicBlock &block = cfg.GetBlock(i);
+
+        std::fill(is_live.begin(), is_live.end(), false);
+        live_indices.clear();
+        liveness.ForEachLiveOut(i, [&](const size_t index)
+                                {
+                                    is_live[index] = true;
+                                    live_indices.push_back(index);
+                                });
+
+        for (size_t j = block.end; j-- > block.begin;)
+        {
+            const IrInstruction &instruction = function[j];
+
+            used_indices.clear();
+            const IrOperand *defined_variable = Liveness::VisitInstruction(
+                instruction,
+                program_info,
+                [&](const uint32_t variable)
+                { used_indices.push_back(liveness.GetVariableIndex(variable)); });
+
+            if (defined_variable != nullptr)
+            {
+                size_t defined_index = liveness.GetVariableIndex(defined_variable->value);
+
+                // The source of a copy holds the same value, so it may share the name
+                size_t copy_source = variable_count;
+                if (instruction.opcode == IrOpcode::ASSIGN &&
+                    instruction.arg1.type == IrOperandType::VARIABLE &&
+                    liveness.IsTracked(instruction.arg1.value))
+                {
+                    copy_source = liveness.GetVariableIndex(instruction.arg1.value);
+                    copy_partners_[defined_index].push_back(copy_source);
+                    copy_partners_[copy_source].push_back(defined_index);
+                }
+
+                for (size_t index : live_indices)
+                {
+                    if (index != defined_index && index != copy_source)
+                    {
+                        AddInterference(defined_index, index);
+                    }
+                }
+
+                if (is_live[defined_index])
+                {
+                    is_live[defined_index] = false;
+                    live_indices.erase(std::find(live_indices.begin(),
+                                                 live_indices.end(),
+                                                 defined_index));
+                }
+            }
+
+            for (size_t index : used_indices)
+            {
+                if (!is_live[index])
+                {
+                    is_live[index] = true;
+                    live_indices.push_back(index);
+                }
+            }
+        }
+    }
+
+    // Greedy coloring in order of first appearance. A color is named after
+    // its first variable.
+    constexpr size_t kNoColor = SIZE_MAX;
+    std::vector<size_t> colors(variable_count, kNoColor);
+    std::vector<size_t> color_variables;
+    // Colors of fixed variables, which no other variable may join
+    std::vector<bool> is_fixed_color;
+    // Holds i at the colors of the neighbors of variable i while coloring it
+    std::vector<size_t> forbidden_marks;
+
+    for (size_t i = 0; i < variable_count; i++)
+    {
+        if (is_fixed[i])
+        {
+            colors[i] = color_variables.size();
+            color_variables.push_back(i);
+            is_fixed_color.push_back(true);
+            forbidden_marks.push_back(kNoColor);
+            continue;
+        }
+
+        for (size_t neighbor : interferences_[i])
+        {
+            if (colors[neighbor] != kNoColor)
+            {
+                forbidden_marks[colors[neighbor]] = i;
+            }
+        }
+
+        auto is_allowed = [&](const size_t color)
+        {
+            return forbidden_marks[color] != i && !is_fixed_color[color];
+        };
+
+        size_t color = kNoColor;
+        for (size_t partner : copy_partners_[i])
+        {
+            if (colors[partner] != kNoColor && is_allowed(colors[partner]))
+            {
+                color = colors[partner];
+                break;
+            }
+        }
+
+        for (size_t j = 0; color == kNoColor && j < color_variables.size(); j++)
+        {
+            if (is_allowed(j))
+            {
+                color = j;
+            }
+        }
+
+        if (color == kNoColor)
+        {
+            color = color_variables.size();
+            color_variables.push_back(i);
+            is_fixed_color.push_back(false);
+            forbidden_marks.push_back(kNoColor);
+        }
+
+        colors[i] = color;
+    }
+
+    if (color_variables.size() == variable_count)
+    {
+        return false;
+    }
+
+    auto rename = [&](IrOperand &operand)
+    {
+        if ((operand.type == IrOperandType::VARIABLE ||
+             operand.type == IrOperandType::DEREFERENCE) &&
+            liveness.IsTracked(operand.value))
+        {
+            size_t index = liveness.GetVariableIndex(operand.value);
+            operand.value = liveness.GetVariable(color_variables[colors[index]]);
+        }
+    };
+
+    // Renames in place, then drops the copies that became x := x
+    size_t kept_count = 0;
+    for (size_t i = 0; i < function.size(); i++)
+    {
+        IrInstruction instruction = function[i];
+        rename(instruction.dest);
+        rename(instruction.arg1);
+        rename(instruction.arg2);
+
+        if (instruction.opcode == IrOpcode::ASSIGN &&
+            instruction.dest.type == IrOperandType::VARIABLE &&
+            instruction.arg1.type == IrOperandType::VARIABLE &&
+            instruction.dest.value == instruction.arg1.value)
+        {
+            continue;
+        }
+
+        function[kept_count++] = instruction;
+    }
+    function.resize(kept_count);
+
+    return true;
+}
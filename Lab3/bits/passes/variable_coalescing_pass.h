@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ir_pass.h"
+
+// Renames the local variables of a function so that variables whose
+// lifetimes never overlap share one name, leaving far fewer variables for
+// frames to store. IrGenerator gives every intermediate value its own
+// variable, most of which live for a few instructions only.
+//
+// Two variables interfere if one is assigned while the other is live
+// (Liveness), except that the sides of a copy x := y may share a name.
+// Variables are then given names greedily in order of first appearance,
+// preferring the name of a copy partner so that the copy becomes x := x
+// and is deleted. Global, PARAM and DEC variables keep their own names.
+class VariableCoalescingPass : public IrPass
+{
+private:
+    // Indexed by Liveness variable index
+    std::vector<std::vector<size_t>> interferences_;
+    std::vector<std::vector<size_t>> copy_partners_;
+
+public:
+    const char *GetName() const override
+    {
+        return "variable-coalescing";
+    }
+
+    bool Run(IrSequence &function, const IrProgramInfo &program_info) override;
+
+private:
+    void AddInterference(const size_t first, const size_t second)
+    {
+        interferences_[first].push_back(second);
+        interferences_[second].push_back(first);
+    }
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// Allocator for short-lived objects of one type that are created and
+// dropped over and over, such as the ExpValue of each expression node.
+// Freed blocks go on a free list of the thread and are reused, so only the
+// most objects alive at the same time are ever allocated. The blocks are
+// released when the thread exits.
+template <typename T>
+class PoolAllocator
+{
+private:
+    union Block
+    {
+        Block *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct FreeList
+    {
+        Block *head = nullptr;
+
+        ~FreeList()
+        {
+            while (head != nullptr)
+            {
+                Block *next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    };
+
+    static FreeList &GetFreeList()
+    {
+        thread_local FreeList free_list;
+        return free_list;
+    }
+
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    T *allocate(const std::size_t count)
+    {
+        FreeList &free_list = GetFreeList();
+        if (count != 1 || free_list.head == nullptr)
+        {
+            return static_cast<T *>(::operator new(count * sizeof(Block)));
+        }
+
+        Block *block = free_list.head;
+        free_list.head = block->next;
+        return reinterpret_cast<T *>(block);
+    }
+
+    void deallocate(T *pointer, const std::size_t count)
+    {
+        if (count != 1)
+        {
+            ::operator delete(pointer);
+            return;
+        }
+
+        Block *block = reinterpret_cast<Block *>(pointer);
+        block->next = GetFreeList().head;
+        GetFreeList().head = block;
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &) const
+    {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &) const
+    {
+        return false;
+    }
+};
@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <iomanip>
+
+#include "spill_report.h"
+
+void SpillReport::AddFunction(const std::string &name,
+                              const size_t variable_count,
+                              const size_t spill_count,
+                              const size_t register_count)
+{
+    functions_.push_back({name, variable_count, spill_count, register_count});
+}
+
+void SpillReport::PrintText(std::ostream &stream) const
+{
+    size_t name_width = 28;
+    for (auto &function : functions_)
+    {
+        name_width = std::max(name_width, function.name.size() + 2);
+    }
+
+    stream << "[Spill Report] " << input_path_ << '\n'
+           << std::left << std::setw(name_width) << "Function"
+           << std::setw(12) << "Variables"
+           << std::setw(12) << "Spilled"
+           << "Registers"
+           << '\n';
+
+    size_t total_variable_count = 0;
+    size_t total_spill_count = 0;
+
+    for (auto &function : functions_)
+    {
+        stream << std::setw(name_width) << function.name
+               << std::setw(12) << function.variable_count
+               << std::setw(12) << function.spill_count
+               << function.register_count
+               << '\n';
+
+        total_variable_count += function.variable_count;
+        total_spill_count += function.spill_count;
+    }
+
+    stream << std::setw(name_width) << "Total"
+           << std::setw(12) << total_variable_count
+           << total_spill_count
+           << '\n';
+    stream.flush();
+}
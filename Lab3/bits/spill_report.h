@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Collects how many variables of each function of one compilation the
+// register allocator of a backend left in memory, and prints it as a table.
+class SpillReport
+{
+private:
+    struct FunctionAllocation
+    {
+        std::string name;
+        // Non-global variables, each with one live interval
+        size_t variable_count;
+        size_t spill_count;
+        // Distinct registers given to variables
+        size_t register_count;
+    };
+
+    const std::string input_path_;
+
+    std::vector<FunctionAllocation> functions_;
+
+public:
+    explicit SpillReport(const std::string &input_path)
+        : input_path_(input_path) {}
+
+    void AddFunction(const std::string &name,
+                     const size_t variable_count,
+                     const size_t spill_count,
+                     const size_t register_count);
+
+    void PrintText(std::ostream &stream) const;
+};
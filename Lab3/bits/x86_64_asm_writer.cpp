@@ -0,0 +1,549 @@
+#include <algorithm>
+#include <iostream>
+
+#include "x86_64_asm_writer.h"
+
+namespace
+{
+    // System V integer argument registers, 32-bit names
+    const char *const kArgumentRegisters[] = {"edi", "esi", "edx", "ecx", "r8d", "r9d"};
+    constexpr size_t kArgumentRegisterCount = 6;
+}
+
+X86_64AsmWriter::X86_64AsmWriter(const std::string &path, const Interner *interner)
+    : file_(path),
+      interner_(interner),
+      printer_(interner),
+      has_translation_error_(false),
+      global_size_(0),
+      is_stack_overflow_used_(false),
+      dec_size_(0)
+{
+    file_ << "# Link with Lab3/runtime/x86_64_runtime.c\n"
+          << "    .text\n";
+}
+
+void X86_64AsmWriter::Consume(const IrSequence &sequence)
+{
+    if (sequence.empty())
+    {
+        return;
+    }
+
+    if (sequence.front().opcode == IrOpcode::FUNCTION)
+    {
+        WriteFunction(sequence);
+        return;
+    }
+
+    for (auto &instruction : sequence)
+    {
+        if (instruction.opcode == IrOpcode::GLOBAL_DEC)
+        {
+            global_addresses_[instruction.dest.value] = global_size_;
+            // Keeps every global 4-byte aligned
+            global_size_ += (instruction.arg1.value + 3) & ~3u;
+        }
+    }
+}
+
+bool X86_64AsmWriter::Close()
+{
+    if (!file_.is_open())
+    {
+        return false;
+    }
+
+    // Called by the runtime with the memory and its size. Saves the
+    // registers reserved for them, which are callee-saved for C.
+    file_ << "\n"
+          << "    .globl __cmm_entry\n"
+          << "    .type __cmm_entry, @function\n"
+          << "__cmm_entry:\n"
+          << "    pushq %r15\n"
+          << "    pushq %r14\n"
+          << "    subq $8, %rsp\n"
+          << "    movq %rdi, %r15\n"
+          << "    movl %esi, %r14d\n"
+          << "    call cmm_main\n"
+          << "    addq $8, %rsp\n"
+          << "    popq %r14\n"
+          << "    popq %r15\n"
+          << "    ret\n"
+          << "    .size __cmm_entry, .-__cmm_entry\n";
+
+    if (is_stack_overflow_used_)
+    {
+        file_ << ".Lstack_overflow:\n"
+              << "    call __cmm_stack_overflow\n";
+    }
+
+    file_ << "\n"
+          << "    .section .rodata\n"
+          << "    .globl __cmm_global_size\n"
+          << "    .align 4\n"
+          << "__cmm_global_size:\n"
+          << "    .long " << global_size_ << '\n'
+          << "    .section .note.GNU-stack,\"\",@progbits\n";
+
+    file_.close();
+
+    return !file_.fail();
+}
+
+void X86_64AsmWriter::PrintError(const std::string &message)
+{
+    has_translation_error_ = true;
+    // One write per line keeps diagnostics of concurrent compilations apart
+    std::cerr << "x86-64 translation error : " + message + '\n';
+}
+
+void X86_64AsmWriter::WriteFunction(const IrSequence &function)
+{
+    function_name_ = GetFunctionSymbol(function.front().dest.value);
+
+    if (!AllocateFrame(function))
+    {
+        return;
+    }
+
+    WritePrologue(function);
+
+    for (size_t i = 1; i < function.size(); i++)
+    {
+        WriteInstruction(function[i]);
+    }
+
+    // A function may end without RETURN, e.g. with an infinite loop
+    IrOpcode last_opcode = function.back().opcode;
+    if (last_opcode != IrOpcode::RETURN && last_opcode != IrOpcode::GOTO)
+    {
+        file_ << "    xorl %eax, %eax\n";
+        WriteEpilogue();
+    }
+
+    file_ << "    .size " << function_name_ << ", .-" << function_name_ << '\n';
+}
+
+bool X86_64AsmWriter::AllocateFrame(const IrSequence &function)
+{
+    slots_.clear();
+    dec_offsets_.clear();
+    dec_size_ = 0;
+    args_.clear();
+
+    for (auto &instruction : function)
+    {
+        if (instruction.opcode == IrOpcode::DEC)
+        {
+            dec_offsets_[instruction.dest.value] = dec_size_;
+            dec_size_ += (instruction.arg1.value + 3) & ~3u;
+        }
+    }
+
+    for (auto &instruction : function)
+    {
+        if (instruction.opcode == IrOpcode::DEC)
+        {
+            continue;
+        }
+
+        for (const IrOperand *operand : {&instruction.dest, &instruction.arg1, &instruction.arg2})
+        {
+            switch (operand->type)
+            {
+            case IrOperandType::FLOAT_IMMEDIATE:
+                PrintError("Function " + function_name_.substr(4) +
+                           " uses floating point values, which are not supported");
+                return false;
+            case IrOperandType::ADDRESS:
+                if (!IsGlobal(operand->value) && dec_offsets_.count(operand->value) == 0)
+                {
+                    PrintError("Function " + function_name_.substr(4) +
+                               " takes the address of a variable without DEC");
+                    return false;
+                }
+                break;
+            case IrOperandType::VARIABLE:
+            case IrOperandType::DEREFERENCE:
+                if (!IsGlobal(operand->value) && slots_.count(operand->value) == 0)
+                {
+                    int32_t offset = -4 * static_cast<int32_t>(slots_.size() + 1);
+                    slots_[operand->value] = offset;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+void X86_64AsmWriter::WritePrologue(const IrSequence &function)
+{
+    // Keeps %rsp 16-byte aligned at every call
+    size_t frame_size = (slots_.size() * 4 + 15) & ~static_cast<size_t>(15);
+
+    file_ << '\n'
+          << "    .globl " << function_name_ << '\n'
+          << "    .type " << function_name_ << ", @function\n"
+          << function_name_ << ":\n"
+          << "    pushq %rbp\n"
+          << "    movq %rsp, %rbp\n";
+
+    if (frame_size > 0)
+    {
+        file_ << "    subq $" << frame_size << ", %rsp\n";
+    }
+
+    // PARAMs come right after FUNCTION
+    size_t param_index = 0;
+    for (size_t i = 1; i < function.size() && function[i].opcode == IrOpcode::PARAM; i++)
+    {
+        const std::string location = GetVariableLocation(function[i].dest.value);
+
+        if (param_index < kArgumentRegisterCount)
+        {
+            file_ << "    movl %" << kArgumentRegisters[param_index] << ", " << location << '\n';
+        }
+        else
+        {
+            // Above the return address and the saved %rbp
+            file_ << "    movl " << 16 + 8 * (param_index - kArgumentRegisterCount)
+                  << "(%rbp), %eax\n"
+                  << "    movl %eax, " << location << '\n';
+        }
+
+        param_index++;
+    }
+
+    if (dec_size_ > 0)
+    {
+        is_stack_overflow_used_ = true;
+        file_ << "    subl $" << dec_size_ << ", %r14d\n"
+              << "    jb .Lstack_overflow\n"
+              << "    cmpl __cmm_stack_limit(%rip), %r14d\n"
+              << "    jb .Lstack_overflow\n";
+    }
+}
+
+void X86_64AsmWriter::WriteEpilogue()
+{
+    if (dec_size_ > 0)
+    {
+        file_ << "    addl $" << dec_size_ << ", %r14d\n";
+    }
+
+    file_ << "    leave\n"
+          << "    ret\n";
+}
+
+void X86_64AsmWriter::WriteInstruction(const IrInstruction &instruction)
+{
+    if (instruction.opcode == IrOpcode::LABEL)
+    {
+        file_ << GetLabel(instruction.dest) << ":\n";
+        return;
+    }
+
+    line_.clear();
+    printer_.Print(instruction, line_);
+    file_ << "    # " << line_ << '\n';
+
+    switch (instruction.opcode)
+    {
+    case IrOpcode::ASSIGN:
+        if (instruction.arg1.type == IrOperandType::IMMEDIATE &&
+            instruction.dest.type == IrOperandType::VARIABLE)
+        {
+            file_ << "    movl $" << instruction.arg1.GetImmediateValue() << ", "
+                  << GetVariableLocation(instruction.dest.value) << '\n';
+            break;
+        }
+
+        WriteLoad(instruction.arg1, "eax");
+        WriteStore(instruction.dest);
+        break;
+
+    case IrOpcode::BINARY:
+    {
+        const IrOperand *left = &instruction.arg1;
+        const IrOperand *right = &instruction.arg2;
+
+        // Immediates can only be the source operand
+        if ((instruction.op == IrOperator::ADD || instruction.op == IrOperator::MUL) &&
+            left->type == IrOperandType::IMMEDIATE)
+        {
+            std::swap(left, right);
+        }
+
+        WriteLoad(*left, "eax");
+
+        // idivl traps on INT_MIN / -1, which wraps to INT_MIN like in the VM
+        if (instruction.op == IrOperator::DIV && right->type == IrOperandType::IMMEDIATE &&
+            right->GetImmediateValue() == -1)
+        {
+            file_ << "    negl %eax\n";
+            WriteStore(instruction.dest);
+            break;
+        }
+
+        std::string source = GetDirectSource(*right);
+        if (source.empty() ||
+            (instruction.op == IrOperator::DIV && right->type == IrOperandType::IMMEDIATE))
+        {
+            WriteLoad(*right, "ecx");
+            source = "%ecx";
+        }
+
+        switch (instruction.op)
+        {
+        case IrOperator::ADD:
+            file_ << "    addl " << source << ", %eax\n";
+            break;
+        case IrOperator::SUB:
+            file_ << "    subl " << source << ", %eax\n";
+            break;
+        case IrOperator::MUL:
+            if (right->type == IrOperandType::IMMEDIATE)
+            {
+                file_ << "    imull " << source << ", %eax, %eax\n";
+            }
+            else
+            {
+                file_ << "    imull " << source << ", %eax\n";
+            }
+            break;
+        case IrOperator::DIV:
+            if (right->type == IrOperandType::IMMEDIATE)
+            {
+                file_ << "    cltd\n"
+                      << "    idivl " << source << '\n';
+                break;
+            }
+
+            file_ << "    cmpl $-1, " << source << "\n"
+                  << "    jne 1f\n"
+                  << "    negl %eax\n"
+                  << "    jmp 2f\n"
+                  << "1:\n"
+                  << "    cltd\n"
+                  << "    idivl " << source << "\n"
+                  << "2:\n";
+            break;
+        default:
+            file_ << "    cmpl " << source << ", %eax\n"
+                  << "    set" << GetConditionSuffix(instruction.op) << " %al\n"
+                  << "    movzbl %al, %eax\n";
+            break;
+        }
+
+        WriteStore(instruction.dest);
+        break;
+    }
+
+    case IrOpcode::CALL:
+        WriteCall(instruction);
+        break;
+
+    case IrOpcode::GOTO:
+        file_ << "    jmp " << GetLabel(instruction.dest) << '\n';
+        break;
+
+    case IrOpcode::IF:
+    {
+        WriteLoad(instruction.arg1, "eax");
+
+        std::string source = GetDirectSource(instruction.arg2);
+        if (source.empty())
+        {
+            WriteLoad(instruction.arg2, "ecx");
+            source = "%ecx";
+        }
+
+        file_ << "    cmpl " << source << ", %eax\n"
+              << "    j" << GetConditionSuffix(instruction.op) << ' '
+              << GetLabel(instruction.dest) << '\n';
+        break;
+    }
+
+    case IrOpcode::RETURN:
+        WriteLoad(instruction.arg1, "eax");
+        WriteEpilogue();
+        break;
+
+    case IrOpcode::ARG:
+        args_.push_back(instruction.arg1);
+        break;
+
+    case IrOpcode::READ:
+        file_ << "    call __cmm_read\n";
+        WriteStore(instruction.dest);
+        break;
+
+    case IrOpcode::WRITE:
+        WriteLoad(instruction.arg1, "edi");
+        file_ << "    call __cmm_write\n";
+        break;
+
+    default:
+        // PARAM is handled by the prologue, DEC by AllocateFrame
+        break;
+    }
+}
+
+void X86_64AsmWriter::WriteCall(const IrInstruction &instruction)
+{
+    // The ARGs before a CALL pass the last argument first
+    std::reverse(args_.begin(), args_.end());
+
+    size_t stack_argument_count =
+        args_.size() > kArgumentRegisterCount ? args_.size() - kArgumentRegisterCount : 0;
+    size_t stack_size = 8 * (stack_argument_count + stack_argument_count % 2);
+
+    if (stack_argument_count % 2 != 0)
+    {
+        file_ << "    subq $8, %rsp\n";
+    }
+
+    // Slots are addressed from %rbp, so pushing does not move them
+    for (size_t i = args_.size(); i > kArgumentRegisterCount; i--)
+    {
+        WriteLoad(args_[i - 1], "eax");
+        file_ << "    pushq %rax\n";
+    }
+
+    for (size_t i = 0; i < args_.size() && i < kArgumentRegisterCount; i++)
+    {
+        WriteLoad(args_[i], kArgumentRegisters[i]);
+    }
+
+    args_.clear();
+
+    file_ << "    call " << GetFunctionSymbol(instruction.arg1.value) << '\n';
+
+    if (stack_size > 0)
+    {
+        file_ << "    addq $" << stack_size << ", %rsp\n";
+    }
+
+    if (instruction.dest.type != IrOperandType::NONE)
+    {
+        WriteStore(instruction.dest);
+    }
+}
+
+void X86_64AsmWriter::WriteLoad(const IrOperand &operand, const char *reg)
+{
+    switch (operand.type)
+    {
+    case IrOperandType::IMMEDIATE:
+        file_ << "    movl $" << operand.GetImmediateValue() << ", %" << reg << '\n';
+        break;
+    case IrOperandType::VARIABLE:
+        file_ << "    movl " << GetVariableLocation(operand.value) << ", %" << reg << '\n';
+        break;
+    case IrOperandType::ADDRESS:
+        if (IsGlobal(operand.value))
+        {
+            file_ << "    movl $" << global_addresses_.at(operand.value) << ", %" << reg << '\n';
+        }
+        else
+        {
+            file_ << "    leal " << dec_offsets_.at(operand.value) << "(%r14), %" << reg << '\n';
+        }
+        break;
+    case IrOperandType::DEREFERENCE:
+        // Writing a 32-bit register zero-extends the address
+        file_ << "    movl " << GetVariableLocation(operand.value) << ", %" << reg << '\n'
+              << "    movl (%r15," << Get64BitRegister(reg) << "), %" << reg << '\n';
+        break;
+    default:
+        break;
+    }
+}
+
+void X86_64AsmWriter::WriteStore(const IrOperand &dest)
+{
+    if (dest.type == IrOperandType::DEREFERENCE)
+    {
+        file_ << "    movl " << GetVariableLocation(dest.value) << ", %ecx\n"
+              << "    movl %eax, (%r15,%rcx)\n";
+    }
+    else
+    {
+        file_ << "    movl %eax, " << GetVariableLocation(dest.value) << '\n';
+    }
+}
+
+std::string X86_64AsmWriter::GetVariableLocation(const uint32_t variable) const
+{
+    auto global_address = global_addresses_.find(variable);
+    if (global_address != global_addresses_.end())
+    {
+        return std::to_string(global_address->second) + "(%r15)";
+    }
+
+    return std::to_string(slots_.at(variable)) + "(%rbp)";
+}
+
+std::string X86_64AsmWriter::GetDirectSource(const IrOperand &operand) const
+{
+    switch (operand.type)
+    {
+    case IrOperandType::IMMEDIATE:
+        return '$' + std::to_string(operand.GetImmediateValue());
+    case IrOperandType::VARIABLE:
+        return GetVariableLocation(operand.value);
+    default:
+        return "";
+    }
+}
+
+std::string X86_64AsmWriter::GetFunctionSymbol(const InternId name) const
+{
+    // Keeps C-- functions apart from the C library and the runtime
+    return std::string("cmm_") + InternerGetString(interner_, name);
+}
+
+std::string X86_64AsmWriter::GetLabel(const IrOperand &label)
+{
+    return ".Llabel" + std::to_string(label.value);
+}
+
+std::string X86_64AsmWriter::Get64BitRegister(const char *reg)
+{
+    std::string name(reg);
+
+    // r8d -> r8
+    if (name.back() == 'd')
+    {
+        return '%' + name.substr(0, name.size() - 1);
+    }
+
+    // eax -> rax
+    return "%r" + name.substr(1);
+}
+
+const char *X86_64AsmWriter::GetConditionSuffix(const IrOperator op)
+{
+    switch (op)
+    {
+    case IrOperator::EQ:
+        return "e";
+    case IrOperator::NE:
+        return "ne";
+    case IrOperator::LT:
+        return "l";
+    case IrOperator::LE:
+        return "le";
+    case IrOperator::GT:
+        return "g";
+    case IrOperator::GE:
+        return "ge";
+    default:
+        return "";
+    }
+}
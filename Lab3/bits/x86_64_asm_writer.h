@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ir_printer.h"
+#include "ir_sink.h"
+
+// Translates IR to x86-64 System V assembly in GNU as syntax, one function
+// at a time, and writes it to a file. Link the output with the runtime:
+//   gcc <path> Lab3/runtime/x86_64_runtime.c -o <program>
+//
+// IR values are 32 bits wide, addresses included. Addresses are offsets
+// into one block of memory the runtime allocates, based at %r15:
+//   - Global variables are at fixed offsets from its bottom.
+//   - Arrays and structs (DEC) live on a data stack growing down from its
+//     top. %r14d is the data stack pointer; a function lowers it by the
+//     size of its DECs on entry and restores it on return.
+// Every other variable gets a 4-byte slot in the native stack frame.
+// C-- functions are named cmm_<name> and take their first six arguments
+// in registers, the rest on the stack. The first PARAM is the first
+// argument, that is the last ARG before the CALL.
+// Floating point values are not supported.
+class X86_64AsmWriter : public IrFileSink
+{
+private:
+    std::ofstream file_;
+    const Interner *interner_;
+    const IrPrinter printer_;
+    std::string line_;
+    bool has_translation_error_;
+
+    // Maps global variable number to its address
+    std::unordered_map<uint32_t, uint32_t> global_addresses_;
+    uint32_t global_size_;
+    bool is_stack_overflow_used_;
+
+    // State of the function being written
+    std::string function_name_;
+    // Maps variable number to its offset from %rbp
+    std::unordered_map<uint32_t, int32_t> slots_;
+    // Maps DEC variable number to its offset from the data stack pointer
+    std::unordered_map<uint32_t, uint32_t> dec_offsets_;
+    uint32_t dec_size_;
+    // Operands of the ARGs before the next CALL, in order
+    std::vector<IrOperand> args_;
+
+public:
+    X86_64AsmWriter(const std::string &path, const Interner *interner);
+
+    bool IsOpen() const override
+    {
+        return file_.is_open();
+    }
+
+    void Consume(const IrSequence &sequence) override;
+
+    // Writes the entry point and the global memory size, then closes the file
+    bool Close() override;
+
+    bool GetHasTranslationError() const override
+    {
+        return has_translation_error_;
+    }
+
+private:
+    void PrintError(const std::string &message);
+
+    void WriteFunction(const IrSequence &function);
+    // Assigns slots and DEC offsets. Returns false on unsupported operands.
+    bool AllocateFrame(const IrSequence &function);
+    void WritePrologue(const IrSequence &function);
+    void WriteEpilogue();
+    void WriteInstruction(const IrInstruction &instruction);
+    void WriteCall(const IrInstruction &instruction);
+
+    // Loads the value of operand into the 32-bit register
+    void WriteLoad(const IrOperand &operand, const char *reg);
+    // Stores %eax to dest, using %ecx for addresses
+    void WriteStore(const IrOperand &dest);
+    // Returns the memory operand of a non-global variable or of a global one
+    std::string GetVariableLocation(const uint32_t variable) const;
+    // Returns operand as an instruction source if it needs no register,
+    // or an empty string
+    std::string GetDirectSource(const IrOperand &operand) const;
+
+    bool IsGlobal(const uint32_t variable) const
+    {
+        return global_addresses_.count(variable) > 0;
+    }
+
+    std::string GetFunctionSymbol(const InternId name) const;
+    static std::string GetLabel(const IrOperand &label);
+    // Returns the 64-bit name of a 32-bit register
+    static std::string Get64BitRegister(const char *reg);
+    static const char *GetConditionSuffix(const IrOperator op);
+};
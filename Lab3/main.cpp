@@ -1,115 +1,221 @@
-#include <cstdio>
-#include <fstream>
-#include <memory>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
 
 extern "C"
 {
 #include "../Lab1/bits/defs.h"
-#include "../Lab1/bits/token.h"
-#include "../Lab1/bits/ast_node.h"
-#include "../Lab1/bits/k_tree.h"
-#include "../Lab1/generated/lex_analyser.h"
-#include "../Lab1/generated/parser.h"
-}
-
-#include "../Lab2/bits/semantic_analyser.h"
-#include "./bits/ir_generator.h"
-
-KTreeNode *kRoot = NULL;
-bool kHasLexicalError = false;
-bool kHasSyntaxError = false;
-
-void FreeKTreeNode(KTreeNodeValue *node)
-{
-    AstNodeFree(*node);
 }
 
+#include "../Lab2/bits/time_report.h"
+#include "./bits/file_compiler.h"
+#include "./bits/batch_compiler.h"
+
+// Usage:
+//   parser [<options>] <input-file-path> <output-file-path>
+//   parser [<options>] --batch <output-dir> <input-file-path>...
+//     Writes <output-dir>/<input-file-name>.ir (.s for assembly) for each input;
+//     inputs with the same file name are rejected
+//   parser [<options>] --manifest <manifest-file-path>
+//     Each manifest line holds "<input-file-path> <output-file-path>"
+// Batch and manifest modes compile on <n> workers (default: one per
+// hardware thread) and print per-file and aggregate timings to stderr.
+// Options:
+//   -O0, -O1, -O2              Optimization level, see CompileOptions (default: -O0)
+//   --target=ir|x86-64|mips32 Output format (default: ir). x86-64 assembly
+//                              is linked with runtime/x86_64_runtime.c, MIPS32
+//                              assembly runs in SPIM or MARS
+//   --jobs <n>
+//   --time-report[=text|json]  Prints per-phase wall time, CPU time, peak RSS
+//                              and allocation counts of each file to stdout
+//   --time-report-ext-defs     Also measures each top-level ExtDef
+//   --dump-cfg                 Also writes the control flow graph of each function
+//                              to <output-file-path>.dot
+//   --opt-report               Prints what each optimization pass removed from
+//                              each function of each file to stdout
+//   --spill-report             Prints how many variables of each function the
+//                              MIPS32 register allocator spilled to stdout
 int main(int argc, char *argv[])
 {
-    if (argc != 3)
+    std::vector<CompilationJob> jobs;
+    CompileOptions options;
+    size_t worker_count = 0;
+    TimeReportFormat time_report_format = TimeReportFormat::NONE;
+    bool track_ext_defs = false;
+    bool print_optimization_reports = false;
+    bool print_spill_reports = false;
+
+    while (argc >= 2)
     {
-        std::cerr << "Usage: parser <input-file-path> <output-file-path>" << std::endl;
-        return FAILURE;
+        std::string option(argv[1]);
+
+        if (option == "-O0" || option == "-O1" || option == "-O2")
+        {
+            options.optimization_level = option[2] - '0';
+            argc--;
+            argv++;
+        }
+        else if (option == "--target=ir")
+        {
+            options.target = CompileTarget::IR;
+            argc--;
+            argv++;
+        }
+        else if (option == "--target=x86-64")
+        {
+            options.target = CompileTarget::X86_64;
+            argc--;
+            argv++;
+        }
+        else if (option == "--target=mips32")
+        {
+            options.target = CompileTarget::MIPS32;
+            argc--;
+            argv++;
+        }
+        else if (option == "--jobs" && argc >= 3)
+        {
+            worker_count = std::strtoul(argv[2], nullptr, 10);
+            argc -= 2;
+            argv += 2;
+        }
+        else if (option == "--time-report" || option == "--time-report=text")
+        {
+            time_report_format = TimeReportFormat::TEXT;
+            argc--;
+            argv++;
+        }
+        else if (option == "--time-report=json")
+        {
+            time_report_format = TimeReportFormat::JSON;
+            argc--;
+            argv++;
+        }
+        else if (option == "--time-report-ext-defs")
+        {
+            track_ext_defs = true;
+            argc--;
+            argv++;
+        }
+        else if (option == "--dump-cfg")
+        {
+            options.dump_cfg = true;
+            argc--;
+            argv++;
+        }
+        else if (option == "--opt-report")
+        {
+            print_optimization_reports = true;
+            argc--;
+            argv++;
+        }
+        else if (option == "--spill-report")
+        {
+            print_spill_reports = true;
+            argc--;
+            argv++;
+        }
+        else
+        {
+            break;
+        }
     }
 
-    FILE *source_file = fopen(argv[1], "r");
-    if (source_file == NULL)
+    if (track_ext_defs && time_report_format == TimeReportFormat::NONE)
     {
-        std::cerr << "Failed to open input file " << argv[1] << std::endl;
-        return FAILURE;
+        time_report_format = TimeReportFormat::TEXT;
     }
 
-    yyrestart(source_file);
-    yyparse();
-
-    fclose(source_file);
-
-    if (kHasLexicalError || kHasSyntaxError)
+    if (argc >= 3 && std::string(argv[1]) == "--batch")
     {
-        KTreeFree(kRoot, FreeKTreeNode);
-        return FAILURE;
+        std::filesystem::path output_dir(argv[2]);
+        for (int i = 3; i < argc; i++)
+        {
+            std::filesystem::path input_path(argv[i]);
+            jobs.push_back({input_path.string(),
+                            (output_dir / input_path.filename()).string() +
+                                GetOutputExtension(options.target)});
+        }
     }
-
-    SymbolTable built_in_symbol_table = {
-        {"read",
-         std::make_shared<FunctionSymbol>(
-             -1,
-             "read",
-             std::vector<VariableSymbolSharedPtr>(),
-             std::make_shared<ArithmeticSymbol>(
-                 -1,
-                 "",
-                 ArithmeticSymbolType::INT))},
-        {"write",
-         std::make_shared<FunctionSymbol>(
-             -1,
-             "write",
-             std::vector<VariableSymbolSharedPtr>({std::make_shared<ArithmeticSymbol>(
-                 -1,
-                 "value",
-                 ArithmeticSymbolType::INT)}),
-             std::make_shared<ArithmeticSymbol>(
-                 -1,
-                 "",
-                 ArithmeticSymbolType::INT))}};
-
-    SemanticAnalyser semantic_analyser(built_in_symbol_table);
-
-    semantic_analyser.Analyse(kRoot);
-    if (semantic_analyser.GetHasError())
+    else if (argc == 3 && std::string(argv[1]) == "--manifest")
     {
-        KTreeFree(kRoot, FreeKTreeNode);
-        return FAILURE;
+        if (!BatchCompiler::ReadManifest(argv[2], jobs))
+        {
+            std::cerr << "Failed to read manifest " << argv[2] << std::endl;
+            return FAILURE;
+        }
     }
-
-    IrGenerator ir_generator(semantic_analyser.GetSymbolTable(),
-                             semantic_analyser.GetStructDefSymbolTable());
-
-    ir_generator.Generate(kRoot);
-    if (ir_generator.GetHasError())
+    else if (argc == 3)
     {
-        KTreeFree(kRoot, FreeKTreeNode);
-        return FAILURE;
+        TimeReport time_report(argv[1], track_ext_defs);
+        OptimizationReport optimization_report(argv[1]);
+        SpillReport spill_report(argv[1]);
+
+        int result = CompileFile(
+            argv[1],
+            argv[2],
+            options,
+            time_report_format == TimeReportFormat::NONE ? nullptr : &time_report,
+            print_optimization_reports ? &optimization_report : nullptr,
+            print_spill_reports ? &spill_report : nullptr);
+
+        if (print_optimization_reports)
+        {
+            optimization_report.PrintText(std::cout);
+        }
+
+        if (print_spill_reports)
+        {
+            spill_report.PrintText(std::cout);
+        }
+
+        if (time_report_format == TimeReportFormat::JSON)
+        {
+            time_report.PrintJson(std::cout);
+            std::cout << std::endl;
+        }
+        else if (time_report_format == TimeReportFormat::TEXT)
+        {
+            time_report.PrintText(std::cout);
+        }
+
+        return result;
     }
-
-    std::ofstream output_file(argv[2], std::ios::out);
-    if (!output_file.is_open())
+    else
     {
-        std::cerr << "Failed to open output file " << argv[2] << std::endl;
-        KTreeFree(kRoot, FreeKTreeNode);
+        std::cerr << "Usage: parser [<options>] <input-file-path> <output-file-path>\n"
+                  << "       parser [<options>] --batch <output-dir> <input-file-path>...\n"
+                  << "       parser [<options>] --manifest <manifest-file-path>\n"
+                  << "Options: -O0, -O1, -O2, --target=ir|x86-64|mips32, --jobs <n>,\n"
+                  << "         --time-report[=text|json], --time-report-ext-defs, --dump-cfg,\n"
+                  << "         --opt-report, --spill-report"
+                  << std::endl;
         return FAILURE;
     }
 
-    auto ir_sequence = ir_generator.GetIrSequence();
-
-    for (auto &ir : ir_sequence)
+    std::string duplicate_path;
+    if (!BatchCompiler::HasUniqueOutputs(jobs, duplicate_path))
     {
-        output_file << ir << std::endl;
+        std::cerr << "More than one input would be compiled to " << duplicate_path
+                  << std::endl;
+        return FAILURE;
     }
 
-    output_file.close();
-
-    KTreeFree(kRoot, FreeKTreeNode);
-
-    return SUCCESS;
-}
\ No newline at end of file
+    BatchCompiler batch_compiler(jobs,
+                                 options,
+                                 worker_count,
+                                 time_report_format,
+                                 track_ext_defs,
+                                 print_optimization_reports,
+                                 print_spill_reports);
+
+    bool success = batch_compiler.Run();
+    batch_compiler.PrintOptimizationReports(std::cout);
+    batch_compiler.PrintSpillReports(std::cout);
+    batch_compiler.PrintTimeReports(std::cout);
+    batch_compiler.PrintSummary(std::cerr);
+
+    return success ? SUCCESS : FAILURE;
+}
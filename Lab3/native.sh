@@ -0,0 +1,4 @@
+mkdir -p out/native
+file_name=$(basename $1)
+./build/parser --target=x86-64 "${@:2}" $1 ./out/native/${file_name}.s \
+&& gcc ./out/native/${file_name}.s ./runtime/x86_64_runtime.c -o ./out/native/${file_name%.cmm}
@@ -0,0 +1,60 @@
+// Runtime of the x86-64 assembly written by X86_64AsmWriter: allocates the
+// memory that IR addresses are offsets into, implements read() and write()
+// and calls main().
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Global variables at the bottom, the data stack of arrays and structs
+// growing down from the top. Pages are only touched when used.
+#define MEMORY_SIZE (256u << 20)
+
+// Defined by the assembly
+extern const uint32_t __cmm_global_size;
+int __cmm_entry(unsigned char *memory, uint32_t size);
+
+// The lowest address the data stack may grow to
+uint32_t __cmm_stack_limit;
+
+int __cmm_read(void)
+{
+    int value;
+    if (scanf("%d", &value) != 1)
+    {
+        fprintf(stderr, "read(): expected an integer\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return value;
+}
+
+void __cmm_write(int value)
+{
+    printf("%d\n", value);
+}
+
+void __cmm_stack_overflow(void)
+{
+    fprintf(stderr, "Data stack overflow\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(void)
+{
+    if (__cmm_global_size > MEMORY_SIZE)
+    {
+        fprintf(stderr, "Global variables do not fit into memory\n");
+        return EXIT_FAILURE;
+    }
+
+    unsigned char *memory = calloc(MEMORY_SIZE, 1);
+    if (memory == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory\n");
+        return EXIT_FAILURE;
+    }
+
+    __cmm_stack_limit = __cmm_global_size;
+
+    return __cmm_entry(memory, MEMORY_SIZE);
+}
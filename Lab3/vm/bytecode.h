@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A value of the IR. The IR itself is untyped: integers are 32 bits wide
+// and wrap around, and a value becomes a float when a float literal or a
+// float operation produced it.
+struct VmValue
+{
+    bool is_float;
+    union
+    {
+        int32_t int_value;
+        float float_value;
+    };
+
+    static VmValue Int(const int32_t value)
+    {
+        VmValue result;
+        result.is_float = false;
+        result.int_value = value;
+        return result;
+    }
+
+    static VmValue Float(const float value)
+    {
+        VmValue result;
+        result.is_float = true;
+        result.float_value = value;
+        return result;
+    }
+
+    float ToFloat() const
+    {
+        return is_float ? float_value : static_cast<float>(int_value);
+    }
+};
+
+enum class VmOperandKind : uint8_t
+{
+    NONE,
+    // constants[index] of the function
+    CONSTANT,
+    // slots[index] of the frame
+    SLOT,
+    // The word at the address held by slots[index]
+    SLOT_DEREFERENCE,
+    // The word at word index (a global variable)
+    MEMORY,
+    // The word at the address held by the word at word index
+    MEMORY_DEREFERENCE
+};
+
+struct VmOperand
+{
+    VmOperandKind kind;
+    uint32_t index;
+};
+
+enum class VmOpcode : uint8_t
+{
+    // dest := a
+    MOVE,
+    // dest := a <op> b
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    // dest := a <compare> b ? 1 : 0
+    COMPARE,
+    // Jumps to target
+    JUMP,
+    // Jumps to target if a <compare> b
+    BRANCH,
+    // Pushes a as the next argument
+    ARG,
+    // dest := the index-th parameter, index in a.index
+    PARAM,
+    // Calls functions[target], then dest := its return value unless dest is NONE
+    CALL,
+    RETURN,
+    // dest := the address of the variable's block, which starts a.index
+    // words into the frame's DEC area and whose first b.index words are cleared
+    DEC,
+    READ,
+    WRITE,
+    // Placed after the last instruction of each function, which should
+    // have returned before reaching it
+    END
+};
+
+enum class VmCompare : uint8_t
+{
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE
+};
+
+// One pre-decoded instruction. Labels are resolved to instruction indices
+// within the function, variables to frame slots or memory words.
+struct VmInstruction
+{
+    VmOpcode opcode;
+    VmCompare compare;
+    VmOperand dest;
+    VmOperand a;
+    VmOperand b;
+    uint32_t target;
+    // Line in the IR file, for runtime errors
+    uint32_t line_number;
+};
+
+struct VmFunction
+{
+    std::string name;
+    std::vector<VmInstruction> instructions;
+    std::vector<VmValue> constants;
+    size_t slot_count;
+    // Words taken from the data stack at entry, one block per DEC variable,
+    // so that a DEC executed in a loop reuses its block
+    size_t dec_word_count;
+};
+
+struct VmProgram
+{
+    std::vector<VmFunction> functions;
+    size_t main_index;
+    // Global variables occupy the memory below this address
+    uint32_t global_size;
+};
@@ -0,0 +1,509 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include "ir_loader.h"
+
+bool IrLoader::Load(std::istream &stream, VmProgram &program)
+{
+    std::string text;
+    uint32_t line_number = 0;
+    while (std::getline(stream, text))
+    {
+        line_number++;
+
+        Line line{line_number, {}};
+        std::istringstream line_stream(text);
+        std::string token;
+        while (line_stream >> token)
+        {
+            line.tokens.push_back(token);
+        }
+
+        if (!line.tokens.empty())
+        {
+            lines_.push_back(std::move(line));
+        }
+    }
+
+    program.functions.clear();
+    DeclareGlobals(program);
+    if (has_error_)
+    {
+        return false;
+    }
+
+    auto main_index = function_indices_.find("main");
+    if (main_index == function_indices_.end())
+    {
+        PrintError(line_number, "Function main is not defined");
+        return false;
+    }
+    program.main_index = main_index->second;
+
+    // A function runs from its FUNCTION line to the next one
+    size_t function_index = 0;
+    for (size_t i = 0; i < lines_.size(); i++)
+    {
+        if (lines_[i].tokens[0] != "FUNCTION")
+        {
+            continue;
+        }
+
+        size_t end = i + 1;
+        while (end < lines_.size() && lines_[end].tokens[0] != "FUNCTION")
+        {
+            end++;
+        }
+
+        TranslateFunction(i, end, program.functions[function_index++]);
+    }
+
+    return !has_error_;
+}
+
+void IrLoader::PrintError(const uint32_t line_number, const std::string &message)
+{
+    has_error_ = true;
+    std::cerr << "IR load error at line " + std::to_string(line_number) + " : " + message + '\n';
+}
+
+void IrLoader::DeclareGlobals(VmProgram &program)
+{
+    uint32_t global_size = 0;
+    bool is_in_function = false;
+
+    for (auto &line : lines_)
+    {
+        const std::string &opcode = line.tokens[0];
+
+        if (opcode == "FUNCTION")
+        {
+            if (line.tokens.size() != 3 || line.tokens[2] != ":")
+            {
+                PrintError(line.line_number, "Expected FUNCTION <name> :");
+                continue;
+            }
+
+            if (!function_indices_.emplace(line.tokens[1], program.functions.size()).second)
+            {
+                PrintError(line.line_number, "Function " + line.tokens[1] + " is defined twice");
+                continue;
+            }
+
+            program.functions.push_back({line.tokens[1], {}, {}, 0});
+            is_in_function = true;
+        }
+        else if (opcode == "GLOBAL_DEC")
+        {
+            char *size_end = nullptr;
+            long size = line.tokens.size() == 3
+                            ? std::strtol(line.tokens[2].c_str(), &size_end, 10)
+                            : 0;
+            if (size <= 0 || *size_end != '\0')
+            {
+                PrintError(line.line_number, "Expected GLOBAL_DEC <name> <size>");
+                continue;
+            }
+
+            if (!global_addresses_.emplace(line.tokens[1], global_size).second)
+            {
+                PrintError(line.line_number,
+                           "Global variable " + line.tokens[1] + " is declared twice");
+                continue;
+            }
+
+            // Every variable starts at a word boundary
+            global_size += (static_cast<uint32_t>(size) + 3) & ~3u;
+        }
+        else if (!is_in_function)
+        {
+            PrintError(line.line_number, "Instruction outside of a function");
+        }
+    }
+
+    program.global_size = global_size;
+}
+
+void IrLoader::TranslateFunction(const size_t begin, const size_t end, VmFunction &function)
+{
+    function_ = &function;
+    labels_.clear();
+    slots_.clear();
+    dec_offsets_.clear();
+    param_count_ = 0;
+
+    // Labels may be jumped to before they appear, and DEC variables may be
+    // addressed before their DEC in a loop
+    uint32_t instruction_count = 0;
+    // Names in order of their first DEC, and the largest size declared
+    std::vector<std::string> dec_names;
+    std::unordered_map<std::string, uint32_t> dec_word_counts;
+    for (size_t i = begin + 1; i < end; i++)
+    {
+        const Line &line = lines_[i];
+
+        if (line.tokens[0] == "LABEL")
+        {
+            if (line.tokens.size() != 3 || line.tokens[2] != ":")
+            {
+                PrintError(line.line_number, "Expected LABEL <name> :");
+            }
+            else if (!labels_.emplace(line.tokens[1], instruction_count).second)
+            {
+                PrintError(line.line_number, "Label " + line.tokens[1] + " is defined twice");
+            }
+        }
+        else if (line.tokens[0] != "GLOBAL_DEC")
+        {
+            if (line.tokens[0] == "DEC" && line.tokens.size() == 3)
+            {
+                // Malformed sizes are reported when the line is translated
+                uint32_t word_count = 0;
+                ParseDecSize(line.tokens[2], word_count);
+
+                auto inserted = dec_word_counts.emplace(line.tokens[1], word_count);
+                if (inserted.second)
+                {
+                    dec_names.push_back(line.tokens[1]);
+                }
+                else
+                {
+                    inserted.first->second = std::max(inserted.first->second, word_count);
+                }
+            }
+
+            instruction_count++;
+        }
+    }
+
+    function.dec_word_count = 0;
+    for (const std::string &name : dec_names)
+    {
+        dec_offsets_.emplace(name, static_cast<uint32_t>(function.dec_word_count));
+        function.dec_word_count += dec_word_counts[name];
+    }
+
+    for (size_t i = begin + 1; i < end; i++)
+    {
+        TranslateLine(lines_[i]);
+    }
+
+    VmInstruction end_instruction{};
+    end_instruction.opcode = VmOpcode::END;
+    end_instruction.line_number = lines_[begin].line_number;
+    function.instructions.push_back(end_instruction);
+
+    function.slot_count = slots_.size();
+}
+
+void IrLoader::TranslateLine(const Line &line)
+{
+    const std::vector<std::string> &tokens = line.tokens;
+    const std::string &opcode = tokens[0];
+
+    if (opcode == "LABEL" || opcode == "GLOBAL_DEC")
+    {
+        return;
+    }
+
+    VmInstruction instruction{};
+    instruction.line_number = line.line_number;
+    bool is_valid = false;
+
+    if (opcode == "GOTO" && tokens.size() == 2)
+    {
+        instruction.opcode = VmOpcode::JUMP;
+        is_valid = ParseLabel(line, tokens[1], instruction.target);
+    }
+    else if (opcode == "IF" && tokens.size() == 6 && tokens[4] == "GOTO")
+    {
+        instruction.opcode = VmOpcode::BRANCH;
+        is_valid = ParseOperand(line, tokens[1], instruction.a) &&
+                   ParseOperand(line, tokens[3], instruction.b) &&
+                   ParseLabel(line, tokens[5], instruction.target);
+
+        if (is_valid && !ParseCompare(tokens[2], instruction.compare))
+        {
+            PrintError(line.line_number, "Unknown relational operator " + tokens[2]);
+            is_valid = false;
+        }
+    }
+    else if (opcode == "RETURN" && tokens.size() == 2)
+    {
+        instruction.opcode = VmOpcode::RETURN;
+        is_valid = ParseOperand(line, tokens[1], instruction.a);
+    }
+    else if (opcode == "DEC" && tokens.size() == 3)
+    {
+        uint32_t word_count;
+        if (!ParseDecSize(tokens[2], word_count))
+        {
+            PrintError(line.line_number, "Expected DEC <name> <size>");
+            return;
+        }
+
+        instruction.opcode = VmOpcode::DEC;
+        instruction.dest = {VmOperandKind::SLOT, GetSlot(tokens[1])};
+        instruction.a.index = dec_offsets_[tokens[1]];
+        instruction.b.index = word_count;
+        is_valid = true;
+    }
+    else if (opcode == "ARG" && tokens.size() == 2)
+    {
+        instruction.opcode = VmOpcode::ARG;
+        is_valid = ParseOperand(line, tokens[1], instruction.a);
+    }
+    else if (opcode == "PARAM" && tokens.size() == 2)
+    {
+        instruction.opcode = VmOpcode::PARAM;
+        instruction.a.index = param_count_++;
+        is_valid = ParseDestination(line, tokens[1], instruction.dest);
+    }
+    else if (opcode == "READ" && tokens.size() == 2)
+    {
+        instruction.opcode = VmOpcode::READ;
+        is_valid = ParseDestination(line, tokens[1], instruction.dest);
+    }
+    else if (opcode == "WRITE" && tokens.size() == 2)
+    {
+        instruction.opcode = VmOpcode::WRITE;
+        is_valid = ParseOperand(line, tokens[1], instruction.a);
+    }
+    else if (opcode == "CALL" && tokens.size() == 2)
+    {
+        instruction.opcode = VmOpcode::CALL;
+        instruction.dest.kind = VmOperandKind::NONE;
+        is_valid = true;
+    }
+    else if (tokens.size() >= 3 && tokens[1] == ":=")
+    {
+        if (tokens.size() == 4 && tokens[2] == "CALL")
+        {
+            instruction.opcode = VmOpcode::CALL;
+            is_valid = ParseDestination(line, tokens[0], instruction.dest);
+        }
+        else if (tokens.size() == 3)
+        {
+            instruction.opcode = VmOpcode::MOVE;
+            is_valid = ParseDestination(line, tokens[0], instruction.dest) &&
+                       ParseOperand(line, tokens[2], instruction.a);
+        }
+        else if (tokens.size() == 5)
+        {
+            is_valid = ParseDestination(line, tokens[0], instruction.dest) &&
+                       ParseOperand(line, tokens[2], instruction.a) &&
+                       ParseOperand(line, tokens[4], instruction.b);
+
+            if (ParseCompare(tokens[3], instruction.compare))
+            {
+                instruction.opcode = VmOpcode::COMPARE;
+            }
+            else if (!ParseArithmetic(tokens[3], instruction.opcode))
+            {
+                PrintError(line.line_number, "Unknown operator " + tokens[3]);
+                is_valid = false;
+            }
+        }
+        else
+        {
+            PrintError(line.line_number, "Malformed assignment");
+        }
+    }
+    else
+    {
+        PrintError(line.line_number, "Unknown instruction");
+    }
+
+    if (is_valid && instruction.opcode == VmOpcode::CALL)
+    {
+        const std::string &callee = tokens.back();
+        auto function_index = function_indices_.find(callee);
+        if (function_index == function_indices_.end())
+        {
+            PrintError(line.line_number, "Function " + callee + " is not defined");
+            return;
+        }
+
+        instruction.target = static_cast<uint32_t>(function_index->second);
+    }
+
+    if (is_valid)
+    {
+        function_->instructions.push_back(instruction);
+    }
+}
+
+bool IrLoader::ParseOperand(const Line &line, const std::string &token, VmOperand &operand)
+{
+    if (token.size() >= 2 && token[0] == '#')
+    {
+        VmValue value;
+        if (!ParseConstant(token.substr(1), value))
+        {
+            PrintError(line.line_number, "Malformed literal " + token);
+            return false;
+        }
+
+        operand = {VmOperandKind::CONSTANT,
+                   static_cast<uint32_t>(function_->constants.size())};
+        function_->constants.push_back(value);
+        return true;
+    }
+
+    if (token.size() >= 2 && token[0] == '&')
+    {
+        std::string name = token.substr(1);
+
+        auto global_address = global_addresses_.find(name);
+        if (global_address != global_addresses_.end())
+        {
+            operand = {VmOperandKind::CONSTANT,
+                       static_cast<uint32_t>(function_->constants.size())};
+            function_->constants.push_back(
+                VmValue::Int(static_cast<int32_t>(global_address->second)));
+            return true;
+        }
+
+        if (dec_offsets_.count(name) == 0)
+        {
+            PrintError(line.line_number,
+                       "Cannot take the address of " + name + ", which is not declared by DEC");
+            return false;
+        }
+
+        operand = {VmOperandKind::SLOT, GetSlot(name)};
+        return true;
+    }
+
+    return ParseDestination(line, token, operand);
+}
+
+bool IrLoader::ParseDestination(const Line &line, const std::string &token, VmOperand &operand)
+{
+    bool is_dereference = token[0] == '*';
+    std::string name = is_dereference ? token.substr(1) : token;
+
+    if (name.empty() || name[0] == '#' || name[0] == '&' || name[0] == '*')
+    {
+        PrintError(line.line_number, "Expected a variable instead of " + token);
+        return false;
+    }
+
+    auto global_address = global_addresses_.find(name);
+    if (global_address != global_addresses_.end())
+    {
+        operand = {is_dereference ? VmOperandKind::MEMORY_DEREFERENCE : VmOperandKind::MEMORY,
+                   global_address->second / 4};
+        return true;
+    }
+
+    operand = {is_dereference ? VmOperandKind::SLOT_DEREFERENCE : VmOperandKind::SLOT,
+               GetSlot(name)};
+    return true;
+}
+
+bool IrLoader::ParseConstant(const std::string &lexeme, VmValue &value) const
+{
+    const char *begin = lexeme.c_str();
+    char *end = nullptr;
+    errno = 0;
+
+    bool is_hex = lexeme.size() > 2 && lexeme[0] == '0' && (lexeme[1] == 'x' || lexeme[1] == 'X');
+    bool is_float = !is_hex && lexeme.find_first_of(".eE") != std::string::npos;
+
+    if (is_float)
+    {
+        value = VmValue::Float(std::strtof(begin, &end));
+    }
+    else
+    {
+        // Base 0 also accepts octal literals such as 017; larger literals
+        // wrap around like the arithmetic does
+        long long number = std::strtoll(begin, &end, 0);
+        value = VmValue::Int(static_cast<int32_t>(static_cast<uint32_t>(number)));
+    }
+
+    return end != begin && *end == '\0' && errno == 0;
+}
+
+uint32_t IrLoader::GetSlot(const std::string &name)
+{
+    return slots_.emplace(name, static_cast<uint32_t>(slots_.size())).first->second;
+}
+
+bool IrLoader::ParseLabel(const Line &line, const std::string &name, uint32_t &target)
+{
+    auto label = labels_.find(name);
+    if (label == labels_.end())
+    {
+        PrintError(line.line_number,
+                   "Label " + name + " is not defined in function " + function_->name);
+        return false;
+    }
+
+    target = label->second;
+    return true;
+}
+
+bool IrLoader::ParseDecSize(const std::string &token, uint32_t &word_count)
+{
+    char *size_end = nullptr;
+    long size = std::strtol(token.c_str(), &size_end, 10);
+    if (size <= 0 || *size_end != '\0')
+    {
+        return false;
+    }
+
+    // Every DEC starts at a word boundary
+    word_count = static_cast<uint32_t>((size + 3) / 4);
+    return true;
+}
+
+bool IrLoader::ParseCompare(const std::string &token, VmCompare &compare)
+{
+    static const std::unordered_map<std::string, VmCompare> compares = {
+        {"==", VmCompare::EQ},
+        {"!=", VmCompare::NE},
+        {"<", VmCompare::LT},
+        {"<=", VmCompare::LE},
+        {">", VmCompare::GT},
+        {">=", VmCompare::GE}};
+
+    auto entry = compares.find(token);
+    if (entry == compares.end())
+    {
+        return false;
+    }
+
+    compare = entry->second;
+    return true;
+}
+
+bool IrLoader::ParseArithmetic(const std::string &token, VmOpcode &opcode)
+{
+    if (token.size() != 1)
+    {
+        return false;
+    }
+
+    switch (token[0])
+    {
+    case '+':
+        opcode = VmOpcode::ADD;
+        return true;
+    case '-':
+        opcode = VmOpcode::SUB;
+        return true;
+    case '*':
+        opcode = VmOpcode::MUL;
+        return true;
+    case '/':
+        opcode = VmOpcode::DIV;
+        return true;
+    default:
+        return false;
+    }
+}
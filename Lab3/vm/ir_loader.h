@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bytecode.h"
+
+// Translates textual IR, as written by IrWriter or by hand for the Web IR
+// virtual machine, into a VmProgram. Every line is parsed once here so
+// that the virtual machine never looks at strings:
+//   - Labels become instruction indices within their function.
+//   - Global variables (GLOBAL_DEC) become fixed memory addresses.
+//   - Every other variable becomes a slot in its function's frame; a DEC
+//     variable's slot holds the address of its memory, a block at a fixed
+//     offset in the frame's DEC area.
+//   - Literals become per-function constants.
+// Errors are printed to stderr with their line numbers.
+class IrLoader
+{
+private:
+    struct Line
+    {
+        uint32_t line_number;
+        std::vector<std::string> tokens;
+    };
+
+    std::vector<Line> lines_;
+    bool has_error_;
+
+    // Maps global variable name to its address
+    std::unordered_map<std::string, uint32_t> global_addresses_;
+    // Maps function name to its index in the program
+    std::unordered_map<std::string, size_t> function_indices_;
+
+    // State of the function being translated
+    VmFunction *function_;
+    // Maps label name to instruction index
+    std::unordered_map<std::string, uint32_t> labels_;
+    // Maps variable name to slot index
+    std::unordered_map<std::string, uint32_t> slots_;
+    // Maps name declared by DEC to the word offset of its block
+    std::unordered_map<std::string, uint32_t> dec_offsets_;
+    uint32_t param_count_;
+
+public:
+    IrLoader() : has_error_(false), function_(nullptr), param_count_(0) {}
+
+    // Returns false if the IR is malformed
+    bool Load(std::istream &stream, VmProgram &program);
+
+private:
+    void PrintError(const uint32_t line_number, const std::string &message);
+
+    // Assigns global addresses and function indices
+    void DeclareGlobals(VmProgram &program);
+    // Translates the lines [begin, end) of one function
+    void TranslateFunction(const size_t begin, const size_t end, VmFunction &function);
+    void TranslateLine(const Line &line);
+
+    // Parses a source operand such as #1, var1, &var1 or *var1
+    bool ParseOperand(const Line &line, const std::string &token, VmOperand &operand);
+    // Parses an operand that can be assigned to, such as var1 or *var1
+    bool ParseDestination(const Line &line, const std::string &token, VmOperand &operand);
+    bool ParseConstant(const std::string &lexeme, VmValue &value) const;
+    uint32_t GetSlot(const std::string &name);
+    bool ParseLabel(const Line &line, const std::string &name, uint32_t &target);
+
+    // Parses the byte size of a DEC, rounded up to whole words
+    static bool ParseDecSize(const std::string &token, uint32_t &word_count);
+    static bool ParseCompare(const std::string &token, VmCompare &compare);
+    static bool ParseArithmetic(const std::string &token, VmOpcode &opcode);
+};
@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+
+#include "ir_virtual_machine.h"
+
+namespace
+{
+    // 256 MiB, as much as the x86-64 runtime allocates
+    constexpr size_t kMaxMemoryWords = (size_t(256) << 20) / 4;
+    constexpr size_t kMaxCallDepth = size_t(1) << 22;
+
+    double GetElapsedMs(const std::chrono::steady_clock::time_point begin,
+                        const std::chrono::steady_clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+}
+
+IrVirtualMachine::IrVirtualMachine(const VmProgram &program,
+                                   std::istream &input,
+                                   std::ostream &output)
+    : program_(program),
+      input_(input),
+      output_(output),
+      instruction_limit_(0),
+      is_profiling_(false),
+      memory_top_(0),
+      instruction_count_(0),
+      has_error_(false),
+      scratch_word_(VmValue::Int(0)),
+      exit_value_(0),
+      profiles_(program.functions.size(), {0, 0, 0.0}),
+      last_instruction_count_(0),
+      total_time_ms_(0.0) {}
+
+bool IrVirtualMachine::Run()
+{
+    memory_.assign(program_.global_size / 4, VmValue::Int(0));
+    memory_top_ = memory_.size();
+
+    auto begin = std::chrono::steady_clock::now();
+    last_time_ = begin;
+
+    if (EnterFunction(program_.main_index))
+    {
+        Execute();
+    }
+    else
+    {
+        std::cerr << "IR runtime error at line " +
+                         std::to_string(program_.functions[program_.main_index]
+                                            .instructions.front()
+                                            .line_number) +
+                         " : " + error_message_ + '\n';
+    }
+
+    total_time_ms_ = GetElapsedMs(begin, std::chrono::steady_clock::now());
+    output_.flush();
+
+    return !has_error_;
+}
+
+void IrVirtualMachine::PrintProfile(std::ostream &stream, const std::string &input_path) const
+{
+    size_t name_width = 28;
+    for (auto &function : program_.functions)
+    {
+        name_width = std::max(name_width, function.name.size() + 2);
+    }
+
+    stream << "[VM Profile] " << input_path << '\n'
+           << std::left << std::setw(name_width) << "Function"
+           << std::setw(12) << "Calls"
+           << std::setw(16) << "Instructions"
+           << "Self time(ms)"
+           << '\n';
+
+    uint64_t total_call_count = 0;
+    for (size_t i = 0; i < program_.functions.size(); i++)
+    {
+        const FunctionProfile &profile = profiles_[i];
+        if (profile.call_count == 0)
+        {
+            continue;
+        }
+
+        stream << std::setw(name_width) << program_.functions[i].name
+               << std::setw(12) << profile.call_count
+               << std::setw(16) << profile.instruction_count
+               << std::fixed << std::setprecision(3) << profile.self_time_ms
+               << '\n';
+
+        total_call_count += profile.call_count;
+    }
+
+    stream << std::setw(name_width) << "Total"
+           << std::setw(12) << total_call_count
+           << std::setw(16) << instruction_count_
+           << std::fixed << std::setprecision(3) << total_time_ms_
+           << '\n';
+
+    if (!has_error_)
+    {
+        stream << "main returned " << exit_value_ << '\n';
+    }
+    stream.flush();
+}
+
+void IrVirtualMachine::Fail(const std::string &message)
+{
+    // Only the first error of an instruction is reported
+    if (!has_error_)
+    {
+        has_error_ = true;
+        error_message_ = message;
+    }
+}
+
+void IrVirtualMachine::Execute()
+{
+    // State of the top frame, reloaded whenever it changes
+    Frame *frame = nullptr;
+    const VmInstruction *instructions = nullptr;
+    const VmValue *constants = nullptr;
+    VmValue *slots = nullptr;
+    uint32_t pc = 0;
+
+    auto load_frame = [&]()
+    {
+        frame = &frames_.back();
+        const VmFunction &function = program_.functions[frame->function_index];
+        instructions = function.instructions.data();
+        constants = function.constants.data();
+        slots = slots_.data() + frame->slot_base;
+        pc = frame->pc;
+    };
+
+    auto is_over_limit = [this]()
+    {
+        return instruction_limit_ != 0 && instruction_count_ > instruction_limit_;
+    };
+
+    load_frame();
+
+    while (true)
+    {
+        const VmInstruction &instruction = instructions[pc++];
+        instruction_count_++;
+
+        switch (instruction.opcode)
+        {
+        case VmOpcode::MOVE:
+            Write(instruction.dest, Read(instruction.a, constants, slots), slots);
+            break;
+
+        case VmOpcode::ADD:
+        case VmOpcode::SUB:
+        case VmOpcode::MUL:
+        case VmOpcode::DIV:
+        {
+            VmValue result;
+            if (!Calculate(instruction.opcode,
+                           Read(instruction.a, constants, slots),
+                           Read(instruction.b, constants, slots),
+                           result))
+            {
+                Fail("Division by zero");
+                break;
+            }
+
+            Write(instruction.dest, result, slots);
+            break;
+        }
+
+        case VmOpcode::COMPARE:
+        {
+            bool result = Compare(instruction.compare,
+                                  Read(instruction.a, constants, slots),
+                                  Read(instruction.b, constants, slots));
+            Write(instruction.dest, VmValue::Int(result ? 1 : 0), slots);
+            break;
+        }
+
+        case VmOpcode::JUMP:
+            pc = instruction.target;
+            if (is_over_limit())
+            {
+                Fail("Instruction limit exceeded");
+            }
+            break;
+
+        case VmOpcode::BRANCH:
+            if (Compare(instruction.compare,
+                        Read(instruction.a, constants, slots),
+                        Read(instruction.b, constants, slots)))
+            {
+                pc = instruction.target;
+            }
+
+            if (is_over_limit())
+            {
+                Fail("Instruction limit exceeded");
+            }
+            break;
+
+        case VmOpcode::ARG:
+            args_.push_back(Read(instruction.a, constants, slots));
+            break;
+
+        case VmOpcode::PARAM:
+            if (instruction.a.index >= frame->param_count)
+            {
+                Fail("Function " + program_.functions[frame->function_index].name +
+                     " was called with only " + std::to_string(frame->param_count) +
+                     " arguments");
+                break;
+            }
+
+            Write(instruction.dest,
+                  args_[frame->param_base + frame->param_count - 1 - instruction.a.index],
+                  slots);
+            break;
+
+        case VmOpcode::CALL:
+            frame->pc = pc;
+            if (!EnterFunction(instruction.target))
+            {
+                break;
+            }
+
+            load_frame();
+
+            if (is_over_limit())
+            {
+                Fail("Instruction limit exceeded");
+            }
+            break;
+
+        case VmOpcode::RETURN:
+        {
+            VmValue value = Read(instruction.a, constants, slots);
+            if (has_error_)
+            {
+                break;
+            }
+
+            ChargeCurrentFunction();
+            memory_top_ = frame->memory_top;
+            slots_.resize(frame->slot_base);
+            args_.resize(frame->param_base);
+            frames_.pop_back();
+
+            if (frames_.empty())
+            {
+                exit_value_ = value.is_float ? static_cast<int32_t>(value.float_value)
+                                             : value.int_value;
+                return;
+            }
+
+            load_frame();
+
+            const VmInstruction &call = instructions[pc - 1];
+            if (call.dest.kind != VmOperandKind::NONE)
+            {
+                Write(call.dest, value, slots);
+            }
+            break;
+        }
+
+        case VmOpcode::DEC:
+        {
+            // The block was reserved on entry. It is cleared on every DEC,
+            // since returned functions or earlier iterations of a loop may
+            // have written to it.
+            size_t block_begin = frame->memory_top + instruction.a.index;
+            std::fill(memory_.begin() + block_begin,
+                      memory_.begin() + block_begin + instruction.b.index,
+                      VmValue::Int(0));
+            Write(instruction.dest, VmValue::Int(static_cast<int32_t>(block_begin * 4)), slots);
+            break;
+        }
+
+        case VmOpcode::READ:
+        {
+            int32_t value;
+            if (!(input_ >> value))
+            {
+                Fail("READ found no integer in the input");
+                break;
+            }
+
+            Write(instruction.dest, VmValue::Int(value), slots);
+            break;
+        }
+
+        case VmOpcode::WRITE:
+        {
+            VmValue value = Read(instruction.a, constants, slots);
+            if (value.is_float)
+            {
+                output_ << value.float_value << '\n';
+            }
+            else
+            {
+                output_ << value.int_value << '\n';
+            }
+            break;
+        }
+
+        case VmOpcode::END:
+            Fail("Function " + program_.functions[frame->function_index].name +
+                 " ended without RETURN");
+            break;
+        }
+
+        if (has_error_)
+        {
+            std::cerr << "IR runtime error at line " + std::to_string(instruction.line_number) +
+                             " : " + error_message_ + '\n';
+            ChargeCurrentFunction();
+            return;
+        }
+    }
+}
+
+bool IrVirtualMachine::EnterFunction(const size_t function_index)
+{
+    if (frames_.size() >= kMaxCallDepth)
+    {
+        Fail("Call stack overflow");
+        return false;
+    }
+
+    size_t dec_word_count = program_.functions[function_index].dec_word_count;
+    if (memory_top_ + dec_word_count > kMaxMemoryWords)
+    {
+        Fail("Out of memory");
+        return false;
+    }
+
+    if (memory_.size() < memory_top_ + dec_word_count)
+    {
+        memory_.resize(std::max(memory_.size() * 2, memory_top_ + dec_word_count));
+    }
+
+    if (!frames_.empty())
+    {
+        ChargeCurrentFunction();
+    }
+
+    // The caller's pending arguments become the parameters
+    size_t param_base = frames_.empty() ? args_.size() : frames_.back().arg_base;
+
+    frames_.push_back({function_index,
+                       0,
+                       slots_.size(),
+                       param_base,
+                       args_.size() - param_base,
+                       args_.size(),
+                       memory_top_});
+    memory_top_ += dec_word_count;
+    slots_.resize(slots_.size() + program_.functions[function_index].slot_count,
+                  VmValue::Int(0));
+    profiles_[function_index].call_count++;
+
+    return true;
+}
+
+void IrVirtualMachine::ChargeCurrentFunction()
+{
+    FunctionProfile &profile = profiles_[frames_.back().function_index];
+    profile.instruction_count += instruction_count_ - last_instruction_count_;
+    last_instruction_count_ = instruction_count_;
+
+    if (is_profiling_)
+    {
+        auto now = std::chrono::steady_clock::now();
+        profile.self_time_ms += GetElapsedMs(last_time_, now);
+        last_time_ = now;
+    }
+}
+
+VmValue IrVirtualMachine::Read(const VmOperand &operand,
+                               const VmValue *constants,
+                               const VmValue *slots)
+{
+    switch (operand.kind)
+    {
+    case VmOperandKind::CONSTANT:
+        return constants[operand.index];
+    case VmOperandKind::SLOT:
+        return slots[operand.index];
+    case VmOperandKind::SLOT_DEREFERENCE:
+        return GetWord(slots[operand.index]);
+    case VmOperandKind::MEMORY:
+        return memory_[operand.index];
+    case VmOperandKind::MEMORY_DEREFERENCE:
+        return GetWord(memory_[operand.index]);
+    default:
+        return VmValue::Int(0);
+    }
+}
+
+void IrVirtualMachine::Write(const VmOperand &operand, const VmValue value, VmValue *slots)
+{
+    switch (operand.kind)
+    {
+    case VmOperandKind::SLOT:
+        slots[operand.index] = value;
+        break;
+    case VmOperandKind::SLOT_DEREFERENCE:
+        GetWord(slots[operand.index]) = value;
+        break;
+    case VmOperandKind::MEMORY:
+        memory_[operand.index] = value;
+        break;
+    case VmOperandKind::MEMORY_DEREFERENCE:
+        GetWord(memory_[operand.index]) = value;
+        break;
+    default:
+        break;
+    }
+}
+
+VmValue &IrVirtualMachine::GetWord(const VmValue address)
+{
+    uint32_t byte_address = static_cast<uint32_t>(address.int_value);
+    if (!address.is_float && byte_address % 4 == 0 && byte_address / 4 < memory_top_)
+    {
+        return memory_[byte_address / 4];
+    }
+
+    // Reads and writes of the bad address go to a scratch word and the
+    // error is reported at the end of the instruction
+    Fail("Invalid address " + (address.is_float ? std::to_string(address.float_value)
+                                                : std::to_string(address.int_value)));
+    return scratch_word_;
+}
+
+bool IrVirtualMachine::Calculate(const VmOpcode opcode,
+                                 const VmValue left,
+                                 const VmValue right,
+                                 VmValue &result) const
+{
+    if (left.is_float || right.is_float)
+    {
+        float left_value = left.ToFloat();
+        float right_value = right.ToFloat();
+
+        switch (opcode)
+        {
+        case VmOpcode::ADD:
+            result = VmValue::Float(left_value + right_value);
+            break;
+        case VmOpcode::SUB:
+            result = VmValue::Float(left_value - right_value);
+            break;
+        case VmOpcode::MUL:
+            result = VmValue::Float(left_value * right_value);
+            break;
+        default:
+            result = VmValue::Float(left_value / right_value);
+            break;
+        }
+        return true;
+    }
+
+    // Unsigned arithmetic wraps around without undefined behavior
+    uint32_t left_value = static_cast<uint32_t>(left.int_value);
+    uint32_t right_value = static_cast<uint32_t>(right.int_value);
+
+    switch (opcode)
+    {
+    case VmOpcode::ADD:
+        result = VmValue::Int(static_cast<int32_t>(left_value + right_value));
+        return true;
+    case VmOpcode::SUB:
+        result = VmValue::Int(static_cast<int32_t>(left_value - right_value));
+        return true;
+    case VmOpcode::MUL:
+        result = VmValue::Int(static_cast<int32_t>(left_value * right_value));
+        return true;
+    default:
+        if (right.int_value == 0)
+        {
+            return false;
+        }
+
+        // INT32_MIN / -1 overflows; it wraps around to INT32_MIN
+        if (left.int_value == std::numeric_limits<int32_t>::min() && right.int_value == -1)
+        {
+            result = left;
+            return true;
+        }
+
+        result = VmValue::Int(left.int_value / right.int_value);
+        return true;
+    }
+}
+
+bool IrVirtualMachine::Compare(const VmCompare compare, const VmValue left, const VmValue right)
+{
+    if (left.is_float || right.is_float)
+    {
+        float left_value = left.ToFloat();
+        float right_value = right.ToFloat();
+
+        switch (compare)
+        {
+        case VmCompare::EQ:
+            return left_value == right_value;
+        case VmCompare::NE:
+            return left_value != right_value;
+        case VmCompare::LT:
+            return left_value < right_value;
+        case VmCompare::LE:
+            return left_value <= right_value;
+        case VmCompare::GT:
+            return left_value > right_value;
+        default:
+            return left_value >= right_value;
+        }
+    }
+
+    switch (compare)
+    {
+    case VmCompare::EQ:
+        return left.int_value == right.int_value;
+    case VmCompare::NE:
+        return left.int_value != right.int_value;
+    case VmCompare::LT:
+        return left.int_value < right.int_value;
+    case VmCompare::LE:
+        return left.int_value <= right.int_value;
+    case VmCompare::GT:
+        return left.int_value > right.int_value;
+    default:
+        return left.int_value >= right.int_value;
+    }
+}
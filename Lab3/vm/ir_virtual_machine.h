@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bytecode.h"
+
+// Executes a VmProgram from main until main returns. READ takes integers
+// from input and WRITE prints one value per line to output.
+//
+// Memory is an array of 4-byte words addressed by byte: global variables
+// are at its bottom, and each call takes the blocks of its function's DEC
+// variables from a data stack above them, released when the call returns.
+// Calls are not recursive in C++: frames, their variable slots and pending
+// arguments live on explicit stacks, so deep recursion in C-- only costs
+// memory.
+//
+// Executed instructions are counted per function. With profiling on, the
+// self time of each function (excluding its callees) is measured as well;
+// this reads the clock at every call and return, which slows down
+// programs that make millions of calls.
+class IrVirtualMachine
+{
+private:
+    struct Frame
+    {
+        size_t function_index;
+        uint32_t pc;
+        size_t slot_base;
+        // Arguments of this call in args_, the last PARAM first
+        size_t param_base;
+        size_t param_count;
+        // Arguments this frame pushes for its next call start here
+        size_t arg_base;
+        // Top of the data stack at entry, in words, where the DEC blocks begin
+        size_t memory_top;
+    };
+
+    struct FunctionProfile
+    {
+        uint64_t call_count;
+        uint64_t instruction_count;
+        double self_time_ms;
+    };
+
+    const VmProgram &program_;
+    std::istream &input_;
+    std::ostream &output_;
+    // 0 for no limit
+    uint64_t instruction_limit_;
+    bool is_profiling_;
+
+    std::vector<VmValue> memory_;
+    size_t memory_top_;
+    std::vector<VmValue> slots_;
+    std::vector<VmValue> args_;
+    std::vector<Frame> frames_;
+
+    uint64_t instruction_count_;
+    bool has_error_;
+    std::string error_message_;
+    // Stands in for the word at an invalid address
+    VmValue scratch_word_;
+    int32_t exit_value_;
+
+    std::vector<FunctionProfile> profiles_;
+    // Instruction count and time when the current function was entered or resumed
+    uint64_t last_instruction_count_;
+    std::chrono::steady_clock::time_point last_time_;
+    double total_time_ms_;
+
+public:
+    IrVirtualMachine(const VmProgram &program, std::istream &input, std::ostream &output);
+
+    // Stops with an error after executing this many instructions
+    void SetInstructionLimit(const uint64_t instruction_limit)
+    {
+        instruction_limit_ = instruction_limit;
+    }
+
+    void SetProfiling(const bool is_profiling)
+    {
+        is_profiling_ = is_profiling;
+    }
+
+    // Runs main to completion. Returns false on a runtime error, which is
+    // printed to stderr.
+    bool Run();
+
+    // The value main returned
+    int32_t GetExitValue() const
+    {
+        return exit_value_;
+    }
+
+    uint64_t GetInstructionCount() const
+    {
+        return instruction_count_;
+    }
+
+    // Prints calls, executed instructions and, when profiling, self time
+    // of each function that was called
+    void PrintProfile(std::ostream &stream, const std::string &input_path) const;
+
+private:
+    // Records a runtime error, printed with the line of the current instruction
+    void Fail(const std::string &message);
+
+    void Execute();
+    // Pushes a frame for functions[function_index] and reserves its DEC
+    // blocks. Fails and returns false if the call stack or memory runs out.
+    bool EnterFunction(const size_t function_index);
+    // Charges the instructions and time since the last switch to the
+    // function of the top frame
+    void ChargeCurrentFunction();
+
+    VmValue Read(const VmOperand &operand, const VmValue *constants, const VmValue *slots);
+    void Write(const VmOperand &operand, const VmValue value, VmValue *slots);
+    // Returns the word at address, or sets has_error_ if there is none
+    VmValue &GetWord(const VmValue address);
+
+    // Arithmetic on two integers wraps around; if either is a float, the
+    // result is a float
+    bool Calculate(const VmOpcode opcode,
+                   const VmValue left,
+                   const VmValue right,
+                   VmValue &result) const;
+    static bool Compare(const VmCompare compare, const VmValue left, const VmValue right);
+};
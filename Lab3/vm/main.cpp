@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+extern "C"
+{
+#include "../../Lab1/bits/defs.h"
+}
+
+#include "ir_loader.h"
+#include "ir_virtual_machine.h"
+
+// Usage:
+//   irvm [<options>] <ir-file-path>
+// Runs main of an IR file. READ takes integers from stdin, WRITE prints
+// one value per line to stdout. Runtime errors are printed to stderr.
+// Options:
+//   --profile                  Prints the calls, executed instructions and
+//                              self time of each function to stderr
+//   --max-instructions <n>     Stops with an error after n instructions
+int main(int argc, char *argv[])
+{
+    bool is_profiling = false;
+    uint64_t instruction_limit = 0;
+
+    while (argc >= 2)
+    {
+        std::string option(argv[1]);
+
+        if (option == "--profile")
+        {
+            is_profiling = true;
+            argc--;
+            argv++;
+        }
+        else if (option == "--max-instructions" && argc >= 3)
+        {
+            instruction_limit = std::strtoull(argv[2], nullptr, 10);
+            argc -= 2;
+            argv += 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (argc != 2)
+    {
+        std::cerr << "Usage: irvm [<options>] <ir-file-path>\n"
+                  << "Options: --profile, --max-instructions <n>"
+                  << std::endl;
+        return FAILURE;
+    }
+
+    std::ifstream file(argv[1]);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return FAILURE;
+    }
+
+    VmProgram program;
+    IrLoader loader;
+    if (!loader.Load(file, program))
+    {
+        return FAILURE;
+    }
+
+    // WRITE output is only flushed before READ and at exit
+    std::ios::sync_with_stdio(false);
+
+    IrVirtualMachine machine(program, std::cin, std::cout);
+    machine.SetInstructionLimit(instruction_limit);
+    machine.SetProfiling(is_profiling);
+
+    bool success = machine.Run();
+
+    if (is_profiling)
+    {
+        machine.PrintProfile(std::cerr, argv[1]);
+    }
+
+    return success ? SUCCESS : FAILURE;
+}